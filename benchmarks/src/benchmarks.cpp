@@ -0,0 +1,690 @@
+// Codec microbenchmarks.
+//
+// Usage: benchmarks [iterations]
+//
+// Each result is printed as one JSON object per line so that runs can be
+// collected and compared over time.
+
+#include <compact_time/compact_time.h>
+#include <compact_time/parallel_decode.h>
+#include <compact_time/rfc3339.h>
+#include <compact_time/timestamp_compare.h>
+#include <compact_time/timestamp_key.h>
+#include <compact_time/timezone_arena.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+static const int RECORD_COUNT = 1024;
+static const int MAX_YEAR_GROUPS = 5;
+static const int DEFAULT_ITERATIONS = 2000;
+static const int PARALLEL_RECORD_COUNT = 1 << 20;
+static const int MAX_PARALLEL_THREADS = 64;
+
+// Bits of the year held in the accumulator, per subsecond magnitude.
+static const int g_timestamp_year_upper_bits[] = { 4, 2, 0, 6 };
+static const int g_magnitude_nanoseconds[] = { 0, 123000000, 123456000, 123456789 };
+static const int DATE_YEAR_UPPER_BITS = 7;
+static const int BITS_PER_YEAR_GROUP = 7;
+// Keeps the zigzagged year plus the UTC flag within 32 bits
+static const int MAX_YEAR_OFFSET_BITS = 29;
+
+static volatile int g_sink;
+
+static const char* timezone_name(ct_tz_type type)
+{
+    switch(type)
+    {
+        case CT_TZ_ZERO: return "utc";
+        case CT_TZ_STRING: return "string";
+        case CT_TZ_LATLONG: return "latlong";
+        default: return "unknown";
+    }
+}
+
+/**
+ * Find a year whose encoding needs exactly group_count RVLQ groups, given the
+ * number of year bits that fit in the accumulator and how many low bits the
+ * encoding adds below the zigzagged year. Returns 0 if there isn't one.
+ */
+static int year_for_group_count(int group_count, int upper_bits, int flag_bits)
+{
+    if(group_count == 1)
+    {
+        return 2000;
+    }
+    // Largest year offset that fits in group_count groups, less the zigzag
+    // bit and flags. Keeping every bit set avoids an all-zero leading group.
+    int bit_count = upper_bits + BITS_PER_YEAR_GROUP * group_count - 1 - flag_bits;
+    if(bit_count > MAX_YEAR_OFFSET_BITS)
+    {
+        bit_count = MAX_YEAR_OFFSET_BITS;
+    }
+    const int encoded_bit_count = bit_count + 1 + flag_bits;
+    if(encoded_bit_count <= upper_bits + BITS_PER_YEAR_GROUP * (group_count - 1))
+    {
+        return 0;
+    }
+    return 2000 + (1 << bit_count) - 1;
+}
+
+static bool timestamp_year_round_trips(int year, int magnitude)
+{
+    ct_timestamp timestamp;
+    memset(&timestamp, 0, sizeof(timestamp));
+    timestamp.date.year = year;
+    timestamp.date.month = 1;
+    timestamp.date.day = 1;
+    timestamp.time.nanosecond = g_magnitude_nanoseconds[magnitude];
+    timestamp.time.timezone.type = CT_TZ_ZERO;
+
+    uint8_t buffer[100];
+    const int byte_count = ct_timestamp_encode(&timestamp, buffer, sizeof(buffer));
+    ct_timestamp decoded;
+    return byte_count > 0 &&
+           ct_timestamp_decode(buffer, byte_count, &decoded) == byte_count &&
+           decoded.date.year == year;
+}
+
+static void fill_timezone(ct_timezone* timezone, ct_tz_type type)
+{
+    memset(timezone, 0, sizeof(*timezone));
+    timezone->type = type;
+    if(type == CT_TZ_STRING)
+    {
+        strcpy(timezone->as_string, "Europe/Berlin");
+    }
+    else if(type == CT_TZ_LATLONG)
+    {
+        timezone->latitude = 5994;
+        timezone->longitude = 1071;
+    }
+}
+
+static void fill_time(ct_time* time, int index, int nanosecond, ct_tz_type type)
+{
+    time->hour = index % 24;
+    time->minute = index % 60;
+    time->second = (index * 7) % 60;
+    time->nanosecond = nanosecond;
+    fill_timezone(&time->timezone, type);
+}
+
+static void report(const std::string& benchmark,
+                   int magnitude,
+                   const char* timezone,
+                   int year_groups,
+                   double elapsed_ns,
+                   long long operations,
+                   long long bytes)
+{
+    printf("{\"benchmark\":\"%s\"", benchmark.c_str());
+    if(magnitude >= 0)
+    {
+        printf(",\"magnitude\":%d", magnitude);
+    }
+    if(timezone != NULL)
+    {
+        printf(",\"timezone\":\"%s\"", timezone);
+    }
+    if(year_groups > 0)
+    {
+        printf(",\"year_groups\":%d", year_groups);
+    }
+    printf(",\"ns_per_op\":%.3f,\"bytes_per_op\":%.3f,\"records_per_sec\":%.0f}\n",
+           elapsed_ns / operations,
+           (double)bytes / operations,
+           operations / (elapsed_ns / 1e9));
+}
+
+template<typename T, typename ENCODE, typename DECODE>
+static void run_codec(const std::string& name,
+                      const std::vector<T>& records,
+                      int iterations,
+                      int magnitude,
+                      const char* timezone,
+                      int year_groups,
+                      ENCODE encode,
+                      DECODE decode)
+{
+    std::vector<uint8_t> buffer(records.size() * 100);
+    std::vector<int> offsets(records.size() + 1);
+    int checksum = 0;
+
+    int offset = 0;
+    for(size_t i = 0; i < records.size(); i++)
+    {
+        offsets[i] = offset;
+        offset += encode(&records[i], buffer.data() + offset, (int)buffer.size() - offset);
+    }
+    offsets[records.size()] = offset;
+    const long long bytes_per_pass = offset;
+    const long long operations = (long long)iterations * records.size();
+
+    auto start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        int position = 0;
+        for(const T& record: records)
+        {
+            position += encode(&record, buffer.data() + position, (int)buffer.size() - position);
+        }
+        checksum += position;
+    }
+    auto end = std::chrono::steady_clock::now();
+    report(name + "_encode", magnitude, timezone, year_groups,
+           std::chrono::duration<double, std::nano>(end - start).count(),
+           operations, bytes_per_pass * iterations);
+
+    T decoded;
+    start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        int position = 0;
+        for(size_t i = 0; i < records.size(); i++)
+        {
+            position += decode(buffer.data() + position, offsets[i + 1] - position, &decoded);
+        }
+        checksum += position;
+    }
+    end = std::chrono::steady_clock::now();
+    report(name + "_decode", magnitude, timezone, year_groups,
+           std::chrono::duration<double, std::nano>(end - start).count(),
+           operations, bytes_per_pass * iterations);
+
+    g_sink = checksum;
+}
+
+static void benchmark_dates(int iterations)
+{
+    for(int year_groups = 1; year_groups <= MAX_YEAR_GROUPS; year_groups++)
+    {
+        const int year = year_for_group_count(year_groups, DATE_YEAR_UPPER_BITS, 0);
+        if(year == 0)
+        {
+            continue;
+        }
+        std::vector<ct_date> dates(RECORD_COUNT);
+        for(int i = 0; i < RECORD_COUNT; i++)
+        {
+            dates[i].year = year;
+            dates[i].month = 1 + i % 12;
+            dates[i].day = 1 + i % 28;
+        }
+        run_codec("ct_date", dates, iterations, -1, NULL, year_groups, ct_date_encode, ct_date_decode);
+    }
+}
+
+static void benchmark_times(int iterations)
+{
+    for(int magnitude = 0; magnitude <= 3; magnitude++)
+    {
+        for(ct_tz_type type: {CT_TZ_ZERO, CT_TZ_STRING, CT_TZ_LATLONG})
+        {
+            std::vector<ct_time> times(RECORD_COUNT);
+            for(int i = 0; i < RECORD_COUNT; i++)
+            {
+                fill_time(&times[i], i, g_magnitude_nanoseconds[magnitude], type);
+            }
+            run_codec("ct_time", times, iterations, magnitude, timezone_name(type), 0, ct_time_encode, ct_time_decode);
+        }
+    }
+}
+
+static void benchmark_timestamps(int iterations)
+{
+    for(int magnitude = 0; magnitude <= 3; magnitude++)
+    {
+        for(ct_tz_type type: {CT_TZ_ZERO, CT_TZ_STRING, CT_TZ_LATLONG})
+        {
+            for(int year_groups = 1; year_groups <= MAX_YEAR_GROUPS; year_groups++)
+            {
+                // The encoded year carries the UTC flag as its low bit.
+                const int year = year_for_group_count(year_groups, g_timestamp_year_upper_bits[magnitude], 1);
+                if(year == 0)
+                {
+                    continue;
+                }
+                if(!timestamp_year_round_trips(year, magnitude))
+                {
+                    fprintf(stderr, "Skipping ct_timestamp magnitude %d, %d year groups: year %d does not round trip\n",
+                            magnitude, year_groups, year);
+                    continue;
+                }
+                std::vector<ct_timestamp> timestamps(RECORD_COUNT);
+                for(int i = 0; i < RECORD_COUNT; i++)
+                {
+                    timestamps[i].date.year = year;
+                    timestamps[i].date.month = 1 + i % 12;
+                    timestamps[i].date.day = 1 + i % 28;
+                    fill_time(&timestamps[i].time, i, g_magnitude_nanoseconds[magnitude], type);
+                }
+                run_codec("ct_timestamp", timestamps, iterations, magnitude, timezone_name(type), year_groups,
+                          ct_timestamp_encode, ct_timestamp_decode);
+            }
+        }
+    }
+}
+
+static void benchmark_utc_seconds(int iterations)
+{
+    std::vector<ct_timestamp> timestamps(RECORD_COUNT);
+    for(int i = 0; i < RECORD_COUNT; i++)
+    {
+        timestamps[i].date.year = 2000 + i % 50;
+        timestamps[i].date.month = 1 + i % 12;
+        timestamps[i].date.day = 1 + i % 28;
+        fill_time(&timestamps[i].time, i, 0, CT_TZ_ZERO);
+    }
+    run_codec("ct_timestamp", timestamps, iterations, 0, "utc", 1,
+              ct_timestamp_encode, ct_timestamp_decode);
+    run_codec("ct_timestamp_utc_seconds", timestamps, iterations, 0, "utc", 1,
+              ct_timestamp_encode_utc_seconds, ct_timestamp_decode_utc_seconds);
+}
+
+static void benchmark_timestamp_keys(int iterations)
+{
+    for(ct_tz_type type: {CT_TZ_ZERO, CT_TZ_STRING, CT_TZ_LATLONG})
+    {
+        std::vector<ct_timestamp> timestamps(RECORD_COUNT);
+        for(int i = 0; i < RECORD_COUNT; i++)
+        {
+            timestamps[i].date.year = 2000 + i % 50;
+            timestamps[i].date.month = 1 + i % 12;
+            timestamps[i].date.day = 1 + i % 28;
+            fill_time(&timestamps[i].time, i, g_magnitude_nanoseconds[i % 4], type);
+        }
+        run_codec("ct_timestamp_key", timestamps, iterations, -1, timezone_name(type), 0,
+                  ct_timestamp_key_encode, ct_timestamp_key_decode);
+    }
+}
+
+// Sorting encoded records: decode everything and sort the structs, compare
+// encoded records directly, and radix sort them.
+static void benchmark_sort_encoded(int iterations)
+{
+    std::vector<ct_timestamp> timestamps(RECORD_COUNT);
+    for(int i = 0; i < RECORD_COUNT; i++)
+    {
+        // Scatter the records over a few years.
+        const int value = (i * 7919) % RECORD_COUNT;
+        timestamps[i].date.year = 2000 + value % 5;
+        timestamps[i].date.month = 1 + value % 12;
+        timestamps[i].date.day = 1 + value % 28;
+        fill_time(&timestamps[i].time, value, g_magnitude_nanoseconds[value % 4], CT_TZ_ZERO);
+    }
+    std::vector<uint8_t> buffer(RECORD_COUNT * CT_TIMESTAMP_MAX_ENCODED_SIZE);
+    std::vector<int> offsets(RECORD_COUNT);
+    const int byte_count = ct_timestamp_encode_batch(timestamps.data(), RECORD_COUNT, buffer.data(), buffer.size(),
+                                                     offsets.data(), NULL);
+    const long long operations = (long long)iterations * RECORD_COUNT;
+    int checksum = 0;
+
+    std::vector<ct_timestamp> decoded(RECORD_COUNT);
+    auto start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        ct_timestamp_decode_batch(buffer.data(), byte_count, decoded.data(), RECORD_COUNT, NULL, NULL);
+        std::sort(decoded.begin(), decoded.end(), [](const ct_timestamp& a, const ct_timestamp& b)
+        {
+            if(a.date.year != b.date.year) return a.date.year < b.date.year;
+            if(a.date.month != b.date.month) return a.date.month < b.date.month;
+            if(a.date.day != b.date.day) return a.date.day < b.date.day;
+            if(a.time.hour != b.time.hour) return a.time.hour < b.time.hour;
+            if(a.time.minute != b.time.minute) return a.time.minute < b.time.minute;
+            if(a.time.second != b.time.second) return a.time.second < b.time.second;
+            return a.time.nanosecond < b.time.nanosecond;
+        });
+        checksum += decoded[0].date.year;
+    }
+    auto end = std::chrono::steady_clock::now();
+    report("sort_decoded", -1, "utc", 0,
+           std::chrono::duration<double, std::nano>(end - start).count(), operations, (long long)byte_count * iterations);
+
+    std::vector<int> sorted(RECORD_COUNT);
+    start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        sorted = offsets;
+        const uint8_t* data = buffer.data();
+        std::stable_sort(sorted.begin(), sorted.end(), [data, byte_count](int a, int b)
+        {
+            return ct_timestamp_compare_encoded(data + a, byte_count - a, data + b, byte_count - b) < 0;
+        });
+        checksum += sorted[0];
+    }
+    end = std::chrono::steady_clock::now();
+    report("ct_timestamp_compare_encoded_sort", -1, "utc", 0,
+           std::chrono::duration<double, std::nano>(end - start).count(), operations, (long long)byte_count * iterations);
+
+    start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        sorted = offsets;
+        ct_timestamp_sort_encoded(buffer.data(), byte_count, sorted.data(), RECORD_COUNT);
+        checksum += sorted[0];
+    }
+    end = std::chrono::steady_clock::now();
+    report("ct_timestamp_sort_encoded", -1, "utc", 0,
+           std::chrono::duration<double, std::nano>(end - start).count(), operations, (long long)byte_count * iterations);
+
+    g_sink = checksum;
+}
+
+static void benchmark_encoded_size(int iterations, ct_tz_type type)
+{
+    std::vector<ct_timestamp> timestamps(RECORD_COUNT);
+    for(int i = 0; i < RECORD_COUNT; i++)
+    {
+        timestamps[i].date.year = 1900 + i % 300;
+        timestamps[i].date.month = 1 + i % 12;
+        timestamps[i].date.day = 1 + i % 28;
+        fill_time(&timestamps[i].time, i, g_magnitude_nanoseconds[i % 4], type);
+    }
+    const long long operations = (long long)iterations * RECORD_COUNT;
+
+    long long bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        for(const ct_timestamp& timestamp: timestamps)
+        {
+            bytes += ct_timestamp_encoded_size(&timestamp);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    report("ct_timestamp_encoded_size", -1, timezone_name(type), 0,
+           std::chrono::duration<double, std::nano>(end - start).count(), operations, bytes);
+
+    bytes = 0;
+    start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        bytes += ct_timestamps_encoded_size_total(timestamps.data(), RECORD_COUNT);
+    }
+    end = std::chrono::steady_clock::now();
+    report("ct_timestamps_encoded_size_total", -1, timezone_name(type), 0,
+           std::chrono::duration<double, std::nano>(end - start).count(), operations, bytes);
+    g_sink = (int)bytes;
+}
+
+// Batch decoding of named timezones into ct_timestamp records, and into
+// arena-backed records that keep each distinct name once.
+static void benchmark_arena_decode(int iterations)
+{
+    static const char* names[] = {"Europe/Berlin", "Asia/Tokyo", "America/Vancouver", "Europe/Berlin"};
+    std::vector<ct_timestamp> timestamps(RECORD_COUNT);
+    for(int i = 0; i < RECORD_COUNT; i++)
+    {
+        timestamps[i].date.year = 2000 + i % 50;
+        timestamps[i].date.month = 1 + i % 12;
+        timestamps[i].date.day = 1 + i % 28;
+        fill_time(&timestamps[i].time, i, g_magnitude_nanoseconds[i % 4], CT_TZ_STRING);
+        strcpy(timestamps[i].time.timezone.as_string, names[(i / 8) % 4]);
+    }
+    std::vector<uint8_t> buffer(RECORD_COUNT * CT_TIMESTAMP_MAX_ENCODED_SIZE);
+    const int byte_count = ct_timestamp_encode_batch(timestamps.data(), RECORD_COUNT, buffer.data(), buffer.size(),
+                                                     NULL, NULL);
+    const long long operations = (long long)iterations * RECORD_COUNT;
+    int checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        checksum += ct_timestamp_decode_batch(buffer.data(), byte_count, timestamps.data(), RECORD_COUNT, NULL, NULL);
+    }
+    auto end = std::chrono::steady_clock::now();
+    report("ct_timestamp_decode_batch", -1, "string", 0,
+           std::chrono::duration<double, std::nano>(end - start).count(), operations, (long long)byte_count * iterations);
+
+    std::vector<uint8_t> memory(1024);
+    ct_timezone_arena arena;
+    ct_timezone_arena_init(&arena, memory.data(), memory.size());
+    std::vector<ct_arena_timestamp> arena_timestamps(RECORD_COUNT);
+    start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        ct_timezone_arena_reset(&arena);
+        checksum += ct_arena_timestamp_decode_batch(&arena, buffer.data(), byte_count,
+                                                    arena_timestamps.data(), RECORD_COUNT, NULL, NULL);
+    }
+    end = std::chrono::steady_clock::now();
+    report("ct_arena_timestamp_decode_batch", -1, "string", 0,
+           std::chrono::duration<double, std::nano>(end - start).count(), operations, (long long)byte_count * iterations);
+
+    g_sink = checksum;
+}
+
+// RFC 3339 text conversion, against strptime() / strftime() (plus the
+// fraction, which they don't handle) as commonly used for log timestamps.
+static void benchmark_rfc3339(int iterations)
+{
+    std::vector<ct_timestamp> timestamps(RECORD_COUNT);
+    std::vector<std::string> texts(RECORD_COUNT);
+    long long text_bytes = 0;
+    for(int i = 0; i < RECORD_COUNT; i++)
+    {
+        timestamps[i].date.year = 1970 + i % 100;
+        timestamps[i].date.month = 1 + i % 12;
+        timestamps[i].date.day = 1 + i % 28;
+        fill_time(&timestamps[i].time, i, g_magnitude_nanoseconds[i % 4], CT_TZ_ZERO);
+        char text[CT_RFC3339_TIMESTAMP_MAX_LENGTH + 1];
+        texts[i].assign(text, ct_timestamp_format_rfc3339(&timestamps[i], text, sizeof(text)));
+        text_bytes += texts[i].size();
+    }
+    std::vector<uint8_t> buffer(RECORD_COUNT * CT_TIMESTAMP_MAX_ENCODED_SIZE);
+    std::vector<int> offsets(RECORD_COUNT + 1);
+    const int byte_count = ct_timestamp_encode_batch(timestamps.data(), RECORD_COUNT, buffer.data(), buffer.size(),
+                                                     offsets.data(), NULL);
+    offsets[RECORD_COUNT] = byte_count;
+    const long long operations = (long long)iterations * RECORD_COUNT;
+    ct_timestamp timestamp;
+    char text[CT_RFC3339_TIMESTAMP_MAX_LENGTH + 1];
+    int checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        for(const std::string& source: texts)
+        {
+            struct tm fields;
+            memset(&fields, 0, sizeof(fields));
+            const char* end = strptime(source.c_str(), "%Y-%m-%dT%H:%M:%S", &fields);
+            timestamp.date.year = fields.tm_year + 1900;
+            timestamp.date.month = fields.tm_mon + 1;
+            timestamp.date.day = fields.tm_mday;
+            timestamp.time.hour = fields.tm_hour;
+            timestamp.time.minute = fields.tm_min;
+            timestamp.time.second = fields.tm_sec;
+            timestamp.time.nanosecond = 0;
+            if(*end == '.')
+            {
+                char* fraction_end = NULL;
+                const unsigned long fraction = strtoul(end + 1, &fraction_end, 10);
+                unsigned long scale = 1;
+                for(long digits = fraction_end - (end + 1); digits < 9; digits++)
+                {
+                    scale *= 10;
+                }
+                timestamp.time.nanosecond = fraction * scale;
+            }
+            checksum += timestamp.time.nanosecond;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    report("strptime", -1, "utc", 0,
+           std::chrono::duration<double, std::nano>(end - start).count(), operations, text_bytes * iterations);
+
+    start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        for(const std::string& source: texts)
+        {
+            checksum += ct_timestamp_parse_rfc3339(source.data(), source.size(), &timestamp);
+        }
+    }
+    end = std::chrono::steady_clock::now();
+    report("ct_timestamp_parse_rfc3339", -1, "utc", 0,
+           std::chrono::duration<double, std::nano>(end - start).count(), operations, text_bytes * iterations);
+
+    start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        int position = 0;
+        for(const std::string& source: texts)
+        {
+            ct_timestamp_parse_rfc3339(source.data(), source.size(), &timestamp);
+            position += ct_timestamp_encode(&timestamp, buffer.data() + position, (int)buffer.size() - position);
+        }
+        checksum += position;
+    }
+    end = std::chrono::steady_clock::now();
+    report("ct_timestamp_parse_rfc3339_then_encode", -1, "utc", 0,
+           std::chrono::duration<double, std::nano>(end - start).count(), operations, text_bytes * iterations);
+
+    start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        int position = 0;
+        for(const std::string& source: texts)
+        {
+            position += ct_timestamp_encode_rfc3339(source.data(), source.size(), buffer.data() + position,
+                                                    (int)buffer.size() - position, NULL);
+        }
+        checksum += position;
+    }
+    end = std::chrono::steady_clock::now();
+    report("ct_timestamp_encode_rfc3339", -1, "utc", 0,
+           std::chrono::duration<double, std::nano>(end - start).count(), operations, text_bytes * iterations);
+
+    start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        for(const ct_timestamp& source: timestamps)
+        {
+            struct tm fields;
+            memset(&fields, 0, sizeof(fields));
+            fields.tm_year = source.date.year - 1900;
+            fields.tm_mon = source.date.month - 1;
+            fields.tm_mday = source.date.day;
+            fields.tm_hour = source.time.hour;
+            fields.tm_min = source.time.minute;
+            fields.tm_sec = source.time.second;
+            const size_t length = strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &fields);
+            checksum += snprintf(text + length, sizeof(text) - length, ".%09uZ", (unsigned)source.time.nanosecond);
+        }
+    }
+    end = std::chrono::steady_clock::now();
+    report("strftime", -1, "utc", 0,
+           std::chrono::duration<double, std::nano>(end - start).count(), operations, text_bytes * iterations);
+
+    start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        for(const ct_timestamp& source: timestamps)
+        {
+            checksum += ct_timestamp_format_rfc3339(&source, text, sizeof(text));
+        }
+    }
+    end = std::chrono::steady_clock::now();
+    report("ct_timestamp_format_rfc3339", -1, "utc", 0,
+           std::chrono::duration<double, std::nano>(end - start).count(), operations, text_bytes * iterations);
+
+    start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        for(int i = 0; i < RECORD_COUNT; i++)
+        {
+            ct_timestamp_decode(buffer.data() + offsets[i], offsets[i + 1] - offsets[i], &timestamp);
+            checksum += ct_timestamp_format_rfc3339(&timestamp, text, sizeof(text));
+        }
+    }
+    end = std::chrono::steady_clock::now();
+    report("ct_timestamp_decode_then_format_rfc3339", -1, "utc", 0,
+           std::chrono::duration<double, std::nano>(end - start).count(), operations, text_bytes * iterations);
+
+    start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        for(int i = 0; i < RECORD_COUNT; i++)
+        {
+            checksum += ct_timestamp_decode_rfc3339(buffer.data() + offsets[i], offsets[i + 1] - offsets[i],
+                                                    text, sizeof(text), NULL);
+        }
+    }
+    end = std::chrono::steady_clock::now();
+    report("ct_timestamp_decode_rfc3339", -1, "utc", 0,
+           std::chrono::duration<double, std::nano>(end - start).count(), operations, text_bytes * iterations);
+
+    g_sink = checksum;
+}
+
+static void benchmark_parallel_decode(int iterations)
+{
+    std::vector<ct_timestamp> timestamps(PARALLEL_RECORD_COUNT);
+    for(int i = 0; i < PARALLEL_RECORD_COUNT; i++)
+    {
+        timestamps[i].date.year = 2000 + i % 50;
+        timestamps[i].date.month = 1 + i % 12;
+        timestamps[i].date.day = 1 + i % 28;
+        fill_time(&timestamps[i].time, i, g_magnitude_nanoseconds[i % 4], CT_TZ_ZERO);
+    }
+    std::vector<uint8_t> buffer(PARALLEL_RECORD_COUNT * 10);
+    const int byte_count = ct_timestamp_encode_batch(timestamps.data(), PARALLEL_RECORD_COUNT,
+                                                     buffer.data(), buffer.size(), NULL, NULL);
+
+    // Each pass decodes a million records, so fewer passes are needed.
+    const int passes = iterations / 200 > 0 ? iterations / 200 : 1;
+    for(int thread_count = 1; thread_count <= MAX_PARALLEL_THREADS; thread_count *= 2)
+    {
+        long long checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for(int pass = 0; pass < passes; pass++)
+        {
+            checksum += ct_timestamp_decode_parallel(buffer.data(), byte_count, timestamps.data(),
+                                                     PARALLEL_RECORD_COUNT, thread_count, NULL);
+        }
+        auto end = std::chrono::steady_clock::now();
+        const double elapsed_ns = std::chrono::duration<double, std::nano>(end - start).count();
+        const long long operations = (long long)passes * PARALLEL_RECORD_COUNT;
+        printf("{\"benchmark\":\"parallel_decode\",\"threads\":%d,\"ns_per_op\":%.3f,\"bytes_per_op\":%.3f,\"records_per_sec\":%.0f}\n",
+               thread_count,
+               elapsed_ns / operations,
+               (double)byte_count / PARALLEL_RECORD_COUNT,
+               operations / (elapsed_ns / 1e9));
+        g_sink = (int)checksum;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = DEFAULT_ITERATIONS;
+    if(argc > 1)
+    {
+        iterations = atoi(argv[1]);
+        if(iterations <= 0)
+        {
+            fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    benchmark_dates(iterations);
+    benchmark_times(iterations);
+    benchmark_timestamps(iterations);
+    benchmark_utc_seconds(iterations);
+    benchmark_timestamp_keys(iterations);
+    benchmark_sort_encoded(iterations);
+    benchmark_encoded_size(iterations, CT_TZ_ZERO);
+    benchmark_encoded_size(iterations, CT_TZ_STRING);
+    benchmark_arena_decode(iterations);
+    benchmark_rfc3339(iterations);
+    benchmark_parallel_decode(iterations);
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Shared helpers for the fuzz harnesses.
+//
+// Each harness defines LLVMFuzzerTestOneInput(), and checks the C codec
+// against two oracles:
+//
+//   - Round trip: anything that decodes (and is within the encoder's range)
+//     must re-encode and decode back to the same fields.
+//   - Differential: the constexpr C++ codec in compact_time.hpp must agree
+//     with the C library on every return value, byte and field.
+//
+// The same input is also read as raw field values for the encoders.
+
+#ifndef KS_compact_time_fuzz_common_H
+#define KS_compact_time_fuzz_common_H
+
+#include <compact_time/compact_time.h>
+#include <compact_time/compact_time.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define FUZZ_CHECK(CONDITION) \
+    do \
+    { \
+        if(!(CONDITION)) \
+        { \
+            fprintf(stderr, "%s:%d: Check failed: %s\n", __FILE__, __LINE__, #CONDITION); \
+            abort(); \
+        } \
+    } while(0)
+
+/**
+ * Reads field values from fuzz input, returning zeroes once it runs out.
+ */
+class fuzz_input
+{
+public:
+    fuzz_input(const uint8_t* data, size_t size): data_(data), size_(size) {}
+
+    uint32_t next(int byte_count)
+    {
+        uint32_t value = 0;
+        for(int i = 0; i < byte_count; i++)
+        {
+            value = (value << 8) | (offset_ < size_ ? data_[offset_++] : 0);
+        }
+        return value;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t offset_ = 0;
+};
+
+static const uint32_t NANOSECONDS_PER_SECOND = 1000000000;
+
+// Fill a timezone from fuzz input. Lat/long values may be out of range.
+static inline void fuzz_fill_timezone(fuzz_input& input, ct_timezone* timezone)
+{
+    memset(timezone, 0, sizeof(*timezone));
+    timezone->type = (ct_tz_type)(input.next(1) % 3);
+    timezone->latitude = (int16_t)input.next(2);
+    timezone->longitude = (int16_t)input.next(2);
+    const int name_length = input.next(1) % sizeof(timezone->as_string);
+    for(int i = 0; i < name_length; i++)
+    {
+        // Mostly printable ASCII, with the occasional byte that isn't.
+        const uint8_t ch = (uint8_t)input.next(1);
+        timezone->as_string[i] = (char)(ch < 0xf0 ? 0x20 + ch % 0x5f : ch);
+    }
+}
+
+static inline void fuzz_check_timezone_equal(const ct_timezone& expected, const ct_timezone& actual)
+{
+    FUZZ_CHECK(expected.type == actual.type);
+    if(expected.type == CT_TZ_STRING)
+    {
+        FUZZ_CHECK(strcmp(expected.as_string, actual.as_string) == 0);
+    }
+    else if(expected.type == CT_TZ_LATLONG)
+    {
+        FUZZ_CHECK(expected.latitude == actual.latitude);
+        FUZZ_CHECK(expected.longitude == actual.longitude);
+    }
+}
+
+static inline void fuzz_check_date_equal(const ct_date& expected, const ct_date& actual)
+{
+    FUZZ_CHECK(expected.year == actual.year);
+    FUZZ_CHECK(expected.month == actual.month);
+    FUZZ_CHECK(expected.day == actual.day);
+}
+
+static inline void fuzz_check_time_equal(const ct_time& expected, const ct_time& actual)
+{
+    FUZZ_CHECK(expected.hour == actual.hour);
+    FUZZ_CHECK(expected.minute == actual.minute);
+    FUZZ_CHECK(expected.second == actual.second);
+    FUZZ_CHECK(expected.nanosecond == actual.nanosecond);
+    fuzz_check_timezone_equal(expected.timezone, actual.timezone);
+}
+
+#endif // KS_compact_time_fuzz_common_H
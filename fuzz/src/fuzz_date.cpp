@@ -0,0 +1,69 @@
+// Fuzz harness for ct_date_encode() and ct_date_decode().
+
+#include "fuzz_common.h"
+
+static void check_decode(const uint8_t* data, int length)
+{
+    ct_date decoded;
+    memset(&decoded, 0, sizeof(decoded));
+    const int result = ct_date_decode(data, length, &decoded);
+
+    ct_date other {};
+    FUZZ_CHECK(result == ct::decode(data, length, other));
+    if(result <= 0)
+    {
+        return;
+    }
+    FUZZ_CHECK(result <= length);
+    fuzz_check_date_equal(decoded, other);
+
+    uint8_t buffer[CT_DATE_MAX_ENCODED_SIZE];
+    const int byte_count = ct_date_encode(&decoded, buffer, sizeof(buffer));
+    FUZZ_CHECK(byte_count > 0);
+    FUZZ_CHECK(byte_count == ct_date_encoded_size(&decoded));
+    ct_date round_tripped;
+    memset(&round_tripped, 0, sizeof(round_tripped));
+    FUZZ_CHECK(byte_count == ct_date_decode(buffer, byte_count, &round_tripped));
+    fuzz_check_date_equal(decoded, round_tripped);
+}
+
+static void check_encode(const uint8_t* data, size_t size)
+{
+    fuzz_input input(data, size);
+    ct_date date;
+    memset(&date, 0, sizeof(date));
+    date.year = (int32_t)input.next(4);
+    date.month = input.next(1) & 0x0f;
+    date.day = input.next(1) & 0x1f;
+
+    uint8_t expected[CT_DATE_MAX_ENCODED_SIZE];
+    uint8_t actual[CT_DATE_MAX_ENCODED_SIZE];
+    const int result = ct_date_encode(&date, expected, sizeof(expected));
+    FUZZ_CHECK(result > 0);
+    FUZZ_CHECK(result == ct::encode(date, actual, sizeof(actual)));
+    FUZZ_CHECK(memcmp(expected, actual, result) == 0);
+    FUZZ_CHECK(result == ct_date_encoded_size(&date));
+    FUZZ_CHECK(result == ct::encoded_size(date));
+    FUZZ_CHECK(result == ct_date_encode_unchecked(&date, actual));
+    FUZZ_CHECK(memcmp(expected, actual, result) == 0);
+
+    for(int length = 0; length < result; length++)
+    {
+        const int short_result = ct_date_encode(&date, actual, length);
+        FUZZ_CHECK(short_result < 0 && short_result >= -result);
+        const int other_short_result = ct::encode(date, actual, length);
+        FUZZ_CHECK(other_short_result < 0 && other_short_result >= -result);
+    }
+
+    ct_date decoded;
+    memset(&decoded, 0, sizeof(decoded));
+    FUZZ_CHECK(result == ct_date_decode(expected, result, &decoded));
+    fuzz_check_date_equal(date, decoded);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    check_decode(data, (int)size);
+    check_encode(data, size);
+    return 0;
+}
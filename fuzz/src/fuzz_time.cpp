@@ -0,0 +1,80 @@
+// Fuzz harness for ct_time_encode() and ct_time_decode().
+
+#include "fuzz_common.h"
+
+static void check_decode(const uint8_t* data, int length)
+{
+    ct_time decoded;
+    memset(&decoded, 0, sizeof(decoded));
+    const int result = ct_time_decode(data, length, &decoded);
+
+    ct_time other {};
+    FUZZ_CHECK(result == ct::decode(data, length, other));
+    if(result <= 0)
+    {
+        return;
+    }
+    FUZZ_CHECK(result <= length);
+    fuzz_check_time_equal(decoded, other);
+
+    // Subsecond fields can decode to more than the encoder accepts.
+    if(decoded.nanosecond >= NANOSECONDS_PER_SECOND)
+    {
+        return;
+    }
+    uint8_t buffer[CT_TIME_MAX_ENCODED_SIZE];
+    const int byte_count = ct_time_encode(&decoded, buffer, sizeof(buffer));
+    FUZZ_CHECK(byte_count > 0);
+    FUZZ_CHECK(byte_count == ct_time_encoded_size(&decoded));
+    ct_time round_tripped;
+    memset(&round_tripped, 0, sizeof(round_tripped));
+    FUZZ_CHECK(byte_count == ct_time_decode(buffer, byte_count, &round_tripped));
+    fuzz_check_time_equal(decoded, round_tripped);
+}
+
+static void check_encode(const uint8_t* data, size_t size)
+{
+    fuzz_input input(data, size);
+    ct_time time;
+    memset(&time, 0, sizeof(time));
+    time.hour = input.next(1) & 0x1f;
+    time.minute = input.next(1) & 0x3f;
+    time.second = input.next(1) & 0x3f;
+    time.nanosecond = input.next(4) % NANOSECONDS_PER_SECOND;
+    fuzz_fill_timezone(input, &time.timezone);
+
+    uint8_t expected[CT_TIME_MAX_ENCODED_SIZE];
+    uint8_t actual[CT_TIME_MAX_ENCODED_SIZE];
+    const int result = ct_time_encode(&time, expected, sizeof(expected));
+    FUZZ_CHECK(result == ct::encode(time, actual, sizeof(actual)));
+    if(result <= 0)
+    {
+        FUZZ_CHECK(result == ct_time_encode_unchecked(&time, actual));
+        return;
+    }
+    FUZZ_CHECK(memcmp(expected, actual, result) == 0);
+    FUZZ_CHECK(result == ct_time_encoded_size(&time));
+    FUZZ_CHECK(result == ct::encoded_size(time));
+    FUZZ_CHECK(result == ct_time_encode_unchecked(&time, actual));
+    FUZZ_CHECK(memcmp(expected, actual, result) == 0);
+
+    for(int length = 0; length < result; length++)
+    {
+        const int short_result = ct_time_encode(&time, actual, length);
+        FUZZ_CHECK(short_result < 0 && short_result >= -result);
+        const int other_short_result = ct::encode(time, actual, length);
+        FUZZ_CHECK(other_short_result < 0 && other_short_result >= -result);
+    }
+
+    ct_time decoded;
+    memset(&decoded, 0, sizeof(decoded));
+    FUZZ_CHECK(result == ct_time_decode(expected, result, &decoded));
+    fuzz_check_time_equal(time, decoded);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    check_decode(data, (int)size);
+    check_encode(data, size);
+    return 0;
+}
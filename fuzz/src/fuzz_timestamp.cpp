@@ -0,0 +1,106 @@
+// Fuzz harness for ct_timestamp_encode() and ct_timestamp_decode().
+
+#include "fuzz_common.h"
+
+static void check_timestamp_equal(const ct_timestamp& expected, const ct_timestamp& actual)
+{
+    fuzz_check_date_equal(expected.date, actual.date);
+    fuzz_check_time_equal(expected.time, actual.time);
+}
+
+static void check_decode(const uint8_t* data, int length)
+{
+    ct_timestamp decoded;
+    memset(&decoded, 0, sizeof(decoded));
+    const int result = ct_timestamp_decode(data, length, &decoded);
+
+    ct_timestamp other {};
+    FUZZ_CHECK(result == ct::decode(data, length, other));
+
+    ct_timestamp_view view;
+    const int view_result = ct_timestamp_decode_view(data, length, &view);
+    if(result == ERROR_OUT_OF_RANGE && view_result > 0 && view.timezone.type == CT_TZ_STRING)
+    {
+        // Only the view can hold names longer than ct_timezone.as_string.
+        FUZZ_CHECK(view.timezone.name_length >= (int)sizeof(decoded.time.timezone.as_string));
+    }
+    else
+    {
+        FUZZ_CHECK(result == view_result);
+    }
+
+    if(result <= 0)
+    {
+        return;
+    }
+    FUZZ_CHECK(result <= length);
+    check_timestamp_equal(decoded, other);
+    FUZZ_CHECK(view.date.year == decoded.date.year);
+    FUZZ_CHECK(view.nanosecond == decoded.time.nanosecond);
+
+    // Subsecond fields can decode to more than the encoder accepts.
+    if(decoded.time.nanosecond >= NANOSECONDS_PER_SECOND)
+    {
+        return;
+    }
+    uint8_t buffer[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    const int byte_count = ct_timestamp_encode(&decoded, buffer, sizeof(buffer));
+    FUZZ_CHECK(byte_count > 0);
+    FUZZ_CHECK(byte_count == ct_timestamp_encoded_size(&decoded));
+    ct_timestamp round_tripped;
+    memset(&round_tripped, 0, sizeof(round_tripped));
+    FUZZ_CHECK(byte_count == ct_timestamp_decode(buffer, byte_count, &round_tripped));
+    check_timestamp_equal(decoded, round_tripped);
+}
+
+static void check_encode(const uint8_t* data, size_t size)
+{
+    fuzz_input input(data, size);
+    ct_timestamp timestamp;
+    memset(&timestamp, 0, sizeof(timestamp));
+    // Keep the zigzagged year and UTC flag within 32 bits.
+    timestamp.date.year = (int32_t)input.next(4) >> 2;
+    timestamp.date.month = input.next(1) & 0x0f;
+    timestamp.date.day = input.next(1) & 0x1f;
+    timestamp.time.hour = input.next(1) & 0x1f;
+    timestamp.time.minute = input.next(1) & 0x3f;
+    timestamp.time.second = input.next(1) & 0x3f;
+    timestamp.time.nanosecond = input.next(4) % NANOSECONDS_PER_SECOND;
+    fuzz_fill_timezone(input, &timestamp.time.timezone);
+
+    uint8_t expected[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    uint8_t actual[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    const int result = ct_timestamp_encode(&timestamp, expected, sizeof(expected));
+    FUZZ_CHECK(result == ct::encode(timestamp, actual, sizeof(actual)));
+    if(result <= 0)
+    {
+        FUZZ_CHECK(result == ct_timestamp_encode_unchecked(&timestamp, actual));
+        return;
+    }
+    FUZZ_CHECK(memcmp(expected, actual, result) == 0);
+    FUZZ_CHECK(result == ct_timestamp_encoded_size(&timestamp));
+    FUZZ_CHECK(result == ct::encoded_size(timestamp));
+    FUZZ_CHECK(result == ct_timestamp_encode_unchecked(&timestamp, actual));
+    FUZZ_CHECK(memcmp(expected, actual, result) == 0);
+
+    // Every short buffer fails with an offset within the record.
+    for(int length = 0; length < result; length++)
+    {
+        const int short_result = ct_timestamp_encode(&timestamp, actual, length);
+        FUZZ_CHECK(short_result < 0 && short_result >= -result);
+        const int other_short_result = ct::encode(timestamp, actual, length);
+        FUZZ_CHECK(other_short_result < 0 && other_short_result >= -result);
+    }
+
+    ct_timestamp decoded;
+    memset(&decoded, 0, sizeof(decoded));
+    FUZZ_CHECK(result == ct_timestamp_decode(expected, result, &decoded));
+    check_timestamp_equal(timestamp, decoded);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    check_decode(data, (int)size);
+    check_encode(data, size);
+    return 0;
+}
@@ -0,0 +1,106 @@
+// Corpus replay driver, linked into a harness in place of libFuzzer.
+//
+// Usage: fuzz_<target>_replay [--iterations N] <file or directory>...
+//
+// Runs every input through the harness once, so that a corpus can be used
+// as a regression test without a fuzzing toolchain. With --iterations, the
+// whole corpus is replayed N times and the throughput is printed as a JSON
+// line in the same format as the codec benchmarks, for checking that
+// hardening doesn't slow the hot path.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+static void add_input(std::vector<std::vector<uint8_t>>& inputs, const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    inputs.emplace_back(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static std::string target_name(const char* program)
+{
+    std::string name = std::filesystem::path(program).filename().string();
+    const std::string suffix = "_replay";
+    if(name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+    {
+        name.resize(name.size() - suffix.size());
+    }
+    return name;
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = 0;
+    std::vector<std::vector<uint8_t>> inputs;
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+        {
+            iterations = atoi(argv[++i]);
+            continue;
+        }
+        const std::filesystem::path path(argv[i]);
+        if(std::filesystem::is_directory(path))
+        {
+            for(const auto& entry: std::filesystem::directory_iterator(path))
+            {
+                if(entry.is_regular_file())
+                {
+                    add_input(inputs, entry.path());
+                }
+            }
+        }
+        else
+        {
+            add_input(inputs, path);
+        }
+    }
+    if(inputs.empty())
+    {
+        fprintf(stderr, "No inputs found\n");
+        return 1;
+    }
+
+    // The empty input is always worth checking.
+    LLVMFuzzerTestOneInput(NULL, 0);
+    long long bytes_per_pass = 0;
+    for(const std::vector<uint8_t>& input: inputs)
+    {
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+        bytes_per_pass += input.size();
+    }
+    if(iterations <= 0)
+    {
+        printf("Replayed %zu inputs\n", inputs.size());
+        return 0;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for(int iteration = 0; iteration < iterations; iteration++)
+    {
+        for(const std::vector<uint8_t>& input: inputs)
+        {
+            LLVMFuzzerTestOneInput(input.data(), input.size());
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    const double elapsed_ns = std::chrono::duration<double, std::nano>(end - start).count();
+    const long long operations = (long long)iterations * inputs.size();
+    printf("{\"benchmark\":\"%s_replay\",\"inputs\":%zu,\"ns_per_op\":%.3f,\"bytes_per_op\":%.3f,\"records_per_sec\":%.0f}\n",
+           target_name(argv[0]).c_str(),
+           inputs.size(),
+           elapsed_ns / operations,
+           (double)bytes_per_pass / inputs.size(),
+           operations / (elapsed_ns / 1e9));
+    return 0;
+}
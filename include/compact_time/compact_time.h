@@ -26,9 +26,8 @@
  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
  * DEALINGS IN THE SOFTWARE.
  */
-#ifndef KS_compact_time_H
-#define KS_compact_time_H
-
+// Outside the include guard, so that headers included after
+// compact_time_inline.h (which scopes its own definition) still get one.
 #ifndef COMPACT_TIME_PUBLIC
     #if defined _WIN32 || defined __CYGWIN__
         #define COMPACT_TIME_PUBLIC __declspec(dllimport)
@@ -37,6 +36,9 @@
     #endif
 #endif
 
+#ifndef KS_compact_time_H
+#define KS_compact_time_H
+
 
 #ifdef __cplusplus 
 extern "C" {
@@ -54,6 +56,19 @@ enum
     ERROR_OUT_OF_RANGE = -0x7fffffff
 };
 
+/*
+ * The most bytes that any value of each type can encode to, for sizing
+ * destination buffers at compile time. The timezone allowance covers the
+ * longest timezone name the format permits (63 bytes plus a length byte).
+ */
+enum
+{
+    CT_TIMEZONE_MAX_ENCODED_SIZE = 64,
+    CT_DATE_MAX_ENCODED_SIZE = 6,
+    CT_TIME_MAX_ENCODED_SIZE = 7 + CT_TIMEZONE_MAX_ENCODED_SIZE,
+    CT_TIMESTAMP_MAX_ENCODED_SIZE = 12 + CT_TIMEZONE_MAX_ENCODED_SIZE,
+};
+
 typedef enum
 {
     CT_TZ_ZERO,
@@ -73,7 +88,7 @@ typedef struct
     ct_tz_type type;
     int16_t latitude;   // Units: hundredths of a degree
     int16_t longitude;  // Units: hundredths of a degree
-    char as_string[41]; // Must be null-terminated!
+    char as_string[41]; // Printable ASCII. Must be null-terminated!
 } ct_timezone;
 
 typedef struct
@@ -91,6 +106,49 @@ typedef struct
     ct_time time;
 } ct_timestamp;
 
+/**
+ * A decoded timezone whose name (for CT_TZ_STRING) points into the source
+ * buffer rather than being copied. The name is not null-terminated.
+ */
+typedef struct
+{
+    ct_tz_type type;
+    int16_t latitude;   // Units: hundredths of a degree
+    int16_t longitude;  // Units: hundredths of a degree
+    const char* name;   // CT_TZ_STRING only
+    int name_length;    // CT_TZ_STRING only (0-63)
+} ct_timezone_view;
+
+/**
+ * A decoded timestamp whose timezone name refers to the source buffer. It
+ * is only valid for as long as the source buffer is.
+ */
+typedef struct
+{
+    ct_date date;
+    uint8_t hour;        // 0-23
+    uint8_t minute;      // 0-59
+    uint8_t second;      // 0-60 (for leap seconds)
+    uint32_t nanosecond; // 0-999999999
+    ct_timezone_view timezone;
+} ct_timestamp_view;
+
+/**
+ * Struct-of-arrays destination for decoded timestamp fields. Each pointer
+ * refers to a caller-owned array; element N of every array belongs to the
+ * Nth decoded record.
+ */
+typedef struct
+{
+    int32_t* year;
+    uint8_t* month;
+    uint8_t* day;
+    uint8_t* hour;
+    uint8_t* minute;
+    uint8_t* second;
+    uint32_t* nanosecond;
+} ct_timestamp_fields;
+
 /* All length based API return values will be one of:
  *   - A value > 0 representing the number of bytes written.
  *   - A value <= 0, whose negated value represents the offset where it ran out of room in the buffer.
@@ -113,15 +171,30 @@ COMPACT_TIME_PUBLIC int ct_date_encoded_size(const ct_date* date);
 /**
  * Calculate the number of bytes that would be occupied by this time when
  * encoded.
+ *
+ * Returns ERROR_OUT_OF_RANGE if the timezone name is not terminated within
+ * ct_timezone.as_string.
  */
 COMPACT_TIME_PUBLIC int ct_time_encoded_size(const ct_time* time);
 
 /**
  * Calculate the number of bytes that would be occupied by this timestamp when
  * encoded.
+ *
+ * Returns ERROR_OUT_OF_RANGE if the timezone name is not terminated within
+ * ct_timezone.as_string.
  */
 COMPACT_TIME_PUBLIC int ct_timestamp_encoded_size(const ct_timestamp* timestamp);
 
+/**
+ * Calculate the total number of bytes that an array of timestamps would
+ * occupy when encoded back-to-back (for example by ct_timestamp_encode_batch()).
+ *
+ * Returns ERROR_OUT_OF_RANGE if any timezone name is not terminated within
+ * ct_timezone.as_string.
+ */
+COMPACT_TIME_PUBLIC int64_t ct_timestamps_encoded_size_total(const ct_timestamp* timestamps, int timestamp_count);
+
 /**
  * Encode a date to a destination buffer.
  *
@@ -143,6 +216,20 @@ COMPACT_TIME_PUBLIC int ct_time_encode(const ct_time* time, uint8_t* dst, int ds
  */
 COMPACT_TIME_PUBLIC int ct_timestamp_encode(const ct_timestamp* timestamp, uint8_t* dst, int dst_length);
 
+/**
+ * Encode a date, time, or timestamp without checking for room in the
+ * destination buffer. The caller must guarantee at least
+ * CT_DATE_MAX_ENCODED_SIZE, CT_TIME_MAX_ENCODED_SIZE, or
+ * CT_TIMESTAMP_MAX_ENCODED_SIZE bytes respectively (or the object's
+ * ct_*_encoded_size()) at dst.
+ *
+ * Returns the number of bytes written to encode the object, or
+ * ERROR_OUT_OF_RANGE.
+ */
+COMPACT_TIME_PUBLIC int ct_date_encode_unchecked(const ct_date* date, uint8_t* dst);
+COMPACT_TIME_PUBLIC int ct_time_encode_unchecked(const ct_time* time, uint8_t* dst);
+COMPACT_TIME_PUBLIC int ct_timestamp_encode_unchecked(const ct_timestamp* timestamp, uint8_t* dst);
+
 /**
  * Decode a date from a source buffer.
  *
@@ -160,10 +247,139 @@ COMPACT_TIME_PUBLIC int ct_time_decode(const uint8_t* src, int src_length, ct_ti
 /**
  * Decode a timestamp from a source buffer.
  *
+ * Timezone names longer than ct_timezone.as_string can hold are rejected
+ * with ERROR_OUT_OF_RANGE; use ct_timestamp_decode_view() to read them.
+ * Names that are not printable ASCII are always rejected.
+ *
  * Returns the number of bytes read to decode the object or an error code.
  */
 COMPACT_TIME_PUBLIC int ct_timestamp_decode(const uint8_t* src, int src_length, ct_timestamp* timestamp);
 
+/**
+ * Decode a timestamp from a source buffer without copying its timezone name.
+ * Unlike ct_timestamp_decode(), this accepts every name length that the
+ * encoder writes (up to 63 bytes), including names longer than
+ * ct_timezone.as_string can hold. Longer names are rejected with
+ * ERROR_OUT_OF_RANGE.
+ *
+ * Returns the number of bytes read to decode the object or an error code.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_decode_view(const uint8_t* src, int src_length, ct_timestamp_view* timestamp);
+
+/**
+ * Encode a timestamp to a destination buffer, using a fast path for the most
+ * common shape: UTC, no subseconds, and a year from 1488 to 2511 (which
+ * always encodes to 5 bytes). Anything else goes through ct_timestamp_encode().
+ *
+ * Returns the number of bytes written to encode the object or an error code.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_encode_utc_seconds(const ct_timestamp* timestamp, uint8_t* dst, int dst_length);
+
+/**
+ * Decode a timestamp from a source buffer, using a fast path for records
+ * written in the shape that ct_timestamp_encode_utc_seconds() favors. Anything
+ * else goes through ct_timestamp_decode().
+ *
+ * Returns the number of bytes read to decode the object or an error code.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_decode_utc_seconds(const uint8_t* src, int src_length, ct_timestamp* timestamp);
+
+/**
+ * Encode an array of timestamps back-to-back into a destination buffer.
+ *
+ * If record_offsets is not NULL, the offset of each encoded record within dst
+ * is written to record_offsets (which must have room for timestamp_count
+ * entries). Encoding stops at the first record that fails.
+ *
+ * If records_processed is not NULL, it receives the number of records that
+ * were fully encoded.
+ *
+ * Returns the total number of bytes written or an error code. Failure offsets
+ * are relative to the start of dst.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_encode_batch(const ct_timestamp* timestamps,
+                                                  int timestamp_count,
+                                                  uint8_t* dst,
+                                                  int dst_length,
+                                                  int* record_offsets,
+                                                  int* records_processed);
+
+/**
+ * Decode back-to-back timestamps from a source buffer, stopping when the
+ * buffer is exhausted or max_timestamp_count records have been decoded.
+ *
+ * If record_offsets is not NULL, the offset of each decoded record within src
+ * is written to record_offsets (which must have room for max_timestamp_count
+ * entries). Decoding stops at the first record that fails.
+ *
+ * If records_processed is not NULL, it receives the number of records that
+ * were fully decoded.
+ *
+ * Returns the total number of bytes read or an error code. Failure offsets
+ * are relative to the start of src.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_decode_batch(const uint8_t* src,
+                                                  int src_length,
+                                                  ct_timestamp* timestamps,
+                                                  int max_timestamp_count,
+                                                  int* record_offsets,
+                                                  int* records_processed);
+
+/**
+ * Decode a run of back-to-back UTC timestamps into struct-of-arrays output.
+ *
+ * Decoding stops (without error) at the first record that does not have a UTC
+ * timezone, when the buffer is exhausted, or once max_timestamp_count records
+ * have been decoded. Blocks of records that share a subsecond magnitude and
+ * have a single-byte year are decoded several at a time using SSE4.2 or AVX2
+ * when the CPU supports it; everything else goes through a scalar path.
+ *
+ * If records_processed is not NULL, it receives the number of records that
+ * were decoded.
+ *
+ * Returns the total number of bytes read or an error code. Failure offsets
+ * are relative to the start of src.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_decode_utc_run(const uint8_t* src,
+                                                    int src_length,
+                                                    const ct_timestamp_fields* fields,
+                                                    int max_timestamp_count,
+                                                    int* records_processed);
+
+/**
+ * Convert nanoseconds since the Unix epoch (1970-01-01 00:00:00 UTC) to a
+ * timestamp with a UTC timezone.
+ */
+COMPACT_TIME_PUBLIC void ct_timestamp_from_unix_ns(int64_t unix_ns, ct_timestamp* timestamp);
+
+/**
+ * Convert a UTC timestamp to nanoseconds since the Unix epoch.
+ *
+ * Leap second 60 is counted as the first second of the following minute.
+ *
+ * Returns 0 on success, or ERROR_OUT_OF_RANGE if the timestamp is not UTC,
+ * has out-of-range fields, or cannot be represented in an int64_t.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_to_unix_ns(const ct_timestamp* timestamp, int64_t* unix_ns);
+
+/**
+ * Encode nanoseconds since the Unix epoch as a UTC timestamp, without building
+ * an intermediate ct_timestamp.
+ *
+ * Returns the number of bytes written to encode the object or an error code.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_encode_unix_ns(int64_t unix_ns, uint8_t* dst, int dst_length);
+
+/**
+ * Decode a UTC timestamp from a source buffer as nanoseconds since the Unix
+ * epoch, without building an intermediate ct_timestamp.
+ *
+ * Returns the number of bytes read to decode the object or an error code.
+ * Timestamps that are not UTC, or that cannot be represented in an int64_t,
+ * return ERROR_OUT_OF_RANGE.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_decode_unix_ns(const uint8_t* src, int src_length, int64_t* unix_ns);
+
 
 #ifdef __cplusplus 
 }
@@ -0,0 +1,705 @@
+/*
+ * Compact Time: C++ Compile-Time Codec
+ * ====================================
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef KS_compact_time_hpp
+#define KS_compact_time_hpp
+
+/*
+ * A C++17 constexpr implementation of the compact time codec, producing the
+ * same bytes and return values as the C functions of the same name. It needs
+ * nothing linked, so constant timestamps can be encoded entirely at compile
+ * time:
+ *
+ *     static constexpr ct_timestamp EPOCH = {{1970, 1, 1}, {0, 0, 0, 0, {CT_TZ_ZERO}}};
+ *     static constexpr auto EPOCH_BYTES = ct::encode_array<EPOCH>();
+ *
+ * The encode_timestamp<MAGNITUDE, TZ_TYPE>() and encode_time<MAGNITUDE, TZ_TYPE>()
+ * templates take the subsecond magnitude and timezone type as template
+ * arguments, so the compiler can drop the runtime dispatch on them. Magnitude
+ * 0 is whole seconds, 1 is milliseconds, 2 is microseconds and 3 is
+ * nanoseconds; the nanosecond field is truncated to the given magnitude.
+ */
+
+#include "compact_time/compact_time.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace ct
+{
+
+namespace detail
+{
+
+constexpr int YEAR_BIAS = 2000;
+constexpr int BITS_PER_YEAR_GROUP = 7;
+constexpr uint8_t RVLQ_CONTINUATION_BIT = 0x80;
+constexpr int MAX_TIMEZONE_LENGTH = 63;
+constexpr int MIN_LATITUDE = -9000;
+constexpr int MAX_LATITUDE = 9000;
+constexpr int MIN_LONGITUDE = -18000;
+constexpr int MAX_LONGITUDE = 18000;
+constexpr int DATE_YEAR_UPPER_BITS = 7;
+constexpr int DATE_BYTE_COUNT = 2;
+
+constexpr int TIMESTAMP_YEAR_UPPER_BITS[] = { 4, 2, 0, 6 };
+constexpr int TIMESTAMP_BASE_BYTE_COUNTS[] = { 4, 5, 6, 8 };
+constexpr int TIME_BASE_BYTE_COUNTS[] = { 3, 4, 5, 7 };
+constexpr uint32_t SUBSECOND_MULTIPLIERS[] = { 1, 1000000, 1000, 1 };
+
+constexpr int failure_at_pos(int position)
+{
+    return -position;
+}
+
+constexpr int subsecond_magnitude(uint32_t nanosecond)
+{
+    if(nanosecond == 0)
+    {
+        return 0;
+    }
+    if(nanosecond % 1000 != 0)
+    {
+        return 3;
+    }
+    if(nanosecond % 1000000 != 0)
+    {
+        return 2;
+    }
+    return 1;
+}
+
+constexpr uint32_t encode_year(int32_t year)
+{
+    const int32_t value = static_cast<int32_t>(static_cast<uint32_t>(year) - YEAR_BIAS);
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+constexpr int32_t decode_year(uint32_t encoded_year)
+{
+    return static_cast<int32_t>(((encoded_year >> 1) ^ (0u - (encoded_year & 1))) + YEAR_BIAS);
+}
+
+constexpr int32_t sign_extend(uint32_t value, int bit_count)
+{
+    const int shift_amount = 32 - bit_count;
+    return static_cast<int32_t>(value << shift_amount) >> shift_amount;
+}
+
+constexpr int year_group_count(uint32_t encoded_year, int uncounted_bits)
+{
+    uint32_t year = encoded_year >> uncounted_bits;
+    int count = 1;
+    while((year >>= BITS_PER_YEAR_GROUP) != 0)
+    {
+        count++;
+    }
+    return count;
+}
+
+constexpr void write_le(uint64_t value, uint8_t* dst, int byte_count)
+{
+    for(int i = 0; i < byte_count; i++)
+    {
+        dst[i] = static_cast<uint8_t>(value >> (i * 8));
+    }
+}
+
+constexpr uint64_t read_le(const uint8_t* src, int byte_count)
+{
+    uint64_t value = 0;
+    for(int i = byte_count - 1; i >= 0; i--)
+    {
+        value = (value << 8) | src[i];
+    }
+    return value;
+}
+
+constexpr int rvlq_encode(uint32_t value, int group_count, uint8_t* dst, int dst_length)
+{
+    if(group_count > dst_length)
+    {
+        return failure_at_pos(group_count);
+    }
+    for(int i = group_count - 1; i >= 0; i--)
+    {
+        dst[i] = static_cast<uint8_t>((value & 0x7f) | RVLQ_CONTINUATION_BIT);
+        value >>= BITS_PER_YEAR_GROUP;
+    }
+    dst[group_count - 1] &= static_cast<uint8_t>(~RVLQ_CONTINUATION_BIT);
+    return group_count;
+}
+
+constexpr int rvlq_decode(uint32_t& value, const uint8_t* src, int src_length)
+{
+    for(int i = 0; i < src_length; i++)
+    {
+        value = (value << BITS_PER_YEAR_GROUP) | (src[i] & 0x7f);
+        if((src[i] & RVLQ_CONTINUATION_BIT) == 0)
+        {
+            return i + 1;
+        }
+    }
+    return failure_at_pos(src_length + 1);
+}
+
+// Returns ERROR_OUT_OF_RANGE if the name is not terminated within the buffer.
+template<std::size_t N>
+constexpr int string_length(const char (&str)[N])
+{
+    for(int length = 0; length < static_cast<int>(N); length++)
+    {
+        if(str[length] == 0)
+        {
+            return length;
+        }
+    }
+    return ERROR_OUT_OF_RANGE;
+}
+
+// Timezone names are limited to printable ASCII.
+template<typename CHAR>
+constexpr bool is_printable_name(const CHAR* name, int length)
+{
+    for(int i = 0; i < length; i++)
+    {
+        const uint8_t ch = static_cast<uint8_t>(name[i]);
+        if(ch < 0x20 || ch > 0x7e)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr int timezone_encoded_size(const ct_timezone& timezone)
+{
+    switch(timezone.type)
+    {
+        case CT_TZ_STRING:
+        {
+            const int length = string_length(timezone.as_string);
+            return length < 0 ? length : length + 1;
+        }
+        case CT_TZ_LATLONG:
+            return 4;
+        case CT_TZ_ZERO:
+            return 0;
+        default:
+            return ERROR_OUT_OF_RANGE;
+    }
+}
+
+template<ct_tz_type TZ_TYPE>
+constexpr int timezone_encode(const ct_timezone& timezone, uint8_t* dst, int dst_length)
+{
+    if constexpr(TZ_TYPE == CT_TZ_STRING)
+    {
+        const int length = string_length(timezone.as_string);
+        if(length < 0 || length > MAX_TIMEZONE_LENGTH || !is_printable_name(timezone.as_string, length))
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        if(length + 1 > dst_length)
+        {
+            return failure_at_pos(length + 1);
+        }
+        dst[0] = static_cast<uint8_t>(length << 1);
+        for(int i = 0; i < length; i++)
+        {
+            dst[i + 1] = static_cast<uint8_t>(timezone.as_string[i]);
+        }
+        return length + 1;
+    }
+    else if constexpr(TZ_TYPE == CT_TZ_LATLONG)
+    {
+        if(timezone.latitude < MIN_LATITUDE || timezone.latitude > MAX_LATITUDE ||
+           timezone.longitude < MIN_LONGITUDE || timezone.longitude > MAX_LONGITUDE)
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        if(dst_length < 4)
+        {
+            return failure_at_pos(4);
+        }
+        const uint32_t value = 1 |
+                               ((static_cast<uint32_t>(timezone.latitude) & 0x7fff) << 1) |
+                               ((static_cast<uint32_t>(timezone.longitude) & 0xffff) << 16);
+        write_le(value, dst, 4);
+        return 4;
+    }
+    else
+    {
+        (void)timezone;
+        (void)dst;
+        (void)dst_length;
+        return 0;
+    }
+}
+
+constexpr int timezone_decode(ct_timezone& timezone, const uint8_t* src, int src_length, bool timezone_is_utc)
+{
+    if(timezone_is_utc)
+    {
+        timezone.type = CT_TZ_ZERO;
+        return 0;
+    }
+    if(src_length < 1)
+    {
+        return failure_at_pos(1);
+    }
+
+    if(src[0] & 1)
+    {
+        timezone.type = CT_TZ_LATLONG;
+        if(src_length < 4)
+        {
+            return failure_at_pos(4);
+        }
+        const uint32_t latlong = static_cast<uint32_t>(read_le(src, 4));
+        timezone.latitude = static_cast<int16_t>(sign_extend((latlong >> 1) & 0x7fff, 15));
+        timezone.longitude = static_cast<int16_t>(sign_extend((latlong >> 16) & 0xffff, 16));
+        if(timezone.latitude < MIN_LATITUDE || timezone.latitude > MAX_LATITUDE ||
+           timezone.longitude < MIN_LONGITUDE || timezone.longitude > MAX_LONGITUDE)
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        return 4;
+    }
+
+    const int length = src[0] >> 1;
+    if(1 + length > src_length)
+    {
+        return failure_at_pos(1 + length);
+    }
+    if(length >= static_cast<int>(sizeof(timezone.as_string)) || !is_printable_name(src + 1, length))
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    timezone.type = CT_TZ_STRING;
+    for(int i = 0; i < length; i++)
+    {
+        timezone.as_string[i] = static_cast<char>(src[i + 1]);
+    }
+    timezone.as_string[length] = 0;
+    return 1 + length;
+}
+
+template<int MAGNITUDE, ct_tz_type TZ_TYPE>
+constexpr int timestamp_encode(const ct_timestamp& timestamp, uint8_t* dst, int dst_length)
+{
+    static_assert(MAGNITUDE >= 0 && MAGNITUDE <= 3, "Magnitude must be 0 to 3");
+    constexpr bool TIMEZONE_IS_UTC = TZ_TYPE == CT_TZ_ZERO;
+    constexpr int ACCUMULATOR_SIZE = TIMESTAMP_BASE_BYTE_COUNTS[MAGNITUDE];
+
+    const uint32_t encoded_year = (encode_year(timestamp.date.year) << 1) | (TIMEZONE_IS_UTC ? 1 : 0);
+    const int group_count = year_group_count(encoded_year, TIMESTAMP_YEAR_UPPER_BITS[MAGNITUDE]);
+    const uint64_t subsecond = timestamp.time.nanosecond / SUBSECOND_MULTIPLIERS[MAGNITUDE];
+
+    uint64_t accumulator = static_cast<uint64_t>(encoded_year) >> (group_count * BITS_PER_YEAR_GROUP);
+    accumulator = (accumulator << (10 * MAGNITUDE)) + subsecond;
+    accumulator = (accumulator << 4) + timestamp.date.month;
+    accumulator = (accumulator << 5) + timestamp.date.day;
+    accumulator = (accumulator << 5) + timestamp.time.hour;
+    accumulator = (accumulator << 6) + timestamp.time.minute;
+    accumulator = (accumulator << 6) + timestamp.time.second;
+    accumulator = (accumulator << 2) + MAGNITUDE;
+
+    if(ACCUMULATOR_SIZE > dst_length)
+    {
+        return failure_at_pos(ACCUMULATOR_SIZE);
+    }
+    write_le(accumulator, dst, ACCUMULATOR_SIZE);
+    int offset = ACCUMULATOR_SIZE;
+
+    const int rvlq_byte_count = rvlq_encode(encoded_year, group_count, dst + offset, dst_length - offset);
+    if(rvlq_byte_count <= 0)
+    {
+        return failure_at_pos(offset) + rvlq_byte_count;
+    }
+    offset += rvlq_byte_count;
+    if constexpr(TIMEZONE_IS_UTC)
+    {
+        return offset;
+    }
+
+    const int timezone_byte_count = timezone_encode<TZ_TYPE>(timestamp.time.timezone, dst + offset, dst_length - offset);
+    if(timezone_byte_count == ERROR_OUT_OF_RANGE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(timezone_byte_count < 0)
+    {
+        return failure_at_pos(offset) + timezone_byte_count;
+    }
+    return offset + timezone_byte_count;
+}
+
+template<int MAGNITUDE, ct_tz_type TZ_TYPE>
+constexpr int time_encode(const ct_time& time, uint8_t* dst, int dst_length)
+{
+    static_assert(MAGNITUDE >= 0 && MAGNITUDE <= 3, "Magnitude must be 0 to 3");
+    constexpr int ACCUMULATOR_SIZE = TIME_BASE_BYTE_COUNTS[MAGNITUDE];
+
+    uint64_t accumulator = time.nanosecond / SUBSECOND_MULTIPLIERS[MAGNITUDE];
+    accumulator = (accumulator << 6) + time.second;
+    accumulator = (accumulator << 6) + time.minute;
+    accumulator = (accumulator << 5) + time.hour;
+    accumulator = (accumulator << 2) + MAGNITUDE;
+    accumulator = (accumulator << 1) + (TZ_TYPE == CT_TZ_ZERO ? 1 : 0);
+
+    if(ACCUMULATOR_SIZE > dst_length)
+    {
+        return failure_at_pos(ACCUMULATOR_SIZE);
+    }
+    write_le(accumulator, dst, ACCUMULATOR_SIZE);
+
+    const int timezone_byte_count = timezone_encode<TZ_TYPE>(time.timezone, dst + ACCUMULATOR_SIZE, dst_length - ACCUMULATOR_SIZE);
+    if(timezone_byte_count == ERROR_OUT_OF_RANGE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(timezone_byte_count < 0)
+    {
+        return failure_at_pos(ACCUMULATOR_SIZE) + timezone_byte_count;
+    }
+    return ACCUMULATOR_SIZE + timezone_byte_count;
+}
+
+// Pick the template instance for a runtime magnitude and timezone type.
+template<template<int, ct_tz_type> class DISPATCHER, typename T>
+constexpr int dispatch(int magnitude, ct_tz_type type, const T& value, uint8_t* dst, int dst_length)
+{
+    // An unknown type would otherwise alias another magnitude's instance.
+    if(static_cast<unsigned>(type) > CT_TZ_LATLONG)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    switch(magnitude * 3 + type)
+    {
+        case 0: return DISPATCHER<0, CT_TZ_ZERO>::encode(value, dst, dst_length);
+        case 1: return DISPATCHER<0, CT_TZ_STRING>::encode(value, dst, dst_length);
+        case 2: return DISPATCHER<0, CT_TZ_LATLONG>::encode(value, dst, dst_length);
+        case 3: return DISPATCHER<1, CT_TZ_ZERO>::encode(value, dst, dst_length);
+        case 4: return DISPATCHER<1, CT_TZ_STRING>::encode(value, dst, dst_length);
+        case 5: return DISPATCHER<1, CT_TZ_LATLONG>::encode(value, dst, dst_length);
+        case 6: return DISPATCHER<2, CT_TZ_ZERO>::encode(value, dst, dst_length);
+        case 7: return DISPATCHER<2, CT_TZ_STRING>::encode(value, dst, dst_length);
+        case 8: return DISPATCHER<2, CT_TZ_LATLONG>::encode(value, dst, dst_length);
+        case 9: return DISPATCHER<3, CT_TZ_ZERO>::encode(value, dst, dst_length);
+        case 10: return DISPATCHER<3, CT_TZ_STRING>::encode(value, dst, dst_length);
+        case 11: return DISPATCHER<3, CT_TZ_LATLONG>::encode(value, dst, dst_length);
+        default: return ERROR_OUT_OF_RANGE;
+    }
+}
+
+template<int MAGNITUDE, ct_tz_type TZ_TYPE>
+struct timestamp_encoder
+{
+    static constexpr int encode(const ct_timestamp& timestamp, uint8_t* dst, int dst_length)
+    {
+        return timestamp_encode<MAGNITUDE, TZ_TYPE>(timestamp, dst, dst_length);
+    }
+};
+
+template<int MAGNITUDE, ct_tz_type TZ_TYPE>
+struct time_encoder
+{
+    static constexpr int encode(const ct_time& time, uint8_t* dst, int dst_length)
+    {
+        return time_encode<MAGNITUDE, TZ_TYPE>(time, dst, dst_length);
+    }
+};
+
+} // namespace detail
+
+
+// ---
+// API
+// ---
+
+/**
+ * Encoded bytes held by value, as returned by encode(). length is the
+ * number of bytes used, or an error code as returned by the C functions.
+ */
+template<int CAPACITY>
+struct encoded
+{
+    std::array<uint8_t, CAPACITY> data {};
+    int length = 0;
+};
+
+/**
+ * Encode a timestamp or time with a magnitude and timezone type fixed at
+ * compile time. TZ_TYPE must match the value's timezone type.
+ *
+ * Returns the number of bytes written to encode the object or an error code.
+ */
+template<int MAGNITUDE, ct_tz_type TZ_TYPE>
+constexpr int encode_timestamp(const ct_timestamp& timestamp, uint8_t* dst, int dst_length)
+{
+    return detail::timestamp_encode<MAGNITUDE, TZ_TYPE>(timestamp, dst, dst_length);
+}
+
+template<int MAGNITUDE, ct_tz_type TZ_TYPE>
+constexpr int encode_time(const ct_time& time, uint8_t* dst, int dst_length)
+{
+    return detail::time_encode<MAGNITUDE, TZ_TYPE>(time, dst, dst_length);
+}
+
+/**
+ * Calculate the number of bytes that an object would occupy when encoded.
+ */
+constexpr int encoded_size(const ct_date& date)
+{
+    return detail::DATE_BYTE_COUNT + detail::year_group_count(detail::encode_year(date.year), detail::DATE_YEAR_UPPER_BITS);
+}
+
+constexpr int encoded_size(const ct_time& time)
+{
+    const int timezone_size = detail::timezone_encoded_size(time.timezone);
+    if(timezone_size < 0)
+    {
+        return timezone_size;
+    }
+    return detail::TIME_BASE_BYTE_COUNTS[detail::subsecond_magnitude(time.nanosecond)] + timezone_size;
+}
+
+constexpr int encoded_size(const ct_timestamp& timestamp)
+{
+    const int timezone_size = detail::timezone_encoded_size(timestamp.time.timezone);
+    if(timezone_size < 0)
+    {
+        return timezone_size;
+    }
+    const int magnitude = detail::subsecond_magnitude(timestamp.time.nanosecond);
+    const uint32_t encoded_year = detail::encode_year(timestamp.date.year) << 1;
+    return detail::TIMESTAMP_BASE_BYTE_COUNTS[magnitude] +
+           detail::year_group_count(encoded_year, detail::TIMESTAMP_YEAR_UPPER_BITS[magnitude]) +
+           timezone_size;
+}
+
+/**
+ * Encode an object to a destination buffer.
+ *
+ * Returns the number of bytes written to encode the object or an error code.
+ */
+constexpr int encode(const ct_date& date, uint8_t* dst, int dst_length)
+{
+    const uint32_t encoded_year = detail::encode_year(date.year);
+    const int group_count = detail::year_group_count(encoded_year, detail::DATE_YEAR_UPPER_BITS);
+
+    uint64_t accumulator = static_cast<uint64_t>(encoded_year) >> (group_count * detail::BITS_PER_YEAR_GROUP);
+    accumulator = (accumulator << 4) | date.month;
+    accumulator = (accumulator << 5) | date.day;
+
+    if(detail::DATE_BYTE_COUNT > dst_length)
+    {
+        return detail::failure_at_pos(detail::DATE_BYTE_COUNT);
+    }
+    detail::write_le(accumulator, dst, detail::DATE_BYTE_COUNT);
+    const int rvlq_byte_count = detail::rvlq_encode(encoded_year, group_count,
+                                                    dst + detail::DATE_BYTE_COUNT,
+                                                    dst_length - detail::DATE_BYTE_COUNT);
+    if(rvlq_byte_count <= 0)
+    {
+        return detail::failure_at_pos(detail::DATE_BYTE_COUNT) + rvlq_byte_count;
+    }
+    return detail::DATE_BYTE_COUNT + rvlq_byte_count;
+}
+
+constexpr int encode(const ct_time& time, uint8_t* dst, int dst_length)
+{
+    return detail::dispatch<detail::time_encoder>(detail::subsecond_magnitude(time.nanosecond),
+                                                  time.timezone.type, time, dst, dst_length);
+}
+
+constexpr int encode(const ct_timestamp& timestamp, uint8_t* dst, int dst_length)
+{
+    return detail::dispatch<detail::timestamp_encoder>(detail::subsecond_magnitude(timestamp.time.nanosecond),
+                                                       timestamp.time.timezone.type, timestamp, dst, dst_length);
+}
+
+/**
+ * Encode an object into a fixed-capacity value.
+ */
+constexpr encoded<CT_DATE_MAX_ENCODED_SIZE> encode(const ct_date& date)
+{
+    encoded<CT_DATE_MAX_ENCODED_SIZE> result;
+    result.length = encode(date, result.data.data(), CT_DATE_MAX_ENCODED_SIZE);
+    return result;
+}
+
+constexpr encoded<CT_TIME_MAX_ENCODED_SIZE> encode(const ct_time& time)
+{
+    encoded<CT_TIME_MAX_ENCODED_SIZE> result;
+    result.length = encode(time, result.data.data(), CT_TIME_MAX_ENCODED_SIZE);
+    return result;
+}
+
+constexpr encoded<CT_TIMESTAMP_MAX_ENCODED_SIZE> encode(const ct_timestamp& timestamp)
+{
+    encoded<CT_TIMESTAMP_MAX_ENCODED_SIZE> result;
+    result.length = encode(timestamp, result.data.data(), CT_TIMESTAMP_MAX_ENCODED_SIZE);
+    return result;
+}
+
+/**
+ * Encode a constant object (a ct_date, ct_time or ct_timestamp with static
+ * storage) into an array of exactly its encoded size. Fails to compile if the
+ * object cannot be encoded.
+ */
+template<const auto& VALUE>
+constexpr auto encode_array()
+{
+    constexpr auto result = encode(VALUE);
+    static_assert(result.length > 0, "Value cannot be encoded");
+    std::array<uint8_t, result.length> bytes {};
+    for(int i = 0; i < result.length; i++)
+    {
+        bytes[i] = result.data[i];
+    }
+    return bytes;
+}
+
+/**
+ * Decode an object from a source buffer.
+ *
+ * Returns the number of bytes read to decode the object or an error code.
+ */
+constexpr int decode(const uint8_t* src, int src_length, ct_date& date)
+{
+    if(detail::DATE_BYTE_COUNT >= src_length)
+    {
+        return detail::failure_at_pos(detail::DATE_BYTE_COUNT);
+    }
+    const uint32_t accumulator = static_cast<uint32_t>(detail::read_le(src, detail::DATE_BYTE_COUNT));
+    date.day = accumulator & 0x1f;
+    date.month = (accumulator >> 5) & 0x0f;
+    uint32_t encoded_year = (accumulator >> 9) & 0x7f;
+
+    const int group_count = detail::rvlq_decode(encoded_year, src + detail::DATE_BYTE_COUNT, src_length - detail::DATE_BYTE_COUNT);
+    if(group_count < 1)
+    {
+        return detail::failure_at_pos(detail::DATE_BYTE_COUNT) + group_count;
+    }
+    date.year = detail::decode_year(encoded_year);
+    return detail::DATE_BYTE_COUNT + group_count;
+}
+
+constexpr int decode(const uint8_t* src, int src_length, ct_time& time)
+{
+    if(src_length < 1)
+    {
+        return detail::failure_at_pos(1);
+    }
+    const bool timezone_is_utc = src[0] & 1;
+    const int magnitude = (src[0] >> 1) & 3;
+    const int offset = detail::TIME_BASE_BYTE_COUNTS[magnitude];
+    if(offset > src_length)
+    {
+        return detail::failure_at_pos(offset);
+    }
+
+    uint64_t accumulator = detail::read_le(src, offset) >> 3;
+    time.hour = accumulator & 0x1f;
+    accumulator >>= 5;
+    time.minute = accumulator & 0x3f;
+    accumulator >>= 6;
+    time.second = accumulator & 0x3f;
+    accumulator >>= 6;
+    time.nanosecond = static_cast<uint32_t>(accumulator & ((1u << (10 * magnitude)) - 1)) * detail::SUBSECOND_MULTIPLIERS[magnitude];
+
+    const int timezone_byte_count = detail::timezone_decode(time.timezone, src + offset, src_length - offset, timezone_is_utc);
+    if(timezone_byte_count == ERROR_OUT_OF_RANGE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(timezone_byte_count < 0)
+    {
+        return detail::failure_at_pos(offset) + timezone_byte_count;
+    }
+    return offset + timezone_byte_count;
+}
+
+constexpr int decode(const uint8_t* src, int src_length, ct_timestamp& timestamp)
+{
+    if(src_length < 1)
+    {
+        return detail::failure_at_pos(1);
+    }
+    const int magnitude = src[0] & 3;
+    const int offset = detail::TIMESTAMP_BASE_BYTE_COUNTS[magnitude];
+    if(offset >= src_length)
+    {
+        return detail::failure_at_pos(offset);
+    }
+
+    uint64_t accumulator = detail::read_le(src, offset) >> 2;
+    timestamp.time.second = accumulator & 0x3f;
+    accumulator >>= 6;
+    timestamp.time.minute = accumulator & 0x3f;
+    accumulator >>= 6;
+    timestamp.time.hour = accumulator & 0x1f;
+    accumulator >>= 5;
+    timestamp.date.day = accumulator & 0x1f;
+    accumulator >>= 5;
+    timestamp.date.month = accumulator & 0x0f;
+    accumulator >>= 4;
+    timestamp.time.nanosecond = static_cast<uint32_t>(accumulator & ((1u << (10 * magnitude)) - 1)) * detail::SUBSECOND_MULTIPLIERS[magnitude];
+    accumulator >>= 10 * magnitude;
+    uint32_t encoded_year = static_cast<uint32_t>(accumulator);
+
+    const int group_count = detail::rvlq_decode(encoded_year, src + offset, src_length - offset);
+    if(group_count < 1)
+    {
+        return detail::failure_at_pos(offset) + group_count;
+    }
+    const int base_byte_count = offset + group_count;
+    const bool timezone_is_utc = encoded_year & 1;
+    timestamp.date.year = detail::decode_year(encoded_year >> 1);
+
+    const int timezone_byte_count = detail::timezone_decode(timestamp.time.timezone,
+                                                            src + base_byte_count,
+                                                            src_length - base_byte_count,
+                                                            timezone_is_utc);
+    if(timezone_byte_count == ERROR_OUT_OF_RANGE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(timezone_byte_count < 0)
+    {
+        return detail::failure_at_pos(base_byte_count) + timezone_byte_count;
+    }
+    return base_byte_count + timezone_byte_count;
+}
+
+} // namespace ct
+
+#endif // KS_compact_time_hpp
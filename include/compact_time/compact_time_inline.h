@@ -0,0 +1,78 @@
+/*
+ * Compact Time: Header-Only Build
+ * ===============================
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef KS_compact_time_inline_H
+#define KS_compact_time_inline_H
+
+/*
+ * Include this header instead of compact_time.h to compile the codec
+ * directly into the including translation unit, with every function in
+ * compact_time.h defined as static inline. This lets the compiler inline the
+ * codec into callers and fold away constant magnitudes and timezone types.
+ *
+ * Nothing needs to be linked except compact time's own dependencies (vlq),
+ * and the shared library must not be relied on from the same translation
+ * unit.
+ *
+ * Define COMPACT_TIME_LOGGING to 1 before including to compile logging in,
+ * and COMPACT_TIME_STATISTICS to 1 to compile statistics in.
+ */
+
+#ifdef KS_compact_time_H
+    #error "compact_time_inline.h must be included before (instead of) compact_time.h"
+#endif
+
+// The linkage macros only apply to the codec pulled in here. Headers included
+// afterwards get their usual linkage back.
+#pragma push_macro("COMPACT_TIME_PUBLIC")
+#pragma push_macro("COMPACT_TIME_INTERNAL")
+#undef COMPACT_TIME_PUBLIC
+#undef COMPACT_TIME_INTERNAL
+#define COMPACT_TIME_PUBLIC static inline
+#define COMPACT_TIME_INTERNAL static inline
+
+// Generated by meson from the project version, and installed next to this
+// header.
+#ifndef COMPACT_TIME_VERSION
+    #include "compact_time_version.h"
+#endif
+
+#include "compact_time/compact_time.h"
+#include "compact_time/statistics.h"
+
+// The implementation files are installed next to this header, and are found
+// through the library's private include directory when building in-tree.
+#include "library.c"
+#include "statistics.c"
+#include "timezone_scan.c"
+#include "utc_run_decode.c"
+
+#pragma pop_macro("COMPACT_TIME_INTERNAL")
+#pragma pop_macro("COMPACT_TIME_PUBLIC")
+
+#endif // KS_compact_time_inline_H
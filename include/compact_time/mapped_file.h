@@ -0,0 +1,148 @@
+/*
+ * Compact Time: Memory-Mapped Files
+ * =================================
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef KS_compact_time_mapped_file_H
+#define KS_compact_time_mapped_file_H
+
+#include "compact_time/compact_time.h"
+
+#ifdef __cplusplus 
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+// ---
+// API
+// ---
+
+/**
+ * A read-only memory mapping of a file of back-to-back encoded timestamps.
+ *
+ * Pages are only read from disk as they are touched, so opening is
+ * immediate regardless of file size, and files larger than RAM can be walked
+ * (the kernel drops pages that have already been read).
+ *
+ * data and length may be read directly. All other members are private.
+ */
+typedef struct
+{
+    const uint8_t* data;
+    int64_t length;
+    void* platform_handle;
+} ct_mapped_file;
+
+/**
+ * Walks back-to-back encoded timestamps in place.
+ *
+ * All members are private.
+ */
+typedef struct
+{
+    const uint8_t* data;
+    int64_t length;
+    int64_t offset;
+    const ct_mapped_file* file;
+    int64_t released_offset;
+} ct_record_cursor;
+
+/**
+ * The raw bytes of one encoded record, pointing into the cursor's buffer.
+ */
+typedef struct
+{
+    const uint8_t* data;
+    int length;
+} ct_record_span;
+
+/**
+ * Map a file into memory, hinting to the OS that it will be read
+ * sequentially.
+ *
+ * Returns false if the file could not be opened or mapped.
+ */
+COMPACT_TIME_PUBLIC bool ct_mapped_file_open(ct_mapped_file* file, const char* path);
+
+/**
+ * Unmap a file. Any pointers into it become invalid.
+ */
+COMPACT_TIME_PUBLIC void ct_mapped_file_close(ct_mapped_file* file);
+
+/**
+ * Initialize a cursor over the records in a buffer.
+ */
+COMPACT_TIME_PUBLIC void ct_record_cursor_init(ct_record_cursor* cursor, const uint8_t* data, int64_t length);
+
+/**
+ * Initialize a cursor over the records in a mapped file.
+ *
+ * As the cursor advances, pages behind it are periodically handed back to
+ * the OS so that walking a large file doesn't evict everything else from the
+ * page cache. Spans already returned remain valid (their pages are re-read
+ * from the file if touched again).
+ */
+COMPACT_TIME_PUBLIC void ct_record_cursor_init_mapped(ct_record_cursor* cursor, const ct_mapped_file* file);
+
+/**
+ * Get the raw bytes of the next record without decoding it.
+ *
+ * Returns the record length, 0 at the end of the buffer, or an error code if
+ * the buffer ends partway through a record (the cursor does not advance).
+ */
+COMPACT_TIME_PUBLIC int ct_record_cursor_next_span(ct_record_cursor* cursor, ct_record_span* span);
+
+/**
+ * Decode the next record.
+ *
+ * Returns the number of bytes read, 0 at the end of the buffer, or an error
+ * code (the cursor does not advance).
+ */
+COMPACT_TIME_PUBLIC int ct_record_cursor_next(ct_record_cursor* cursor, ct_timestamp* timestamp);
+
+/**
+ * Decode the next record without copying its timezone name. The view's name
+ * points into the cursor's buffer.
+ *
+ * Returns the number of bytes read, 0 at the end of the buffer, or an error
+ * code (the cursor does not advance).
+ */
+COMPACT_TIME_PUBLIC int ct_record_cursor_next_view(ct_record_cursor* cursor, ct_timestamp_view* timestamp);
+
+/**
+ * Get the cursor's current offset within its buffer.
+ */
+COMPACT_TIME_PUBLIC int64_t ct_record_cursor_offset(const ct_record_cursor* cursor);
+
+
+#ifdef __cplusplus 
+}
+#endif
+
+#endif // KS_compact_time_mapped_file_H
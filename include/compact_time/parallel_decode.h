@@ -0,0 +1,116 @@
+/*
+ * Compact Time: Parallel Decoding
+ * ===============================
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef KS_compact_time_parallel_decode_H
+#define KS_compact_time_parallel_decode_H
+
+#include "compact_time/compact_time.h"
+#include "compact_time/stream_index.h"
+
+#ifdef __cplusplus 
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+
+// ---
+// API
+// ---
+
+/*
+ * Records are split into chunks of a few thousand that start on known record
+ * boundaries. Worker threads claim chunks one at a time from a shared
+ * counter until none are left, so a slow thread never holds up work that
+ * another thread could do. Because every chunk is about the same size and
+ * no chunk spawns more work, this self-scheduling balances the load as well
+ * as per-thread work-stealing queues would, without their bookkeeping. Each chunk is written straight to its own range
+ * of the output array, so results come out in stream order and threads never
+ * share output cache lines except at chunk edges.
+ *
+ * Chunks are decoded independently, and threads only share the chunk
+ * counter and the position of the first failure. How far throughput scales
+ * depends on the machine's cores and memory bandwidth (each decoded
+ * ct_timestamp is much larger than its encoding, so the output writes
+ * dominate); run the benchmarks (parallel_decode entries, 1 to 64 threads)
+ * to measure it.
+ *
+ * Finding the chunk boundaries needs either a stream index, or a sequential
+ * pass over the record lengths. That pass is several times cheaper than
+ * decoding, but it does not parallelize, so by Amdahl's law it caps the
+ * speedup of ct_timestamp_decode_parallel(). Decode through a stream index
+ * with ct_stream_decode_parallel() to avoid the cap.
+ *
+ * There is no persistent thread pool: each call starts its threads (POSIX
+ * threads, or Windows threads on Windows) and joins them before returning.
+ * Starting a thread costs far less than decoding a chunk, but for inputs of
+ * only a few chunks, ct_timestamp_decode_batch() on the calling thread is
+ * the better choice.
+ */
+
+/**
+ * Decode back-to-back timestamps from a source buffer using up to
+ * thread_count threads (including the calling thread), stopping when the
+ * buffer is exhausted or max_timestamp_count records have been decoded.
+ *
+ * If records_processed is not NULL, it receives the number of records that
+ * were fully decoded before the first failing record.
+ *
+ * Returns the total number of bytes read or an error code. Failure offsets
+ * are relative to the start of src.
+ */
+COMPACT_TIME_PUBLIC int64_t ct_timestamp_decode_parallel(const uint8_t* src,
+                                                         int64_t src_length,
+                                                         ct_timestamp* timestamps,
+                                                         int64_t max_timestamp_count,
+                                                         int thread_count,
+                                                         int64_t* records_processed);
+
+/**
+ * Decode record_count records starting at first_record from an indexed
+ * stream, using up to thread_count threads (including the calling thread).
+ *
+ * If records_processed is not NULL, it receives the number of records that
+ * were fully decoded before the first failing record.
+ *
+ * Returns record_count, or ERROR_OUT_OF_RANGE if the range is outside of the
+ * stream or a record could not be decoded.
+ */
+COMPACT_TIME_PUBLIC int64_t ct_stream_decode_parallel(const ct_stream_index* index,
+                                                      int64_t first_record,
+                                                      int64_t record_count,
+                                                      ct_timestamp* timestamps,
+                                                      int thread_count,
+                                                      int64_t* records_processed);
+
+
+#ifdef __cplusplus 
+}
+#endif
+
+#endif // KS_compact_time_parallel_decode_H
@@ -0,0 +1,148 @@
+/*
+ * Compact Time: RFC 3339 Text
+ * ===========================
+ *
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef KS_compact_time_rfc3339_H
+#define KS_compact_time_rfc3339_H
+
+#include "compact_time/compact_time.h"
+
+#ifdef __cplusplus 
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+
+// ---
+// API
+// ---
+
+/*
+ * Conversion between RFC 3339 text (e.g. "2020-08-30T15:33:14.19577323Z")
+ * and compact time, both through the ct_date / ct_time / ct_timestamp
+ * structs and directly to and from the compact encoding.
+ *
+ * Parsing accepts:
+ *
+ *     | Part      | Form                                   |
+ *     | --------- | -------------------------------------- |
+ *     | Date      | YYYY-MM-DD (0000-9999)                 |
+ *     | Separator | T, t, or a space                       |
+ *     | Time      | HH:MM:SS, with SS up to 60             |
+ *     | Fraction  | Optional: . then 1 to 9 digits         |
+ *     | Offset    | Z, z, +HH:MM, or -HH:MM                |
+ *
+ * Compact time has no UTC offset timezone, so a parsed offset is applied to
+ * the fields and the result is always in UTC (CT_TZ_ZERO). A time without a
+ * date wraps around midnight. Year 0000 is 1 BC, which compact time stores
+ * as year -1.
+ *
+ * Formatting writes the same form with a T separator, Z, and 0, 3, 6 or 9
+ * fraction digits (whichever is shortest for the value). Only UTC values with
+ * a year from 1 BC to 9999 can be formatted; anything else returns
+ * ERROR_OUT_OF_RANGE. Formatted text is null-terminated, and dst must have
+ * room for the terminator.
+ *
+ * Parse functions read from the start of the text and return the number of
+ * characters read, or an error code. Malformed text returns
+ * ERROR_OUT_OF_RANGE, and text that ends too early returns a failure offset.
+ */
+
+enum
+{
+    // Longest formatted text, not counting the null terminator
+    CT_RFC3339_DATE_MAX_LENGTH = 10,
+    CT_RFC3339_TIME_MAX_LENGTH = 19,
+    CT_RFC3339_TIMESTAMP_MAX_LENGTH = CT_RFC3339_DATE_MAX_LENGTH + 1 + CT_RFC3339_TIME_MAX_LENGTH,
+};
+
+/**
+ * Parse an RFC 3339 full-date.
+ */
+COMPACT_TIME_PUBLIC int ct_date_parse_rfc3339(const char* text, int text_length, ct_date* date);
+
+/**
+ * Parse an RFC 3339 full-time (a time with fraction and offset).
+ */
+COMPACT_TIME_PUBLIC int ct_time_parse_rfc3339(const char* text, int text_length, ct_time* time);
+
+/**
+ * Parse an RFC 3339 date-time.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_parse_rfc3339(const char* text, int text_length, ct_timestamp* timestamp);
+
+/**
+ * Format a date, time, or timestamp as RFC 3339 text.
+ *
+ * Returns the number of characters written (not counting the null
+ * terminator) or an error code.
+ */
+COMPACT_TIME_PUBLIC int ct_date_format_rfc3339(const ct_date* date, char* dst, int dst_length);
+COMPACT_TIME_PUBLIC int ct_time_format_rfc3339(const ct_time* time, char* dst, int dst_length);
+COMPACT_TIME_PUBLIC int ct_timestamp_format_rfc3339(const ct_timestamp* timestamp, char* dst, int dst_length);
+
+/**
+ * Encode the RFC 3339 date-time at the start of text as a compact timestamp,
+ * without going through a ct_timestamp.
+ *
+ * If chars_read is not NULL, it receives the length of the text, or 0 if it
+ * could not be parsed.
+ *
+ * Returns the number of bytes written, or an error code. Failure offsets
+ * refer to text if it could not be parsed, and to dst otherwise.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_encode_rfc3339(const char* text,
+                                                    int text_length,
+                                                    uint8_t* dst,
+                                                    int dst_length,
+                                                    int* chars_read);
+
+/**
+ * Format the compact encoded timestamp at the start of src as RFC 3339 text,
+ * without going through a ct_timestamp.
+ *
+ * If bytes_read is not NULL, it receives the length of the compact record,
+ * or 0 if it could not be decoded.
+ *
+ * Returns the number of characters written (not counting the null
+ * terminator), or an error code. Failure offsets refer to src if the record
+ * could not be decoded, and to dst otherwise.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_decode_rfc3339(const uint8_t* src,
+                                                    int src_length,
+                                                    char* dst,
+                                                    int dst_length,
+                                                    int* bytes_read);
+
+
+#ifdef __cplusplus 
+}
+#endif
+
+#endif // KS_compact_time_rfc3339_H
@@ -0,0 +1,147 @@
+/*
+ * Compact Time: Timestamp Sequences
+ * =================================
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef KS_compact_time_sequence_H
+#define KS_compact_time_sequence_H
+
+#include "compact_time/compact_time.h"
+
+#ifdef __cplusplus 
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+// ---
+// API
+// ---
+
+/*
+ * A sequence is a series of entries, each starting with an RVLQ header:
+ *
+ *   - Keyframe (header 1): followed by a full compact time timestamp.
+ *   - Delta (header bit 0 clear): header bits 1-2 hold a unit (0 = seconds,
+ *     1 = milliseconds, 2 = microseconds, 3 = nanoseconds), and the rest hold
+ *     the zigzag encoded difference from the previous record in that unit.
+ *     The record has the previous record's timezone.
+ *
+ * Deltas are computed on the wall clock time in the record's own timezone,
+ * so they work for any timezone as long as it doesn't change.
+ */
+
+/**
+ * Encodes timestamps into a sequence.
+ *
+ * All members are private.
+ */
+typedef struct
+{
+    int keyframe_interval;
+    int records_since_keyframe;
+    bool has_previous;
+    int64_t previous_wall_ns;
+    ct_timezone previous_timezone;
+} ct_sequence_encoder;
+
+/**
+ * Decodes timestamps from a sequence.
+ *
+ * All members are private.
+ */
+typedef struct
+{
+    bool has_previous;
+    int64_t previous_wall_ns;
+    ct_timezone previous_timezone;
+} ct_sequence_decoder;
+
+/**
+ * Initialize (or reset) a sequence encoder.
+ *
+ * A keyframe is written at least every keyframe_interval records (which
+ * bounds how far a reader must decode after seeking). If keyframe_interval
+ * is 0, keyframes are only written when a record can't be expressed as a
+ * delta (e.g. the timezone changed).
+ */
+COMPACT_TIME_PUBLIC void ct_sequence_encoder_init(ct_sequence_encoder* encoder, int keyframe_interval);
+
+/**
+ * Encode the next timestamp of a sequence to a destination buffer.
+ *
+ * The encoder state only advances if the record is written.
+ *
+ * Returns the number of bytes written to encode the object or an error code.
+ */
+COMPACT_TIME_PUBLIC int ct_sequence_encoder_encode(ct_sequence_encoder* encoder,
+                                                   const ct_timestamp* timestamp,
+                                                   uint8_t* dst,
+                                                   int dst_length);
+
+/**
+ * Initialize (or reset) a sequence decoder. Decoding must start at a keyframe.
+ */
+COMPACT_TIME_PUBLIC void ct_sequence_decoder_init(ct_sequence_decoder* decoder);
+
+/**
+ * Decode the next timestamp of a sequence from a source buffer.
+ *
+ * The decoder state only advances if a record is decoded.
+ *
+ * Returns the number of bytes read to decode the object or an error code.
+ * A delta without a preceding keyframe is ERROR_OUT_OF_RANGE.
+ */
+COMPACT_TIME_PUBLIC int ct_sequence_decoder_decode(ct_sequence_decoder* decoder,
+                                                   const uint8_t* src,
+                                                   int src_length,
+                                                   ct_timestamp* timestamp);
+
+/**
+ * Find the last keyframe at or before the record at record_index (counting
+ * from 0 at the start of src, which must be a keyframe), without decoding
+ * any records. Keyframes are only measured, so a keyframe with out-of-range
+ * fields is reported when it is decoded rather than here.
+ *
+ * To read the record, initialize a decoder, start decoding at the returned
+ * offset, and skip (record_index - *keyframe_record_index) records.
+ *
+ * Returns the offset of the keyframe within src, or an error code. If
+ * record_index is past the end of the sequence, returns ERROR_OUT_OF_RANGE.
+ */
+COMPACT_TIME_PUBLIC int ct_sequence_seek_keyframe(const uint8_t* src,
+                                                  int src_length,
+                                                  int record_index,
+                                                  int* keyframe_record_index);
+
+
+#ifdef __cplusplus 
+}
+#endif
+
+#endif // KS_compact_time_sequence_H
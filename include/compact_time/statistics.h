@@ -0,0 +1,113 @@
+/*
+ * Compact Time: Codec Statistics
+ * ==============================
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef KS_compact_time_statistics_H
+#define KS_compact_time_statistics_H
+
+#include "compact_time/compact_time.h"
+
+#ifdef __cplusplus 
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+// -----
+// Types
+// -----
+
+/*
+ * Counters for the records going through ct_timestamp_encode(),
+ * ct_timestamp_decode() and their batch versions, and everything built on
+ * them such as streams and sequences. The UTC seconds fast paths are only
+ * counted when they fall back to the general codec.
+ *
+ * Statistics are compiled out by default, and cost nothing. Build with
+ * -Dstatistics=true (or define COMPACT_TIME_STATISTICS to 1 before including
+ * compact_time_inline.h) to compile them in.
+ *
+ * Each thread counts into its own block of counters, so counting takes no
+ * locks and no atomic read-modify-write instructions. The blocks of threads
+ * that have exited are handed to new threads, so their counts are kept.
+ * On Windows a block is released when the fiber that first counted into it
+ * is deleted or its thread exits, so a thread must not delete that fiber
+ * while it keeps counting.
+ * Counters only ever grow: take two snapshots and subtract them to measure
+ * an interval.
+ */
+typedef struct
+{
+    // Successfully encoded or decoded records
+    uint64_t records;
+    uint64_t bytes;
+    // Records by subsecond magnitude (0 = seconds, 1 = milliseconds,
+    // 2 = microseconds, 3 = nanoseconds)
+    uint64_t magnitudes[4];
+    // Records by ct_tz_type
+    uint64_t timezone_types[3];
+    // Records by number of RVLQ year groups (1-5, with longer padded
+    // encodings counted as 5)
+    uint64_t year_group_counts[6];
+    // Calls that failed because the buffer was too short (FAILURE_AT_POS)
+    uint64_t failures_at_pos;
+    // Calls that failed with ERROR_OUT_OF_RANGE
+    uint64_t out_of_range;
+} ct_codec_statistics;
+
+typedef struct
+{
+    ct_codec_statistics encode;
+    ct_codec_statistics decode;
+} ct_statistics;
+
+
+// ---
+// API
+// ---
+
+/**
+ * Check if statistics were compiled into the library.
+ */
+COMPACT_TIME_PUBLIC bool ct_statistics_enabled(void);
+
+/**
+ * Get the totals of every thread's counters. Counts from other threads that
+ * are still running may be slightly behind.
+ *
+ * If statistics are disabled, all counters are 0.
+ */
+COMPACT_TIME_PUBLIC void ct_statistics_get(ct_statistics* statistics);
+
+
+#ifdef __cplusplus 
+}
+#endif
+
+#endif // KS_compact_time_statistics_H
@@ -0,0 +1,151 @@
+/*
+ * Compact Time: Streaming
+ * =======================
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef KS_compact_time_stream_H
+#define KS_compact_time_stream_H
+
+#include "compact_time/compact_time.h"
+
+#ifdef __cplusplus 
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+// ---
+// API
+// ---
+
+/**
+ * Room for the largest record the decoder can encounter: an 8 byte
+ * accumulator, a 5 byte year, and a length-prefixed timezone name whose
+ * length byte can claim up to 127 bytes.
+ */
+#define CT_STREAM_BUFFER_SIZE 144
+
+/**
+ * Decodes timestamps from data that arrives in arbitrarily sized chunks.
+ *
+ * A record that straddles a chunk boundary is held in the decoder until the
+ * rest of it arrives. Its structure is walked to size what it still needs,
+ * and every record is decoded exactly once.
+ *
+ * All members are private.
+ */
+typedef struct
+{
+    uint8_t buffer[CT_STREAM_BUFFER_SIZE];
+    int buffered_length;
+} ct_stream_decoder;
+
+/**
+ * Encodes timestamps into output chunks of arbitrary size.
+ *
+ * A record that doesn't fit in the current output chunk is held in the
+ * encoder and its remaining bytes are written at the start of the next one.
+ *
+ * All members are private.
+ */
+typedef struct
+{
+    uint8_t buffer[CT_STREAM_BUFFER_SIZE];
+    int pending_offset;
+    int pending_length;
+} ct_stream_encoder;
+
+/**
+ * Initialize (or reset) a stream decoder.
+ */
+COMPACT_TIME_PUBLIC void ct_stream_decoder_init(ct_stream_decoder* decoder);
+
+/**
+ * Decode as many timestamps as possible from the next chunk of a stream.
+ *
+ * Decoding stops when the chunk is used up or max_timestamp_count records
+ * have been decoded. Any trailing partial record is kept by the decoder and
+ * completed on the next call.
+ *
+ * If records_processed is not NULL, it receives the number of timestamps
+ * written to the timestamps array.
+ *
+ * Returns the number of chunk bytes consumed (feed the rest again later), or
+ * ERROR_OUT_OF_RANGE if the stream contains invalid data.
+ */
+COMPACT_TIME_PUBLIC int ct_stream_decoder_feed(ct_stream_decoder* decoder,
+                                               const uint8_t* chunk,
+                                               int chunk_length,
+                                               ct_timestamp* timestamps,
+                                               int max_timestamp_count,
+                                               int* records_processed);
+
+/**
+ * Check if the decoder is holding part of a record (i.e. the stream would be
+ * truncated if it ended here).
+ */
+COMPACT_TIME_PUBLIC bool ct_stream_decoder_is_mid_record(const ct_stream_decoder* decoder);
+
+/**
+ * Initialize (or reset) a stream encoder.
+ */
+COMPACT_TIME_PUBLIC void ct_stream_encoder_init(ct_stream_encoder* encoder);
+
+/**
+ * Encode timestamps into the next output chunk of a stream.
+ *
+ * Any bytes held over from the previous call are written first. Encoding
+ * stops when the chunk is full; a record that only partially fits counts as
+ * processed and its remainder is held for the next call.
+ *
+ * If records_processed is not NULL, it receives the number of timestamps
+ * accepted from the timestamps array.
+ *
+ * Returns the number of bytes written to dst, or ERROR_OUT_OF_RANGE if a
+ * timestamp cannot be encoded.
+ */
+COMPACT_TIME_PUBLIC int ct_stream_encoder_encode(ct_stream_encoder* encoder,
+                                                 const ct_timestamp* timestamps,
+                                                 int timestamp_count,
+                                                 uint8_t* dst,
+                                                 int dst_length,
+                                                 int* records_processed);
+
+/**
+ * Write out any bytes held over from a previous encode call.
+ *
+ * Returns the number of bytes written to dst. Call until it returns 0.
+ */
+COMPACT_TIME_PUBLIC int ct_stream_encoder_flush(ct_stream_encoder* encoder, uint8_t* dst, int dst_length);
+
+
+#ifdef __cplusplus 
+}
+#endif
+
+#endif // KS_compact_time_stream_H
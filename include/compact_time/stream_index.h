@@ -0,0 +1,183 @@
+/*
+ * Compact Time: Stream Index
+ * ==========================
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef KS_compact_time_stream_index_H
+#define KS_compact_time_stream_index_H
+
+#include "compact_time/compact_time.h"
+
+#ifdef __cplusplus 
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+// ---
+// API
+// ---
+
+/*
+ * A stream index is a side file that records the byte offset of every Kth
+ * record in a stream of back-to-back encoded timestamps, so that a record can
+ * be found by number or by time without scanning the stream from the start.
+ *
+ * Serialized layout (all fields little endian):
+ *
+ *   - uint32: K (the interval between indexed records)
+ *   - uint8:  offset width in bytes (4 if the stream is under 4 GiB, else 8)
+ *   - 3 bytes reserved (0)
+ *   - uint64: record count
+ *   - uint64: stream length in bytes
+ *   - offsets of records 0, K, 2K, ..., each of the offset width
+ */
+
+#define CT_STREAM_INDEX_HEADER_SIZE 24
+
+/**
+ * Builds a stream index as a stream is written or scanned.
+ *
+ * All members are private.
+ */
+typedef struct
+{
+    int interval;
+    int64_t record_count;
+    int64_t stream_length;
+    int64_t* offsets;
+    int64_t offset_count;
+    int64_t offset_capacity;
+} ct_stream_index_builder;
+
+/**
+ * A serialized stream index opened against its stream. Neither is copied, so
+ * both must remain valid while the index is in use.
+ *
+ * All members are private.
+ */
+typedef struct
+{
+    const uint8_t* offsets;
+    int offset_width;
+    int interval;
+    int64_t record_count;
+    int64_t offset_count;
+    const uint8_t* stream;
+    int64_t stream_length;
+} ct_stream_index;
+
+/**
+ * Initialize a builder that indexes every interval'th record.
+ *
+ * Returns false if interval is less than 1 or memory could not be allocated.
+ */
+COMPACT_TIME_PUBLIC bool ct_stream_index_builder_init(ct_stream_index_builder* builder, int interval);
+
+/**
+ * Release all memory held by a builder.
+ */
+COMPACT_TIME_PUBLIC void ct_stream_index_builder_free(ct_stream_index_builder* builder);
+
+/**
+ * Record that an encoded timestamp of record_length bytes was appended to the
+ * stream (e.g. the return value of ct_timestamp_encode()).
+ *
+ * Returns false if memory could not be allocated.
+ */
+COMPACT_TIME_PUBLIC bool ct_stream_index_builder_add(ct_stream_index_builder* builder, int record_length);
+
+/**
+ * Index the back-to-back records in the next chunk of an existing stream.
+ *
+ * Scanning stops before a trailing partial record; pass its bytes again at
+ * the start of the next chunk.
+ *
+ * Returns the number of chunk bytes consumed, or ERROR_OUT_OF_RANGE if memory
+ * could not be allocated.
+ */
+COMPACT_TIME_PUBLIC int ct_stream_index_builder_scan(ct_stream_index_builder* builder,
+                                                     const uint8_t* chunk,
+                                                     int chunk_length);
+
+/**
+ * Get the number of bytes needed to serialize the index built so far.
+ */
+COMPACT_TIME_PUBLIC int64_t ct_stream_index_serialized_size(const ct_stream_index_builder* builder);
+
+/**
+ * Serialize the index built so far.
+ *
+ * Returns the number of bytes written or an error code.
+ */
+COMPACT_TIME_PUBLIC int64_t ct_stream_index_serialize(const ct_stream_index_builder* builder,
+                                                      uint8_t* dst,
+                                                      int64_t dst_length);
+
+/**
+ * Open a serialized index against the stream it was built from.
+ *
+ * Returns 0, or ERROR_OUT_OF_RANGE if the index is malformed or was built
+ * from a stream of a different length.
+ */
+COMPACT_TIME_PUBLIC int ct_stream_index_open(ct_stream_index* index,
+                                             const uint8_t* index_data,
+                                             int64_t index_length,
+                                             const uint8_t* stream,
+                                             int64_t stream_length);
+
+/**
+ * Get the number of records in an indexed stream.
+ */
+COMPACT_TIME_PUBLIC int64_t ct_stream_index_record_count(const ct_stream_index* index);
+
+/**
+ * Find the record at record_index, skipping at most K-1 records past the
+ * nearest indexed one. If timestamp is not NULL, the record is decoded into it.
+ *
+ * Returns the record's offset within the stream, or ERROR_OUT_OF_RANGE if
+ * record_index is out of range or the stream is malformed.
+ */
+COMPACT_TIME_PUBLIC int64_t ct_stream_seek(const ct_stream_index* index, int64_t record_index, ct_timestamp* timestamp);
+
+/**
+ * Binary search a stream whose records are in ascending order for the first
+ * record at or after the given date and time. Records are compared on their
+ * date and time fields only; timezones are not taken into account.
+ *
+ * Returns the record's index (the record count if every record is earlier),
+ * or ERROR_OUT_OF_RANGE if the stream is malformed.
+ */
+COMPACT_TIME_PUBLIC int64_t ct_stream_find(const ct_stream_index* index, const ct_timestamp* timestamp);
+
+
+#ifdef __cplusplus 
+}
+#endif
+
+#endif // KS_compact_time_stream_index_H
@@ -0,0 +1,141 @@
+/*
+ * Compact Time: Timestamp Columns
+ * ===============================
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef KS_compact_time_timestamp_columns_H
+#define KS_compact_time_timestamp_columns_H
+
+#include "compact_time/compact_time.h"
+
+#ifdef __cplusplus 
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+// ---
+// API
+// ---
+
+/**
+ * Timezone dictionary index reserved for UTC. Every other index refers to an
+ * entry in ct_timestamp_columns.timezones.
+ */
+#define CT_TIMEZONE_INDEX_UTC 0
+
+/**
+ * Columnar (struct-of-arrays) storage for decoded timestamps.
+ *
+ * Each date/time field lives in its own array (see ct_timestamp_fields), and
+ * each row refers to its timezone through a small index into a dictionary of
+ * distinct timezones. Scans only touch the columns they read.
+ *
+ * All members are read-only to callers; use the functions below to modify.
+ */
+typedef struct
+{
+    ct_timestamp_fields fields;
+    uint16_t* timezone_index;
+    ct_timezone* timezones;
+    int timezone_count;
+    int timezone_capacity;
+    int last_timezone_index;
+    int row_count;
+    int row_capacity;
+} ct_timestamp_columns;
+
+/**
+ * Initialize a column container with room for row_capacity rows.
+ *
+ * Returns false if memory could not be allocated.
+ */
+COMPACT_TIME_PUBLIC bool ct_timestamp_columns_init(ct_timestamp_columns* columns, int row_capacity);
+
+/**
+ * Release all memory held by a column container.
+ */
+COMPACT_TIME_PUBLIC void ct_timestamp_columns_free(ct_timestamp_columns* columns);
+
+/**
+ * Remove all rows and timezones from a column container, keeping its memory.
+ */
+COMPACT_TIME_PUBLIC void ct_timestamp_columns_clear(ct_timestamp_columns* columns);
+
+/**
+ * Append a timestamp as a new row.
+ *
+ * Returns the new row's index, or ERROR_OUT_OF_RANGE if the container is full
+ * or the timezone dictionary cannot grow.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_columns_append(ct_timestamp_columns* columns, const ct_timestamp* timestamp);
+
+/**
+ * Copy a row out of a column container into a timestamp.
+ */
+COMPACT_TIME_PUBLIC void ct_timestamp_columns_get(const ct_timestamp_columns* columns, int row, ct_timestamp* timestamp);
+
+/**
+ * Decode back-to-back timestamps from a source buffer, appending them as rows.
+ *
+ * Decoding stops when the buffer is exhausted or the container is full.
+ * Runs of UTC timestamps are decoded directly into the column arrays.
+ *
+ * If records_processed is not NULL, it receives the number of rows appended.
+ *
+ * Returns the total number of bytes read or an error code. Failure offsets
+ * are relative to the start of src.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_decode_columns(const uint8_t* src,
+                                                    int src_length,
+                                                    ct_timestamp_columns* columns,
+                                                    int* records_processed);
+
+/**
+ * Encode row_count rows starting at first_row back-to-back into a destination
+ * buffer. Encoding stops at the first row that fails.
+ *
+ * If records_processed is not NULL, it receives the number of rows that were
+ * fully encoded.
+ *
+ * Returns the total number of bytes written or an error code. Failure offsets
+ * are relative to the start of dst.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_encode_columns(const ct_timestamp_columns* columns,
+                                                    int first_row,
+                                                    int row_count,
+                                                    uint8_t* dst,
+                                                    int dst_length,
+                                                    int* records_processed);
+
+
+#ifdef __cplusplus 
+}
+#endif
+
+#endif // KS_compact_time_timestamp_columns_H
@@ -0,0 +1,85 @@
+/*
+ * Compact Time: Encoded Comparison
+ * ================================
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef KS_compact_time_timestamp_compare_H
+#define KS_compact_time_timestamp_compare_H
+
+#include "compact_time/compact_time.h"
+
+#ifdef __cplusplus 
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+
+// ---
+// API
+// ---
+
+/*
+ * Encoded timestamps order by year, month, day, hour, minute, second and
+ * nanosecond, read straight from the accumulator and year groups. Records
+ * with the same fields order UTC first, then by their encoded timezone
+ * bytes (compared in place), so only identical timestamps compare equal.
+ *
+ * As with ct_timestamp_key, timestamps in different timezones are ordered by
+ * their fields, not by instant.
+ */
+
+/**
+ * Compare the encoded timestamps at the start of a and b.
+ *
+ * Returns a negative value if a sorts first, a positive value if b sorts
+ * first, and 0 if they are the same timestamp. Records that can't be decoded
+ * sort after all others, and compare equal to each other.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_compare_encoded(const uint8_t* a, int a_length, const uint8_t* b, int b_length);
+
+/**
+ * Sort the offsets of encoded records in src (as produced by the batch
+ * encoders) into the order of the records, as ct_timestamp_compare_encoded()
+ * would order them. The sort is stable, and does a radix sort on the fields
+ * that were read from each record once.
+ *
+ * Returns 0, or an error code. Failure offsets are relative to the start of
+ * src. Returns ERROR_OUT_OF_RANGE if an offset is outside of src, a record
+ * is out of range, or memory could not be allocated. On failure,
+ * record_offsets is left unchanged.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_sort_encoded(const uint8_t* src,
+                                                  int src_length,
+                                                  int* record_offsets,
+                                                  int record_count);
+
+
+#ifdef __cplusplus 
+}
+#endif
+
+#endif // KS_compact_time_timestamp_compare_H
@@ -0,0 +1,142 @@
+/*
+ * Compact Time: Sortable Keys
+ * ===========================
+ *
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef KS_compact_time_timestamp_key_H
+#define KS_compact_time_timestamp_key_H
+
+#include "compact_time/compact_time.h"
+
+#ifdef __cplusplus 
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+
+// ---
+// API
+// ---
+
+/*
+ * An alternate encoding of ct_timestamp for use as a key in ordered stores.
+ * Keys compare with memcmp() in the order of their fields, so range scans
+ * can run directly on the raw bytes.
+ *
+ * Layout (big endian, most significant field first):
+ *
+ *     | Field      | Bits | Notes                  |
+ *     | ---------- | ---- | ---------------------- |
+ *     | Year       |   32 | Sign bit flipped       |
+ *     | Month      |    4 |                        |
+ *     | Day        |    5 |                        |
+ *     | Hour       |    5 |                        |
+ *     | Minute     |    6 |                        |
+ *     | Second     |    6 |                        |
+ *     | Nanosecond |   30 |                        |
+ *     | TZ type    |    8 | ct_tz_type             |
+ *     | TZ data    |  ... | See below              |
+ *
+ * The timezone data is nothing for UTC, the name followed by a NUL byte for
+ * named timezones, and the latitude then longitude (16 bits each, sign bit
+ * flipped) for locations.
+ *
+ * Keys order by the fields as written, then by timezone, so timestamps in
+ * different timezones are not ordered by instant. Store UTC timestamps where
+ * keys must order by instant.
+ *
+ * Keys are never a prefix of each other, so they can also be concatenated
+ * into composite keys.
+ */
+
+enum
+{
+    CT_TIMESTAMP_KEY_MIN_SIZE = 12,
+    CT_TIMESTAMP_KEY_MAX_SIZE = CT_TIMESTAMP_KEY_MIN_SIZE + CT_TIMEZONE_MAX_ENCODED_SIZE,
+};
+
+/**
+ * Get the number of bytes that a timestamp's key will occupy.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_key_size(const ct_timestamp* timestamp);
+
+/**
+ * Encode a timestamp as a sortable key.
+ *
+ * Returns the number of bytes written, or an error code. Returns
+ * ERROR_OUT_OF_RANGE if a field doesn't fit the compact encoding, or the
+ * nanosecond field is over 999999999.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_key_encode(const ct_timestamp* timestamp, uint8_t* dst, int dst_length);
+
+/**
+ * Decode a sortable key.
+ *
+ * Returns the number of bytes read, or an error code. Returns
+ * ERROR_OUT_OF_RANGE if the key is malformed.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_key_decode(const uint8_t* src, int src_length, ct_timestamp* timestamp);
+
+/**
+ * Convert the compact encoded timestamp at the start of src to a sortable
+ * key.
+ *
+ * If bytes_read is not NULL, it receives the length of the compact record,
+ * or 0 if it could not be decoded.
+ *
+ * Returns the number of bytes written, or an error code. Failure offsets
+ * refer to src if the record could not be decoded, and to dst otherwise.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_key_from_encoded(const uint8_t* src,
+                                                      int src_length,
+                                                      uint8_t* dst,
+                                                      int dst_length,
+                                                      int* bytes_read);
+
+/**
+ * Convert the sortable key at the start of src to a compact encoded
+ * timestamp.
+ *
+ * If bytes_read is not NULL, it receives the length of the key, or 0 if it
+ * could not be decoded.
+ *
+ * Returns the number of bytes written, or an error code. Failure offsets
+ * refer to src if the key could not be decoded, and to dst otherwise.
+ */
+COMPACT_TIME_PUBLIC int ct_timestamp_key_to_encoded(const uint8_t* src,
+                                                    int src_length,
+                                                    uint8_t* dst,
+                                                    int dst_length,
+                                                    int* bytes_read);
+
+
+#ifdef __cplusplus 
+}
+#endif
+
+#endif // KS_compact_time_timestamp_key_H
@@ -0,0 +1,172 @@
+/*
+ * Compact Time: Timezone Arena
+ * ============================
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef KS_compact_time_timezone_arena_H
+#define KS_compact_time_timezone_arena_H
+
+#include "compact_time/compact_time.h"
+
+#ifdef __cplusplus 
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+
+// ---
+// API
+// ---
+
+/**
+ * Number of recently stored names that the arena remembers, so that a name
+ * repeated across a batch is only stored once.
+ */
+#define CT_TIMEZONE_ARENA_RECENT_NAME_COUNT 16
+
+/**
+ * The most arena space that storing one name can take: its length byte, up
+ * to 63 characters, and a null terminator.
+ */
+#define CT_TIMEZONE_ARENA_MAX_NAME_SIZE 65
+
+/**
+ * A bump arena over caller-supplied memory, holding the timezone names of
+ * decoded ct_arena_timestamp records. Names are only ever appended, and are
+ * all released at once by ct_timezone_arena_reset().
+ *
+ * Each name is stored in its encoded form followed by a null terminator, so
+ * it can be read as a C string and written back out without re-encoding.
+ *
+ * All members are read-only to callers; use the functions below to modify.
+ */
+typedef struct
+{
+    uint8_t* memory;
+    int capacity;
+    int used;
+    uint32_t recent_names[CT_TIMEZONE_ARENA_RECENT_NAME_COUNT];
+} ct_timezone_arena;
+
+/**
+ * A decoded timestamp whose timezone name (for CT_TZ_STRING) is stored in a
+ * timezone arena. Unlike ct_timestamp, names of every length the encoder
+ * writes (up to 63 bytes) are supported, and the record is a fraction of the
+ * size.
+ */
+typedef struct
+{
+    ct_date date;
+    uint32_t nanosecond;   // 0-999999999
+    uint8_t hour;          // 0-23
+    uint8_t minute;        // 0-59
+    uint8_t second;        // 0-60 (for leap seconds)
+    uint8_t timezone_type; // ct_tz_type
+    int16_t latitude;      // Units: hundredths of a degree (CT_TZ_LATLONG only)
+    int16_t longitude;     // Units: hundredths of a degree (CT_TZ_LATLONG only)
+    uint32_t name_offset;  // Arena offset of the name (CT_TZ_STRING only)
+} ct_arena_timestamp;
+
+/**
+ * Initialize a timezone arena over capacity bytes of memory, which must
+ * outlive the arena. The arena never allocates.
+ */
+COMPACT_TIME_PUBLIC void ct_timezone_arena_init(ct_timezone_arena* arena, void* memory, int capacity);
+
+/**
+ * Release every name in a timezone arena at once. Records decoded into the
+ * arena must not be used afterwards.
+ */
+COMPACT_TIME_PUBLIC void ct_timezone_arena_reset(ct_timezone_arena* arena);
+
+/**
+ * Get the null-terminated name at an offset taken from a ct_arena_timestamp.
+ */
+COMPACT_TIME_PUBLIC const char* ct_timezone_arena_get_name(const ct_timezone_arena* arena, uint32_t name_offset);
+
+/**
+ * Get the length of the name at an offset taken from a ct_arena_timestamp.
+ */
+COMPACT_TIME_PUBLIC int ct_timezone_arena_get_name_length(const ct_timezone_arena* arena, uint32_t name_offset);
+
+/**
+ * Get the number of bytes still free in a timezone arena.
+ */
+COMPACT_TIME_PUBLIC int ct_timezone_arena_remaining(const ct_timezone_arena* arena);
+
+/**
+ * Decode a timestamp from a source buffer, storing its timezone name (if
+ * any) in the arena rather than copying it into the record.
+ *
+ * Returns the number of bytes read to decode the object or an error code.
+ * If the name doesn't fit in the arena, returns ERROR_OUT_OF_RANGE (the same
+ * code as for an invalid name) and leaves the arena as it was. A failure while
+ * ct_timezone_arena_remaining() is at least CT_TIMEZONE_ARENA_MAX_NAME_SIZE
+ * was not caused by the arena, so a caller can reset the arena and retry
+ * only when it was.
+ */
+COMPACT_TIME_PUBLIC int ct_arena_timestamp_decode(ct_timezone_arena* arena,
+                                                  const uint8_t* src,
+                                                  int src_length,
+                                                  ct_arena_timestamp* timestamp);
+
+/**
+ * Decode back-to-back timestamps from a source buffer into arena-backed
+ * records, stopping when the buffer is exhausted or max_timestamp_count
+ * records have been decoded. Decoding stops at the first record that fails,
+ * including one that doesn't fit in the arena.
+ *
+ * record_offsets and records_processed work as in ct_timestamp_decode_batch().
+ *
+ * Returns the total number of bytes read or an error code. Failure offsets
+ * are relative to the start of src.
+ */
+COMPACT_TIME_PUBLIC int ct_arena_timestamp_decode_batch(ct_timezone_arena* arena,
+                                                        const uint8_t* src,
+                                                        int src_length,
+                                                        ct_arena_timestamp* timestamps,
+                                                        int max_timestamp_count,
+                                                        int* record_offsets,
+                                                        int* records_processed);
+
+/**
+ * Encode an arena-backed timestamp. The name is written from the arena's
+ * stored encoded form.
+ *
+ * Returns the number of bytes written to encode the object or an error code.
+ */
+COMPACT_TIME_PUBLIC int ct_arena_timestamp_encode(const ct_timezone_arena* arena,
+                                                  const ct_arena_timestamp* timestamp,
+                                                  uint8_t* dst,
+                                                  int dst_length);
+
+
+#ifdef __cplusplus 
+}
+#endif
+
+#endif // KS_compact_time_timezone_arena_H
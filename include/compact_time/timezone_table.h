@@ -0,0 +1,155 @@
+/*
+ * Compact Time: Timezone Table
+ * ============================
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef KS_compact_time_timezone_table_H
+#define KS_compact_time_timezone_table_H
+
+#include "compact_time/compact_time.h"
+
+#ifdef __cplusplus 
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+// ---
+// API
+// ---
+
+/**
+ * Longest timezone name that can be encoded.
+ */
+#define CT_MAX_TIMEZONE_NAME_LENGTH 63
+
+/**
+ * An interned timezone name, along with its ready-made encoded form.
+ */
+typedef struct
+{
+    char name[CT_MAX_TIMEZONE_NAME_LENGTH + 1];
+    uint8_t encoded[CT_MAX_TIMEZONE_NAME_LENGTH + 1];
+    int encoded_length;
+} ct_interned_timezone_name;
+
+/**
+ * A table of interned timezone names. Each distinct name is stored once and
+ * identified by a small integer id. Entries never move once interned, so
+ * name pointers remain valid until the table is freed.
+ *
+ * All members are read-only to callers; use the functions below to modify.
+ */
+typedef struct
+{
+    ct_interned_timezone_name* entries;
+    int entry_count;
+    int entry_capacity;
+    int32_t* hash_slots;
+    int hash_slot_mask;
+    int last_id;
+} ct_timezone_table;
+
+/**
+ * A timezone whose name (for CT_TZ_STRING) refers to a timezone table entry.
+ */
+typedef struct
+{
+    ct_tz_type type;
+    int16_t latitude;   // Units: hundredths of a degree
+    int16_t longitude;  // Units: hundredths of a degree
+    int id;             // Timezone table id (CT_TZ_STRING only)
+    const char* name;   // Timezone table name (CT_TZ_STRING only)
+} ct_interned_timezone;
+
+/**
+ * A timestamp whose timezone name is interned in a timezone table.
+ */
+typedef struct
+{
+    ct_date date;
+    uint8_t hour;        // 0-23
+    uint8_t minute;      // 0-59
+    uint8_t second;      // 0-60 (for leap seconds)
+    uint32_t nanosecond; // 0-999999999
+    ct_interned_timezone timezone;
+} ct_interned_timestamp;
+
+/**
+ * Initialize a timezone table with room for max_name_count distinct names.
+ *
+ * Returns false if memory could not be allocated.
+ */
+COMPACT_TIME_PUBLIC bool ct_timezone_table_init(ct_timezone_table* table, int max_name_count);
+
+/**
+ * Release all memory held by a timezone table.
+ */
+COMPACT_TIME_PUBLIC void ct_timezone_table_free(ct_timezone_table* table);
+
+/**
+ * Intern a timezone name (which need not be null-terminated).
+ *
+ * Returns the name's id, or ERROR_OUT_OF_RANGE if the name is too long, is not
+ * printable ASCII, or the table is full.
+ */
+COMPACT_TIME_PUBLIC int ct_timezone_table_intern(ct_timezone_table* table, const char* name, int name_length);
+
+/**
+ * Get the null-terminated name for an id returned by ct_timezone_table_intern.
+ */
+COMPACT_TIME_PUBLIC const char* ct_timezone_table_get_name(const ct_timezone_table* table, int id);
+
+/**
+ * Decode a timestamp from a source buffer, interning its timezone name (if
+ * any) into the table rather than copying it into the record.
+ *
+ * Returns the number of bytes read to decode the object or an error code.
+ */
+COMPACT_TIME_PUBLIC int ct_interned_timestamp_decode(ct_timezone_table* table,
+                                                     const uint8_t* src,
+                                                     int src_length,
+                                                     ct_interned_timestamp* timestamp);
+
+/**
+ * Encode a timestamp whose timezone name (if any) is identified by its id in
+ * the table. The name is written from the table's cached encoded form.
+ *
+ * Returns the number of bytes written to encode the object or an error code.
+ */
+COMPACT_TIME_PUBLIC int ct_interned_timestamp_encode(const ct_timezone_table* table,
+                                                     const ct_interned_timestamp* timestamp,
+                                                     uint8_t* dst,
+                                                     int dst_length);
+
+
+#ifdef __cplusplus 
+}
+#endif
+
+#endif // KS_compact_time_timezone_table_H
@@ -0,0 +1,273 @@
+/*
+ * Compact Time (internal definitions)
+ * ===================================
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef KS_compact_time_internal_H
+#define KS_compact_time_internal_H
+
+// Encoding layout shared between the library's translation units.
+// Not part of the public API.
+
+#include "compact_time/compact_time.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// Linkage of the library's cross-file internal functions. The header-only
+// build (compact_time_inline.h) makes them static inline.
+#ifndef COMPACT_TIME_INTERNAL
+    #define COMPACT_TIME_INTERNAL
+#endif
+
+static const int YEAR_BIAS = 2000;
+static const int BITS_PER_YEAR_GROUP = 7;
+
+#define FAILURE_AT_POS(A) -(A)
+
+#define SIZE_UTC       1
+#define SIZE_MAGNITUDE 2
+#define SIZE_SUBSECOND 10
+#define SIZE_SECOND    6
+#define SIZE_MINUTE    6
+#define SIZE_HOUR      5
+#define SIZE_DAY       5
+#define SIZE_MONTH     4
+
+#define SIZE_LATITUDE  15
+#define SIZE_LONGITUDE 16
+
+#define SIZE_DATE_YEAR_UPPER_BITS 7
+
+// Bit positions of the timestamp fields within the base accumulator
+#define SHIFT_SECOND    SIZE_MAGNITUDE
+#define SHIFT_MINUTE    (SHIFT_SECOND + SIZE_SECOND)
+#define SHIFT_HOUR      (SHIFT_MINUTE + SIZE_MINUTE)
+#define SHIFT_DAY       (SHIFT_HOUR + SIZE_HOUR)
+#define SHIFT_MONTH     (SHIFT_DAY + SIZE_DAY)
+#define SHIFT_SUBSECOND (SHIFT_MONTH + SIZE_MONTH)
+
+
+static const int BASE_SIZE_TIME = SIZE_UTC + SIZE_MAGNITUDE + SIZE_SECOND + SIZE_MINUTE + SIZE_HOUR;
+static const int BASE_SIZE_TIMESTAMP = SIZE_MAGNITUDE + SIZE_SECOND + SIZE_MINUTE + SIZE_HOUR + SIZE_DAY + SIZE_MONTH;
+
+static const int BYTE_COUNT_DATE = 2;
+
+static const unsigned MASK_MAGNITUDE = ((1<<SIZE_MAGNITUDE)-1);
+static const unsigned MASK_SECOND    = ((1<<SIZE_SECOND)-1);
+static const unsigned MASK_MINUTE    = ((1<<SIZE_MINUTE)-1);
+static const unsigned MASK_HOUR      = ((1<<SIZE_HOUR)-1);
+static const unsigned MASK_DAY       = ((1<<SIZE_DAY)-1);
+static const unsigned MASK_MONTH     = ((1<<SIZE_MONTH)-1);
+
+static const unsigned SHIFT_LENGTH = 1;
+
+static const unsigned MASK_LATLONG   = 1;
+static const unsigned SHIFT_LATITUDE = 1;
+static const unsigned SHIFT_LONITUDE = 16;
+static const unsigned MASK_LATITUDE  = ((1<<SIZE_LATITUDE)-1);
+static const unsigned MASK_LONGITUDE = ((1<<SIZE_LONGITUDE)-1);
+
+static const unsigned MASK_DATE_YEAR_UPPER_BITS = (1 << SIZE_DATE_YEAR_UPPER_BITS) - 1;
+
+static const uint8_t g_timestamp_year_upper_bits[] = { 4, 2, 0, 6 };
+static const unsigned g_subsec_multipliers[] = { 1, 1000000, 1000, 1 };
+// get_base_byte_count(BASE_SIZE_TIMESTAMP, magnitude) for each magnitude
+static const int g_timestamp_base_byte_counts[] = { 4, 5, 6, 8 };
+
+static const uint8_t RVLQ_CONTINUATION_BIT = 0x80;
+
+static const int MAX_TIMEZONE_LENGTH = 63;
+static const int MIN_LATITUDE = -9000;
+static const int MAX_LATITUDE = 9000;
+static const int MIN_LONGITUDE = -18000;
+static const int MAX_LONGITUDE = 18000;
+
+/**
+ * Encode the fixed part of a timestamp (everything ahead of the timezone).
+ */
+COMPACT_TIME_INTERNAL int ct_internal_timestamp_base_encode(const ct_date* date,
+                                                           uint8_t hour,
+                                                           uint8_t minute,
+                                                           uint8_t second,
+                                                           uint32_t nanosecond,
+                                                           bool timezone_is_utc,
+                                                           uint8_t* dst,
+                                                           int dst_length);
+
+/**
+ * Decode the fixed part of a timestamp (everything ahead of the timezone).
+ */
+COMPACT_TIME_INTERNAL int ct_internal_timestamp_base_decode(const uint8_t* src,
+                                                           int src_length,
+                                                           ct_date* date,
+                                                           uint8_t* hour,
+                                                           uint8_t* minute,
+                                                           uint8_t* second,
+                                                           uint32_t* nanosecond,
+                                                           bool* timezone_is_utc);
+
+/**
+ * Encode/decode a latitude/longitude timezone body.
+ */
+COMPACT_TIME_INTERNAL int ct_internal_latlong_encode(int16_t latitude, int16_t longitude, uint8_t* dst, int dst_length);
+COMPACT_TIME_INTERNAL int ct_internal_latlong_decode(const uint8_t* src, int src_length, int16_t* latitude, int16_t* longitude);
+
+/**
+ * Get the number of days in a month (1-12) of an astronomical year (0 is 1 BC).
+ */
+COMPACT_TIME_INTERNAL int ct_internal_get_days_in_month(int64_t year, int month);
+
+/**
+ * Convert a timestamp's date and time to nanoseconds since 1970-01-01
+ * 00:00:00 in the timestamp's own timezone (the timezone itself is ignored).
+ *
+ * Returns 0, or ERROR_OUT_OF_RANGE if the fields are not a valid calendar
+ * time (leap seconds included), or don't fit in an int64_t.
+ */
+COMPACT_TIME_INTERNAL int ct_internal_timestamp_to_wall_ns(const ct_timestamp* timestamp, int64_t* wall_ns);
+
+/**
+ * Set a timestamp's date and time from nanoseconds since 1970-01-01 00:00:00,
+ * leaving its timezone untouched.
+ */
+COMPACT_TIME_INTERNAL void ct_internal_timestamp_from_wall_ns(int64_t wall_ns, ct_timestamp* timestamp);
+
+/**
+ * Get the length of the encoded timestamp at the start of src by walking its
+ * structure, without decoding any fields.
+ *
+ * Returns the record length, or FAILURE_AT_POS() if src is too short.
+ */
+COMPACT_TIME_INTERNAL int ct_internal_timestamp_record_length(const uint8_t* src, int src_length);
+
+/**
+ * Measure a timezone name held in a ct_timezone.as_string buffer (all of
+ * which may be read), and check that it is printable ASCII and no longer
+ * than MAX_TIMEZONE_LENGTH.
+ *
+ * Sets length to the name length, or the buffer size if the name is not
+ * terminated within the buffer.
+ *
+ * Returns 0, or ERROR_OUT_OF_RANGE if the name is invalid.
+ */
+COMPACT_TIME_INTERNAL int ct_internal_timezone_name_scan(const char* name, int* length);
+
+/**
+ * Check that an encoded timezone name is printable ASCII. The preceding_length
+ * bytes before name, and readable_length bytes (at least length) from name,
+ * may be read.
+ */
+COMPACT_TIME_INTERNAL bool ct_internal_timezone_name_is_printable(const uint8_t* name,
+                                                                  int length,
+                                                                  int preceding_length,
+                                                                  int readable_length);
+
+/**
+ * Decodes a string timezone for ct_internal_timezone_decode(). src starts at
+ * the length byte, and preceding_length bytes of the record come before it.
+ *
+ * Returns the number of timezone bytes read or an error code.
+ */
+typedef int (*ct_internal_string_timezone_decoder)(void* context,
+                                                   const uint8_t* src,
+                                                   int src_length,
+                                                   int preceding_length);
+
+/**
+ * Decode the timezone of a non-UTC record, which starts offset bytes into
+ * src. A lat-long timezone is stored in latitude and longitude; a string
+ * timezone is handed to decode_string.
+ *
+ * Returns the record length or an error code. Failure offsets are relative
+ * to the start of the record.
+ */
+static inline int ct_internal_timezone_decode(const uint8_t* src,
+                                              int src_length,
+                                              int offset,
+                                              int16_t* latitude,
+                                              int16_t* longitude,
+                                              ct_internal_string_timezone_decoder decode_string,
+                                              void* context)
+{
+    if(offset >= src_length)
+    {
+        return FAILURE_AT_POS(offset + 1);
+    }
+
+    int timezone_byte_count = 0;
+    if(src[offset] & MASK_LATLONG)
+    {
+        timezone_byte_count = ct_internal_latlong_decode(src + offset, src_length - offset, latitude, longitude);
+    }
+    else
+    {
+        timezone_byte_count = decode_string(context, src + offset, src_length - offset, offset);
+    }
+
+    if(timezone_byte_count == ERROR_OUT_OF_RANGE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(timezone_byte_count < 0)
+    {
+        return FAILURE_AT_POS(offset) + timezone_byte_count;
+    }
+    return offset + timezone_byte_count;
+}
+
+/**
+ * Check whether two timezones are the same zone.
+ */
+static inline bool ct_internal_timezones_are_equal(const ct_timezone* a, const ct_timezone* b)
+{
+    if(a->type != b->type)
+    {
+        return false;
+    }
+    switch(a->type)
+    {
+        case CT_TZ_STRING:
+            return strcmp(a->as_string, b->as_string) == 0;
+        case CT_TZ_LATLONG:
+            return a->latitude == b->latitude && a->longitude == b->longitude;
+        default:
+            return true;
+    }
+}
+
+#if COMPACT_TIME_STATISTICS
+/**
+ * Get the calling thread's counters, laid out as the fields of a
+ * ct_statistics. Only the calling thread may write to them.
+ *
+ * Returns NULL if no counters could be allocated.
+ */
+COMPACT_TIME_INTERNAL uint64_t* ct_internal_statistics_counters(void);
+#endif
+
+#endif // KS_compact_time_internal_H
@@ -27,68 +27,47 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
-// #define KSLog_FileDesriptor STDOUT_FILENO
-// #define KSLog_LocalMinLevel KSLOG_LEVEL_TRACE
-#include <kslog/kslog.h>
+#if COMPACT_TIME_LOGGING
+    // #define KSLog_FileDesriptor STDOUT_FILENO
+    // #define KSLog_LocalMinLevel KSLOG_LEVEL_TRACE
+    #include <kslog/kslog.h>
+#else
+    // Logging is compiled out entirely, arguments and all.
+    #define KSLOG_DEBUG(...)
+    #define KSLOG_TRACE(...)
+    #define KSLOG_DATA_DEBUG(...)
+#endif
 
 #include "compact_time/compact_time.h"
+#include "compact_time/statistics.h"
+#include "compact_time_internal.h"
 #include <endianness/endianness.h>
 
 #include <vlq/vlq.h>
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
 #define QUOTE(str) #str
 #define EXPAND_AND_QUOTE(str) QUOTE(str)
 
-static const int YEAR_BIAS = 2000;
-static const int BITS_PER_YEAR_GROUP = 7;
-
-#define FAILURE_AT_POS(A) -(A)
-
-#define SIZE_UTC       1
-#define SIZE_MAGNITUDE 2
-#define SIZE_SUBSECOND 10
-#define SIZE_SECOND    6
-#define SIZE_MINUTE    6
-#define SIZE_HOUR      5
-#define SIZE_DAY       5
-#define SIZE_MONTH     4
-
-#define SIZE_LATITUDE  15
-#define SIZE_LONGITUDE 16
-
-#define SIZE_DATE_YEAR_UPPER_BITS 7
-
-
-static const int BASE_SIZE_TIME = SIZE_UTC + SIZE_MAGNITUDE + SIZE_SECOND + SIZE_MINUTE + SIZE_HOUR;
-static const int BASE_SIZE_TIMESTAMP = SIZE_MAGNITUDE + SIZE_SECOND + SIZE_MINUTE + SIZE_HOUR + SIZE_DAY + SIZE_MONTH;
-
-static const int BYTE_COUNT_DATE = 2;
+#ifndef COMPACT_TIME_VERSION
+    #define COMPACT_TIME_VERSION EXPAND_AND_QUOTE(PROJECT_VERSION)
+#endif
 
-static const unsigned MASK_MAGNITUDE = ((1<<SIZE_MAGNITUDE)-1);
-static const unsigned MASK_SECOND    = ((1<<SIZE_SECOND)-1);
-static const unsigned MASK_MINUTE    = ((1<<SIZE_MINUTE)-1);
-static const unsigned MASK_HOUR      = ((1<<SIZE_HOUR)-1);
-static const unsigned MASK_DAY       = ((1<<SIZE_DAY)-1);
-static const unsigned MASK_MONTH     = ((1<<SIZE_MONTH)-1);
+// Divisibility by 1000 and 1000000 without division: d = odd * 2^k divides n
+// exactly when rotate_right(n * inverse(odd), k) <= UINT32_MAX / d, where
+// inverse(odd) is the multiplicative inverse of odd modulo 2^32.
+static const uint32_t INVERSE_125 = 0x26e978d5;
+static const uint32_t INVERSE_15625 = 0x68c26139;
+static const uint32_t MAX_MULTIPLE_OF_1000 = 0xffffffffu / 1000;
+static const uint32_t MAX_MULTIPLE_OF_1000000 = 0xffffffffu / 1000000;
 
-static const unsigned SHIFT_LENGTH = 1;
-
-static const unsigned MASK_LATLONG   = 1;
-static const unsigned SHIFT_LATITUDE = 1;
-static const unsigned SHIFT_LONITUDE = 16;
-static const unsigned MASK_LATITUDE  = ((1<<SIZE_LATITUDE)-1);
-static const unsigned MASK_LONGITUDE = ((1<<SIZE_LONGITUDE)-1);
-
-static const unsigned MASK_DATE_YEAR_UPPER_BITS = (1 << SIZE_DATE_YEAR_UPPER_BITS) - 1;
-
-static const uint8_t g_timestamp_year_upper_bits[] = { 4, 2, 0, 6 };
-static const unsigned g_subsec_multipliers[] = { 1, 1000000, 1000, 1 };
-
-static const int MAX_TIMEZONE_LENGTH = 63;
-static const int MIN_LATITUDE = -9000;
-static const int MAX_LATITUDE = 9000;
-static const int MIN_LONGITUDE = -18000;
-static const int MAX_LONGITUDE = 18000;
+static uint32_t rotate_right(const uint32_t value, const int bit_count)
+{
+    return (value >> bit_count) | (value << (32 - bit_count));
+}
 
 static int get_subsecond_magnitude(const uint32_t nanoseconds)
 {
@@ -96,36 +75,38 @@ static int get_subsecond_magnitude(const uint32_t nanoseconds)
     {
         return 0;
     }
-    if((nanoseconds % 1000) != 0)
+    if(rotate_right(nanoseconds * INVERSE_125, 3) > MAX_MULTIPLE_OF_1000)
     {
         return 3;
     }
-    if((nanoseconds % 1000000) != 0)
+    if(rotate_right(nanoseconds * INVERSE_15625, 6) > MAX_MULTIPLE_OF_1000000)
     {
         return 2;
     }
     return 1;
 }
 
+// Shifts and bias arithmetic are done unsigned so that out-of-range input
+// wraps instead of invoking undefined behavior.
 static unsigned zigzag_encode(const int32_t value)
 {
-    return (value >> 31) ^ (value << 1);
+    return (unsigned)(value >> 31) ^ ((unsigned)value << 1);
 }
 
 static int zigzag_decode(const uint32_t value)
 {
-    return (value >> 1) ^ -(value & 1);
+    return (int)((value >> 1) ^ -(value & 1));
 }
 
 static int sign_extend(int value, int original_bit_size)
 {
     const int shift_amount = sizeof(value)*8 - original_bit_size;
-    return (value << shift_amount) >> shift_amount;
+    return (int)((unsigned)value << shift_amount) >> shift_amount;
 }
 
 static unsigned encode_year(const int year)
 {
-    return zigzag_encode(year - YEAR_BIAS);
+    return zigzag_encode((int32_t)((uint32_t)year - YEAR_BIAS));
 }
 
 static unsigned encode_year_and_utc_flag(const int year, const int is_utc_timezone)
@@ -135,7 +116,7 @@ static unsigned encode_year_and_utc_flag(const int year, const int is_utc_timezo
 
 static int decode_year(const unsigned encoded_year)
 {
-    return zigzag_decode(encoded_year) + YEAR_BIAS;
+    return (int)((uint32_t)zigzag_decode(encoded_year) + YEAR_BIAS);
 }
 
 static int get_base_byte_count(int base_size, int magnitude)
@@ -146,20 +127,104 @@ static int get_base_byte_count(int base_size, int magnitude)
     return size / 8 + extra_byte;
 }
 
+// Number of significant bits in value (0 for 0).
+static int get_bit_width(const uint32_t value)
+{
+#if defined(__GNUC__)
+    return value == 0 ? 0 : 32 - __builtin_clz(value);
+#else
+    int width = 0;
+    for(uint32_t remaining = value; remaining != 0; remaining >>= 1)
+    {
+        width++;
+    }
+    return width;
+#endif
+}
+
+// RVLQ year groups (7 bits each) needed for a value of each bit width (0 to
+// 32), generated at compile time. A zero value still takes one group.
+#define YEAR_GROUPS_FOR_WIDTH(WIDTH) ((WIDTH) == 0 ? 1 : ((WIDTH) + 6) / 7)
+#define YEAR_GROUPS_FOR_WIDTHS_8(BASE) \
+    YEAR_GROUPS_FOR_WIDTH((BASE) + 0), YEAR_GROUPS_FOR_WIDTH((BASE) + 1), \
+    YEAR_GROUPS_FOR_WIDTH((BASE) + 2), YEAR_GROUPS_FOR_WIDTH((BASE) + 3), \
+    YEAR_GROUPS_FOR_WIDTH((BASE) + 4), YEAR_GROUPS_FOR_WIDTH((BASE) + 5), \
+    YEAR_GROUPS_FOR_WIDTH((BASE) + 6), YEAR_GROUPS_FOR_WIDTH((BASE) + 7)
+static const uint8_t g_year_group_counts[] =
+{
+    YEAR_GROUPS_FOR_WIDTHS_8(0),
+    YEAR_GROUPS_FOR_WIDTHS_8(8),
+    YEAR_GROUPS_FOR_WIDTHS_8(16),
+    YEAR_GROUPS_FOR_WIDTHS_8(24),
+    YEAR_GROUPS_FOR_WIDTH(32),
+};
+
 static int get_year_group_count(uint32_t encoded_year, int uncounted_bits)
 {
-    uint32_t year = encoded_year >> uncounted_bits;
-    if(year == 0)
+    return g_year_group_counts[get_bit_width(encoded_year >> uncounted_bits)];
+}
+
+// UTC whole-second timestamps with a year that fits in the magnitude 0 upper
+// year bits plus a single RVLQ group always have the same layout.
+static const int UTC_SECONDS_ACCUMULATOR_SIZE = 4;
+static const int UTC_SECONDS_BYTE_COUNT = 5;
+static const unsigned UTC_SECONDS_MASK_YEAR_GROUP = 0x7f;
+// 4 upper year bits for magnitude 0, plus one 7-bit year group
+static const unsigned UTC_SECONDS_MAX_ENCODED_YEAR = (1 << 11) - 1;
+
+static int latlong_pack(const int16_t latitude, const int16_t longitude, uint32_t* value)
+{
+    if(latitude < MIN_LATITUDE || latitude > MAX_LATITUDE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(longitude < MIN_LONGITUDE || longitude > MAX_LONGITUDE)
     {
-        return 1;
+        return ERROR_OUT_OF_RANGE;
     }
+    *value = MASK_LATLONG |
+             ((latitude & MASK_LATITUDE) << SHIFT_LATITUDE) |
+             ((longitude & MASK_LONGITUDE) << SHIFT_LONITUDE);
+    KSLOG_TRACE("Encoded as int: %x", *value);
+    return 0;
+}
 
-    int size = 0;
-    while(year != 0)
+static int latlong_encode(const int16_t latitude, const int16_t longitude, uint8_t* dst, int dst_length)
+{
+    uint32_t value = 0;
+    if(latlong_pack(latitude, longitude, &value) < 0)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    int length = sizeof(value);
+    if(length > dst_length)
     {
-        size++;
-        year >>= BITS_PER_YEAR_GROUP;
+        return FAILURE_AT_POS(length);
     }
+    write_uint32_le(value, dst);
+    return length;
+}
+
+static int latlong_decode(const uint8_t* src, int src_length, int16_t* latitude, int16_t* longitude)
+{
+    int size = sizeof(uint32_t);
+    if(size > src_length)
+    {
+        return FAILURE_AT_POS(size);
+    }
+    uint32_t latlong = read_uint32_le(src);
+    KSLOG_TRACE("TS Lat/long from %x", latlong);
+    *latitude = sign_extend((latlong >> SHIFT_LATITUDE) & MASK_LATITUDE, SIZE_LATITUDE);
+    *longitude = sign_extend((latlong >> SHIFT_LONITUDE) & MASK_LONGITUDE, SIZE_LONGITUDE);
+    if(*latitude < MIN_LATITUDE || *latitude > MAX_LATITUDE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(*longitude < MIN_LONGITUDE || *longitude > MAX_LONGITUDE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    KSLOG_TRACE("Decoded to %d/%d", *latitude, *longitude);
     return size;
 }
 
@@ -168,14 +233,22 @@ static int timezone_encoded_size(const ct_timezone* timezone)
     switch(timezone->type)
     {
         case CT_TZ_STRING:
-            return strlen(timezone->as_string) + 1;
+        {
+            // Other invalid names fail to encode, so only their length matters here.
+            int string_length = 0;
+            ct_internal_timezone_name_scan(timezone->as_string, &string_length);
+            if(string_length >= (int)sizeof(timezone->as_string))
+            {
+                return ERROR_OUT_OF_RANGE;
+            }
+            return string_length + 1;
+        }
         case CT_TZ_LATLONG:
             return 4;
         case CT_TZ_ZERO:
             return 0;
         default:
-            // TODO: Maybe panic?
-            return 0;
+            return ERROR_OUT_OF_RANGE;
     }
 }
 
@@ -189,12 +262,12 @@ static int timezone_encode(const ct_timezone* timezone, uint8_t* dst, int dst_le
             return 0;
         case CT_TZ_STRING:
         {
-            KSLOG_TRACE("TS String %s", timezone->as_string);
-            const int string_length = strlen(timezone->as_string);
-            if(string_length > MAX_TIMEZONE_LENGTH)
+            int string_length = 0;
+            if(ct_internal_timezone_name_scan(timezone->as_string, &string_length) < 0)
             {
                 return ERROR_OUT_OF_RANGE;
             }
+            KSLOG_TRACE("TS String %s", timezone->as_string);
             if(string_length + 1 > dst_length)
             {
                 return FAILURE_AT_POS(string_length + 1);
@@ -204,34 +277,53 @@ static int timezone_encode(const ct_timezone* timezone, uint8_t* dst, int dst_le
             return string_length + 1;
         }
         case CT_TZ_LATLONG:
-        {
             KSLOG_TRACE("TS Lat/long %d/%d", timezone->latitude, timezone->longitude);
-            if(timezone->latitude < MIN_LATITUDE || timezone->latitude > MAX_LATITUDE)
+            return latlong_encode(timezone->latitude, timezone->longitude, dst, dst_length);
+        default:
+            return ERROR_OUT_OF_RANGE;
+    }
+}
+
+// Same as timezone_encode(), but dst is known to have room.
+static int timezone_encode_unchecked(const ct_timezone* timezone, uint8_t* dst)
+{
+    switch(timezone->type)
+    {
+        case CT_TZ_ZERO:
+            return 0;
+        case CT_TZ_STRING:
+        {
+            int string_length = 0;
+            if(ct_internal_timezone_name_scan(timezone->as_string, &string_length) < 0)
             {
                 return ERROR_OUT_OF_RANGE;
             }
-            if(timezone->longitude < MIN_LONGITUDE || timezone->longitude > MAX_LONGITUDE)
+            dst[0] = string_length << SHIFT_LENGTH;
+            memcpy(dst+1, timezone->as_string, string_length);
+            return string_length + 1;
+        }
+        case CT_TZ_LATLONG:
+        {
+            uint32_t value = 0;
+            if(latlong_pack(timezone->latitude, timezone->longitude, &value) < 0)
             {
                 return ERROR_OUT_OF_RANGE;
             }
-            uint32_t value = MASK_LATLONG |
-                             ((timezone->latitude & MASK_LATITUDE) << SHIFT_LATITUDE) |
-                             ((timezone->longitude & MASK_LONGITUDE) << SHIFT_LONITUDE);
-            KSLOG_TRACE("Encoded as int: %x", value);
-            int length = sizeof(value);
-            if(length > dst_length)
-            {
-                return FAILURE_AT_POS(length);
-            }
             write_uint32_le(value, dst);
-            return length;
+            return sizeof(value);
         }
         default:
-            return 0;
+            return ERROR_OUT_OF_RANGE;
     }
 }
 
-static int timezone_decode(ct_timezone* timezone, const uint8_t* src, int src_length, bool timezone_is_utc)
+// preceding_length is the number of bytes of the record ahead of src, which
+// may also be read while checking the name.
+static int timezone_decode(ct_timezone* timezone,
+                           const uint8_t* src,
+                           int src_length,
+                           int preceding_length,
+                           bool timezone_is_utc)
 {
     KSLOG_DATA_DEBUG(src, src_length, "timezone_decode(timezone_is_utc = %d)", timezone_is_utc);
     if(timezone_is_utc)
@@ -249,26 +341,8 @@ static int timezone_decode(ct_timezone* timezone, const uint8_t* src, int src_le
     bool is_latlong = src[0] & MASK_LATLONG;
     if(is_latlong)
     {
-        int size = sizeof(uint32_t);
-        if(size > src_length)
-        {
-            return FAILURE_AT_POS(size);
-        }
         timezone->type = CT_TZ_LATLONG;
-        uint32_t latlong = read_uint32_le(src);
-        KSLOG_TRACE("TS Lat/long from %x", latlong);
-        timezone->latitude = sign_extend((latlong >> SHIFT_LATITUDE) & MASK_LATITUDE, SIZE_LATITUDE);
-        timezone->longitude = sign_extend((latlong >> SHIFT_LONITUDE) & MASK_LONGITUDE, SIZE_LONGITUDE);
-        if(timezone->latitude < MIN_LATITUDE || timezone->latitude > MAX_LATITUDE)
-        {
-            return ERROR_OUT_OF_RANGE;
-        }
-        if(timezone->longitude < MIN_LONGITUDE || timezone->longitude > MAX_LONGITUDE)
-        {
-            return ERROR_OUT_OF_RANGE;
-        }
-        KSLOG_TRACE("Decoded to %d/%d", timezone->latitude, timezone->longitude);
-        return size;
+        return latlong_decode(src, src_length, &timezone->latitude, &timezone->longitude);
     }
 
     const int length = src[0] >> SHIFT_LENGTH;
@@ -277,6 +351,11 @@ static int timezone_decode(ct_timezone* timezone, const uint8_t* src, int src_le
     {
         return FAILURE_AT_POS(offset + length);
     }
+    if(length >= (int)sizeof(timezone->as_string) ||
+       !ct_internal_timezone_name_is_printable(src + offset, length, preceding_length + offset, src_length - offset))
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
     timezone->type = CT_TZ_STRING;
     memcpy(timezone->as_string, src+offset, length);
     timezone->as_string[length] = 0;
@@ -285,6 +364,560 @@ static int timezone_decode(ct_timezone* timezone, const uint8_t* src, int src_le
     return offset;
 }
 
+static int timezone_decode_view(ct_timezone_view* timezone,
+                                const uint8_t* src,
+                                int src_length,
+                                int preceding_length,
+                                bool timezone_is_utc)
+{
+    if(timezone_is_utc)
+    {
+        timezone->type = CT_TZ_ZERO;
+        return 0;
+    }
+
+    if(src_length < 1)
+    {
+        return FAILURE_AT_POS(1);
+    }
+
+    if(src[0] & MASK_LATLONG)
+    {
+        timezone->type = CT_TZ_LATLONG;
+        return latlong_decode(src, src_length, &timezone->latitude, &timezone->longitude);
+    }
+
+    const int length = src[0] >> SHIFT_LENGTH;
+    const int offset = 1;
+    if(offset + length > src_length)
+    {
+        return FAILURE_AT_POS(offset + length);
+    }
+    // The length byte has room for longer names than the encoder writes.
+    if(length > MAX_TIMEZONE_LENGTH ||
+       !ct_internal_timezone_name_is_printable(src + offset, length, preceding_length + offset, src_length - offset))
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    timezone->type = CT_TZ_STRING;
+    timezone->name = (const char*)src + offset;
+    timezone->name_length = length;
+    return offset + length;
+}
+
+// Write the low year_group_count groups of value as RVLQ, without checking
+// for room in dst.
+//
+// The decoders take the groups as they come, so leading zero groups must be
+// written out rather than dropped the way a minimal RVLQ encoding would.
+static int rvlq_encode_32_unchecked(const uint32_t value, const int year_group_count, uint8_t* dst)
+{
+    uint32_t remaining = value;
+    for(int i = year_group_count - 1; i >= 0; i--)
+    {
+        dst[i] = (remaining & 0x7f) | RVLQ_CONTINUATION_BIT;
+        remaining >>= BITS_PER_YEAR_GROUP;
+    }
+    dst[year_group_count - 1] &= ~RVLQ_CONTINUATION_BIT;
+    return year_group_count;
+}
+
+// Build the base accumulator of a timestamp. The low year_group_count * 7
+// bits of encoded_year are left for the RVLQ year groups.
+static uint64_t timestamp_base_accumulator(const ct_date* date,
+                                          const uint8_t hour,
+                                          const uint8_t minute,
+                                          const uint8_t second,
+                                          const uint32_t nanosecond,
+                                          const int magnitude,
+                                          const unsigned encoded_year,
+                                          const int year_group_count)
+{
+    const uint64_t subsecond = nanosecond / g_subsec_multipliers[magnitude];
+
+    uint64_t accumulator = (uint64_t)encoded_year >> (year_group_count * BITS_PER_YEAR_GROUP);
+    accumulator = (accumulator << (SIZE_SUBSECOND * magnitude)) + subsecond;
+    accumulator = (accumulator << SIZE_MONTH) + date->month;
+    accumulator = (accumulator << SIZE_DAY) + date->day;
+    accumulator = (accumulator << SIZE_HOUR) + hour;
+    accumulator = (accumulator << SIZE_MINUTE) + minute;
+    accumulator = (accumulator << SIZE_SECOND) + second;
+    accumulator = (accumulator << SIZE_MAGNITUDE) + magnitude;
+    return accumulator;
+}
+
+static int timestamp_base_encode(const ct_date* date,
+                                 const uint8_t hour,
+                                 const uint8_t minute,
+                                 const uint8_t second,
+                                 const uint32_t nanosecond,
+                                 const int magnitude,
+                                 const bool timezone_is_utc,
+                                 uint8_t* dst,
+                                 int dst_length)
+{
+    const unsigned encoded_year = encode_year_and_utc_flag(date->year, timezone_is_utc);
+    const int year_group_count = get_year_group_count(encoded_year, g_timestamp_year_upper_bits[magnitude]);
+    const uint64_t accumulator = timestamp_base_accumulator(date, hour, minute, second, nanosecond,
+                                                            magnitude, encoded_year, year_group_count);
+
+    int offset = 0;
+    const int accumulator_size = g_timestamp_base_byte_counts[magnitude];
+    if(accumulator_size > dst_length)
+    {
+        return FAILURE_AT_POS(accumulator_size);
+    }
+    copy_le(&accumulator, dst + offset, accumulator_size);
+    offset += accumulator_size;
+
+    if(year_group_count > dst_length - offset)
+    {
+        return FAILURE_AT_POS(offset + year_group_count);
+    }
+    offset += rvlq_encode_32_unchecked(encoded_year, year_group_count, dst + offset);
+
+    return offset;
+}
+
+static int timestamp_encode(const ct_timestamp* timestamp, const int magnitude, uint8_t* dst, int dst_length)
+{
+    const bool timezone_is_utc = timestamp->time.timezone.type == CT_TZ_ZERO;
+    int offset = timestamp_base_encode(&timestamp->date,
+                                       timestamp->time.hour,
+                                       timestamp->time.minute,
+                                       timestamp->time.second,
+                                       timestamp->time.nanosecond,
+                                       magnitude,
+                                       timezone_is_utc,
+                                       dst,
+                                       dst_length);
+    if(offset <= 0 || timezone_is_utc)
+    {
+        return offset;
+    }
+
+    const int timezone_byte_count = timezone_encode(&timestamp->time.timezone, dst+offset, dst_length-offset);
+    if(timezone_byte_count == ERROR_OUT_OF_RANGE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(timezone_byte_count < 0)
+    {
+        return FAILURE_AT_POS(offset) + timezone_byte_count;
+    }
+    offset += timezone_byte_count;
+
+    return offset;
+}
+
+// Build the date accumulator. The low year_group_count * 7 bits of
+// encoded_year are left for the RVLQ year groups.
+static uint16_t date_accumulator(const ct_date* date, const unsigned encoded_year, const int year_group_count)
+{
+    uint16_t accumulator = (uint64_t)encoded_year >> (year_group_count * BITS_PER_YEAR_GROUP);
+    accumulator = (accumulator << SIZE_MONTH) | date->month;
+    accumulator = (accumulator << SIZE_DAY) | date->day;
+    return accumulator;
+}
+
+static uint64_t time_accumulator(const ct_time* time, const int magnitude)
+{
+    const uint64_t subsecond = time->nanosecond / g_subsec_multipliers[magnitude];
+
+    uint64_t accumulator = subsecond;
+    accumulator = (accumulator << SIZE_SECOND) + time->second;
+    accumulator = (accumulator << SIZE_MINUTE) + time->minute;
+    accumulator = (accumulator << SIZE_HOUR) + time->hour;
+    accumulator = (accumulator << SIZE_MAGNITUDE) + magnitude;
+    accumulator = (accumulator << 1) + (time->timezone.type == CT_TZ_ZERO ? 1 : 0);
+    return accumulator;
+}
+
+static int timestamp_base_decode(const uint8_t* src,
+                                 int src_length,
+                                 ct_date* date,
+                                 uint8_t* hour,
+                                 uint8_t* minute,
+                                 uint8_t* second,
+                                 uint32_t* nanosecond,
+                                 bool* timezone_is_utc)
+{
+    if(src_length < 1)
+    {
+        KSLOG_DEBUG("Failed because not even 1 byte available");
+        return FAILURE_AT_POS(1);
+    }
+
+    const int magnitude = src[0] & MASK_MAGNITUDE;
+    const int subsecond_multiplier = g_subsec_multipliers[magnitude];
+    const int size_subsecond = SIZE_SUBSECOND * magnitude;
+    const unsigned mask_subsecond = (1 << size_subsecond) - 1;
+
+    int offset = g_timestamp_base_byte_counts[magnitude];
+    if(offset >= src_length)
+    {
+        KSLOG_DEBUG("Failed decoding base struct");
+        return FAILURE_AT_POS(offset);
+    }
+
+    uint64_t accumulator = 0;
+    copy_le(src, &accumulator, offset);
+
+    accumulator >>= SIZE_MAGNITUDE;
+    *second = accumulator & MASK_SECOND;
+    accumulator >>= SIZE_SECOND;
+    *minute = accumulator & MASK_MINUTE;
+    accumulator >>= SIZE_MINUTE;
+    *hour = accumulator & MASK_HOUR;
+    accumulator >>= SIZE_HOUR;
+    date->day = accumulator & MASK_DAY;
+    accumulator >>= SIZE_DAY;
+    date->month = accumulator & MASK_MONTH;
+    accumulator >>= SIZE_MONTH;
+    *nanosecond = (accumulator & mask_subsecond) * subsecond_multiplier;
+    accumulator >>= size_subsecond;
+    uint32_t year_encoded = (uint32_t)accumulator;
+
+    const int decoded_group_count = rvlq_decode_32(&year_encoded, src + offset, src_length - offset);
+    if(decoded_group_count < 1)
+    {
+        KSLOG_DEBUG("Failed decoding RVLQ");
+        return FAILURE_AT_POS(offset) + decoded_group_count;
+    }
+    offset += decoded_group_count;
+
+    *timezone_is_utc = year_encoded & 1;
+    year_encoded >>= 1;
+    date->year = decode_year(year_encoded);
+
+    return offset;
+}
+
+static int timestamp_decode(const uint8_t* src, int src_length, ct_timestamp* timestamp)
+{
+    KSLOG_DATA_DEBUG(src, src_length, "ct_timestamp_decode()");
+    bool timezone_is_utc = false;
+    int offset = timestamp_base_decode(src,
+                                       src_length,
+                                       &timestamp->date,
+                                       &timestamp->time.hour,
+                                       &timestamp->time.minute,
+                                       &timestamp->time.second,
+                                       &timestamp->time.nanosecond,
+                                       &timezone_is_utc);
+    if(offset < 0)
+    {
+        return offset;
+    }
+
+    int timezone_byte_count = timezone_decode(&timestamp->time.timezone, src + offset, src_length - offset, offset, timezone_is_utc);
+    if(timezone_byte_count == ERROR_OUT_OF_RANGE)
+    {
+        KSLOG_DEBUG("Timezone out of range");
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(timezone_byte_count < 0)
+    {
+        KSLOG_DEBUG("Failed decoding timezone");
+        return FAILURE_AT_POS(offset) + timezone_byte_count;
+    }
+    offset += timezone_byte_count;
+
+    KSLOG_TRACE("TS = %d.%02d.%02d-%d:%02d:%02d.%09d, [%s], [%d/%d]",
+        timestamp->date.year, timestamp->date.month, timestamp->date.day,
+        timestamp->time.hour, timestamp->time.minute, timestamp->time.second, timestamp->time.nanosecond,
+        timestamp->time.timezone.as_string, timestamp->time.timezone.latitude, timestamp->time.timezone.longitude);
+
+    return offset;
+}
+
+#if COMPACT_TIME_STATISTICS
+// Counters are only written by their own thread, so a relaxed load and store
+// is enough (and compiles to a plain add).
+static void count_statistic(uint64_t* counters, const size_t index, const uint64_t amount)
+{
+    __atomic_store_n(&counters[index], __atomic_load_n(&counters[index], __ATOMIC_RELAXED) + amount, __ATOMIC_RELAXED);
+}
+
+#define CODEC_STATISTIC(FIELD) (offsetof(ct_codec_statistics, FIELD) / sizeof(uint64_t))
+
+static const int MAX_COUNTED_YEAR_GROUPS = 5;
+
+static void count_timestamp(const size_t codec_offset,
+                            const ct_timestamp* timestamp,
+                            const int magnitude,
+                            const int result)
+{
+    uint64_t* counters = ct_internal_statistics_counters();
+    if(counters == NULL)
+    {
+        return;
+    }
+    counters += codec_offset / sizeof(uint64_t);
+    if(result == ERROR_OUT_OF_RANGE)
+    {
+        count_statistic(counters, CODEC_STATISTIC(out_of_range), 1);
+        return;
+    }
+    if(result < 0)
+    {
+        count_statistic(counters, CODEC_STATISTIC(failures_at_pos), 1);
+        return;
+    }
+
+    const ct_timezone* timezone = &timestamp->time.timezone;
+    const int timezone_byte_count = timezone_encoded_size(timezone);
+    // The decoder accepts padded year groups, which are counted as the max.
+    int year_group_count = result - g_timestamp_base_byte_counts[magnitude] - timezone_byte_count;
+    if(year_group_count > MAX_COUNTED_YEAR_GROUPS)
+    {
+        year_group_count = MAX_COUNTED_YEAR_GROUPS;
+    }
+
+    count_statistic(counters, CODEC_STATISTIC(records), 1);
+    count_statistic(counters, CODEC_STATISTIC(bytes), result);
+    count_statistic(counters, CODEC_STATISTIC(magnitudes) + magnitude, 1);
+    // The encoders reject unknown types, but never index past the counters.
+    if((unsigned)timezone->type <= CT_TZ_LATLONG)
+    {
+        count_statistic(counters, CODEC_STATISTIC(timezone_types) + timezone->type, 1);
+    }
+    count_statistic(counters, CODEC_STATISTIC(year_group_counts) + year_group_count, 1);
+}
+
+    #define COUNT_TIMESTAMP_ENCODE(TIMESTAMP, MAGNITUDE, RESULT) \
+        count_timestamp(offsetof(ct_statistics, encode), TIMESTAMP, MAGNITUDE, RESULT)
+    // The magnitude is in the low bits of the first byte.
+    #define COUNT_TIMESTAMP_DECODE(SRC, SRC_LENGTH, TIMESTAMP, RESULT) \
+        count_timestamp(offsetof(ct_statistics, decode), TIMESTAMP, (SRC_LENGTH) > 0 ? (SRC)[0] & MASK_MAGNITUDE : 0, RESULT)
+#else
+    // Statistics are compiled out entirely, arguments and all.
+    #define COUNT_TIMESTAMP_ENCODE(...)
+    #define COUNT_TIMESTAMP_DECODE(...)
+#endif
+
+
+// Civil date <-> day count conversion, based on Howard Hinnant's
+// days_from_civil / civil_from_days (proleptic Gregorian, March-based years).
+static const int64_t DAYS_FROM_YEAR_0_MARCH_TO_EPOCH = 719468;
+static const int64_t DAYS_PER_ERA = 146097;
+static const int64_t SECONDS_PER_DAY = 86400;
+static const int64_t NANOSECONDS_PER_SECOND = 1000000000;
+static const uint8_t g_days_per_month[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+static int64_t days_from_civil(int64_t year, const unsigned month, const unsigned day)
+{
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned year_of_era = (unsigned)(year - era * 400);
+    const unsigned day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * DAYS_PER_ERA + (int64_t)day_of_era - DAYS_FROM_YEAR_0_MARCH_TO_EPOCH;
+}
+
+static void civil_from_days(int64_t days, ct_date* date)
+{
+    days += DAYS_FROM_YEAR_0_MARCH_TO_EPOCH;
+    const int64_t era = (days >= 0 ? days : days - (DAYS_PER_ERA - 1)) / DAYS_PER_ERA;
+    const unsigned day_of_era = (unsigned)(days - era * DAYS_PER_ERA);
+    const unsigned year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    const unsigned day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const unsigned month_from_march = (5 * day_of_year + 2) / 153;
+    const unsigned month = month_from_march < 10 ? month_from_march + 3 : month_from_march - 9;
+    const int64_t year = (int64_t)year_of_era + era * 400 + (month <= 2);
+
+    date->day = day_of_year - (153 * month_from_march + 2) / 5 + 1;
+    date->month = month;
+    // Compact time has no year 0: astronomical year 0 is 1 BC (-1).
+    date->year = (int32_t)(year <= 0 ? year - 1 : year);
+}
+
+static void unix_ns_to_fields(const int64_t unix_ns,
+                              ct_date* date,
+                              uint8_t* hour,
+                              uint8_t* minute,
+                              uint8_t* second,
+                              uint32_t* nanosecond)
+{
+    int64_t seconds = unix_ns / NANOSECONDS_PER_SECOND;
+    int64_t subsecond = unix_ns % NANOSECONDS_PER_SECOND;
+    if(subsecond < 0)
+    {
+        subsecond += NANOSECONDS_PER_SECOND;
+        seconds--;
+    }
+    int64_t days = seconds / SECONDS_PER_DAY;
+    int64_t second_of_day = seconds % SECONDS_PER_DAY;
+    if(second_of_day < 0)
+    {
+        second_of_day += SECONDS_PER_DAY;
+        days--;
+    }
+
+    civil_from_days(days, date);
+    *hour = second_of_day / 3600;
+    *minute = (second_of_day / 60) % 60;
+    *second = second_of_day % 60;
+    *nanosecond = (uint32_t)subsecond;
+}
+
+static int fields_to_unix_ns(const ct_date* date,
+                             const uint8_t hour,
+                             const uint8_t minute,
+                             const uint8_t second,
+                             const uint32_t nanosecond,
+                             int64_t* unix_ns)
+{
+    const int64_t year = date->year < 0 ? (int64_t)date->year + 1 : date->year;
+    if(date->year == 0 || date->month < 1 || date->month > 12 ||
+       date->day < 1 || date->day > ct_internal_get_days_in_month(year, date->month) ||
+       hour > 23 || minute > 59 || second > 60 || nanosecond >= NANOSECONDS_PER_SECOND)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+
+    int64_t whole = days_from_civil(year, date->month, date->day) * SECONDS_PER_DAY +
+                    hour * 3600 + minute * 60 + second;
+    int64_t fraction = nanosecond;
+
+    // Keep both parts the same sign so the range checks can't overflow.
+    if(whole < 0 && fraction > 0)
+    {
+        whole++;
+        fraction -= NANOSECONDS_PER_SECOND;
+    }
+    if(whole > INT64_MAX / NANOSECONDS_PER_SECOND || whole < INT64_MIN / NANOSECONDS_PER_SECOND)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    const int64_t whole_ns = whole * NANOSECONDS_PER_SECOND;
+    if((fraction > 0 && whole_ns > INT64_MAX - fraction) || (fraction < 0 && whole_ns < INT64_MIN - fraction))
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+
+    *unix_ns = whole_ns + fraction;
+    return 0;
+}
+
+
+
+// ------------
+// Internal API
+// ------------
+
+COMPACT_TIME_INTERNAL int ct_internal_timestamp_base_encode(const ct_date* date,
+                                                           uint8_t hour,
+                                                           uint8_t minute,
+                                                           uint8_t second,
+                                                           uint32_t nanosecond,
+                                                           bool timezone_is_utc,
+                                                           uint8_t* dst,
+                                                           int dst_length)
+{
+    const int magnitude = get_subsecond_magnitude(nanosecond);
+    return timestamp_base_encode(date, hour, minute, second, nanosecond, magnitude, timezone_is_utc, dst, dst_length);
+}
+
+COMPACT_TIME_INTERNAL int ct_internal_timestamp_base_decode(const uint8_t* src,
+                                                           int src_length,
+                                                           ct_date* date,
+                                                           uint8_t* hour,
+                                                           uint8_t* minute,
+                                                           uint8_t* second,
+                                                           uint32_t* nanosecond,
+                                                           bool* timezone_is_utc)
+{
+    return timestamp_base_decode(src, src_length, date, hour, minute, second, nanosecond, timezone_is_utc);
+}
+
+COMPACT_TIME_INTERNAL int ct_internal_latlong_encode(int16_t latitude, int16_t longitude, uint8_t* dst, int dst_length)
+{
+    return latlong_encode(latitude, longitude, dst, dst_length);
+}
+
+COMPACT_TIME_INTERNAL int ct_internal_latlong_decode(const uint8_t* src, int src_length, int16_t* latitude, int16_t* longitude)
+{
+    return latlong_decode(src, src_length, latitude, longitude);
+}
+
+COMPACT_TIME_INTERNAL int ct_internal_timestamp_record_length(const uint8_t* src, int src_length)
+{
+    if(src_length < 1)
+    {
+        return FAILURE_AT_POS(1);
+    }
+
+    int offset = g_timestamp_base_byte_counts[src[0] & MASK_MAGNITUDE];
+    while(offset < src_length && (src[offset] & RVLQ_CONTINUATION_BIT))
+    {
+        offset++;
+    }
+    if(offset >= src_length)
+    {
+        return FAILURE_AT_POS(offset + 1);
+    }
+    const bool timezone_is_utc = src[offset] & 1;
+    offset++;
+    if(timezone_is_utc)
+    {
+        return offset;
+    }
+
+    if(offset >= src_length)
+    {
+        return FAILURE_AT_POS(offset + 1);
+    }
+    if(src[offset] & MASK_LATLONG)
+    {
+        offset += sizeof(uint32_t);
+    }
+    else
+    {
+        offset += 1 + (src[offset] >> SHIFT_LENGTH);
+    }
+    if(offset > src_length)
+    {
+        return FAILURE_AT_POS(offset);
+    }
+    return offset;
+}
+
+COMPACT_TIME_INTERNAL int ct_internal_get_days_in_month(int64_t year, int month)
+{
+    const bool is_leap_year = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return month == 2 && is_leap_year ? 29 : g_days_per_month[month - 1];
+}
+
+COMPACT_TIME_INTERNAL int ct_internal_timestamp_to_wall_ns(const ct_timestamp* timestamp, int64_t* wall_ns)
+{
+    // A leap second would only convert by rolling over into the next minute.
+    int64_t result = 0;
+    if(timestamp->time.second > 59 ||
+       fields_to_unix_ns(&timestamp->date,
+                         timestamp->time.hour,
+                         timestamp->time.minute,
+                         timestamp->time.second,
+                         timestamp->time.nanosecond,
+                         &result) < 0)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+
+    *wall_ns = result;
+    return 0;
+}
+
+COMPACT_TIME_INTERNAL void ct_internal_timestamp_from_wall_ns(int64_t wall_ns, ct_timestamp* timestamp)
+{
+    unix_ns_to_fields(wall_ns,
+                      &timestamp->date,
+                      &timestamp->time.hour,
+                      &timestamp->time.minute,
+                      &timestamp->time.second,
+                      &timestamp->time.nanosecond);
+}
+
 
 
 // ----------
@@ -293,7 +926,7 @@ static int timezone_decode(ct_timezone* timezone, const uint8_t* src, int src_le
 
 const char* ct_version()
 {
-    return EXPAND_AND_QUOTE(PROJECT_VERSION);
+    return COMPACT_TIME_VERSION;
 }
 
 int ct_date_encoded_size(const ct_date* date)
@@ -307,29 +940,69 @@ int ct_time_encoded_size(const ct_time* time)
     const int magnitude = get_subsecond_magnitude(time->nanosecond);
     const int base_byte_count = get_base_byte_count(BASE_SIZE_TIME, magnitude);
 
-    return base_byte_count + timezone_encoded_size(&time->timezone);
+    const int timezone_byte_count = timezone_encoded_size(&time->timezone);
+    if(timezone_byte_count < 0)
+    {
+        return timezone_byte_count;
+    }
+    return base_byte_count + timezone_byte_count;
 }
 
 int ct_timestamp_encoded_size(const ct_timestamp* timestamp)
 {
+    const int timezone_byte_count = timezone_encoded_size(&timestamp->time.timezone);
+    if(timezone_byte_count < 0)
+    {
+        return timezone_byte_count;
+    }
     const int magnitude = get_subsecond_magnitude(timestamp->time.nanosecond);
-    const int base_byte_count = get_base_byte_count(BASE_SIZE_TIMESTAMP, magnitude);
+    const int base_byte_count = g_timestamp_base_byte_counts[magnitude];
     const unsigned encoded_year = encode_year(timestamp->date.year);
     const int year_group_count = get_year_group_count(encoded_year<<1, g_timestamp_year_upper_bits[magnitude]);
 
-    return base_byte_count + year_group_count + timezone_encoded_size(&timestamp->time.timezone);
+    return base_byte_count + year_group_count + timezone_byte_count;
+}
+
+int64_t ct_timestamps_encoded_size_total(const ct_timestamp* timestamps, int timestamp_count)
+{
+    int64_t total = 0;
+
+    // As in ct_timestamp_encode_batch(), only reclassify the subsecond
+    // magnitude when the nanosecond field changes.
+    uint32_t previous_nanosecond = 0;
+    int magnitude = 0;
+    int base_byte_count = g_timestamp_base_byte_counts[0];
+
+    for(int index = 0; index < timestamp_count; index++)
+    {
+        const ct_timestamp* timestamp = &timestamps[index];
+        if(timestamp->time.nanosecond != previous_nanosecond)
+        {
+            previous_nanosecond = timestamp->time.nanosecond;
+            magnitude = get_subsecond_magnitude(previous_nanosecond);
+            base_byte_count = g_timestamp_base_byte_counts[magnitude];
+        }
+        const unsigned encoded_year = encode_year(timestamp->date.year);
+        total += base_byte_count +
+                 get_year_group_count(encoded_year<<1, g_timestamp_year_upper_bits[magnitude]);
+        if(timestamp->time.timezone.type != CT_TZ_ZERO)
+        {
+            const int timezone_byte_count = timezone_encoded_size(&timestamp->time.timezone);
+            if(timezone_byte_count < 0)
+            {
+                return timezone_byte_count;
+            }
+            total += timezone_byte_count;
+        }
+    }
+    return total;
 }
 
 int ct_date_encode(const ct_date* date, uint8_t* dst, int dst_length)
 {
     const unsigned encoded_year = encode_year(date->year);
     const int year_group_count = get_year_group_count(encoded_year, SIZE_DATE_YEAR_UPPER_BITS);
-    const int year_group_bit_count = year_group_count * BITS_PER_YEAR_GROUP;
-    const unsigned year_grouped_mask = (1<<year_group_bit_count) - 1;
-
-    uint16_t accumulator = encoded_year >> year_group_bit_count;
-    accumulator = (accumulator << SIZE_MONTH) | date->month;
-    accumulator = (accumulator << SIZE_DAY) | date->day;
+    const uint16_t accumulator = date_accumulator(date, encoded_year, year_group_count);
 
     int offset = 0;
     const int accumulator_size = BYTE_COUNT_DATE;
@@ -339,12 +1012,11 @@ int ct_date_encode(const ct_date* date, uint8_t* dst, int dst_length)
     }
     write_uint16_le(accumulator, dst + offset);
     offset += accumulator_size;
-    const int rvlq_byte_count = rvlq_encode_32(encoded_year & year_grouped_mask, dst+offset, dst_length - offset);
-    if(rvlq_byte_count <= 0)
+    if(year_group_count > dst_length - offset)
     {
-        return FAILURE_AT_POS(offset) + rvlq_byte_count;
+        return FAILURE_AT_POS(offset + year_group_count);
     }
-    offset += rvlq_byte_count;
+    offset += rvlq_encode_32_unchecked(encoded_year, year_group_count, dst + offset);
 
     return offset;
 }
@@ -352,14 +1024,7 @@ int ct_date_encode(const ct_date* date, uint8_t* dst, int dst_length)
 int ct_time_encode(const ct_time* time, uint8_t* dst, int dst_length)
 {
     const int magnitude = get_subsecond_magnitude(time->nanosecond);
-    const uint64_t subsecond = time->nanosecond / g_subsec_multipliers[magnitude];
-
-    uint64_t accumulator = subsecond;
-    accumulator = (accumulator << SIZE_SECOND) + time->second;
-    accumulator = (accumulator << SIZE_MINUTE) + time->minute;
-    accumulator = (accumulator << SIZE_HOUR) + time->hour;
-    accumulator = (accumulator << SIZE_MAGNITUDE) + magnitude;
-    accumulator = (accumulator << 1) + (time->timezone.type == CT_TZ_ZERO ? 1 : 0);
+    const uint64_t accumulator = time_accumulator(time, magnitude);
 
     int offset = 0;
     const int accumulator_size = get_base_byte_count(BASE_SIZE_TIME, magnitude);
@@ -371,6 +1036,10 @@ int ct_time_encode(const ct_time* time, uint8_t* dst, int dst_length)
     offset += accumulator_size;
 
     const int timezone_byte_count = timezone_encode(&time->timezone, dst+offset, dst_length-offset);
+    if(timezone_byte_count == ERROR_OUT_OF_RANGE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
     if(timezone_byte_count < 0)
     {
         return FAILURE_AT_POS(offset) + timezone_byte_count;
@@ -383,45 +1052,86 @@ int ct_time_encode(const ct_time* time, uint8_t* dst, int dst_length)
 int ct_timestamp_encode(const ct_timestamp* timestamp, uint8_t* dst, int dst_length)
 {
     const int magnitude = get_subsecond_magnitude(timestamp->time.nanosecond);
-    const uint64_t subsecond = timestamp->time.nanosecond / g_subsec_multipliers[magnitude];
-    const unsigned encoded_year = encode_year_and_utc_flag(timestamp->date.year, timestamp->time.timezone.type == CT_TZ_ZERO);
-    const int year_group_count = get_year_group_count(encoded_year, g_timestamp_year_upper_bits[magnitude]);
-    const int year_group_bit_count = year_group_count * BITS_PER_YEAR_GROUP;
-    const unsigned year_grouped_mask = (1<<year_group_bit_count) - 1;
+    const int result = timestamp_encode(timestamp, magnitude, dst, dst_length);
+    COUNT_TIMESTAMP_ENCODE(timestamp, magnitude, result);
+    return result;
+}
 
-    uint64_t accumulator = encoded_year >> year_group_bit_count;
-    accumulator = (accumulator << (SIZE_SUBSECOND * magnitude)) + subsecond;
-    accumulator = (accumulator << SIZE_MONTH) + timestamp->date.month;
-    accumulator = (accumulator << SIZE_DAY) + timestamp->date.day;
-    accumulator = (accumulator << SIZE_HOUR) + timestamp->time.hour;
-    accumulator = (accumulator << SIZE_MINUTE) + timestamp->time.minute;
-    accumulator = (accumulator << SIZE_SECOND) + timestamp->time.second;
-    accumulator = (accumulator << SIZE_MAGNITUDE) + magnitude;
+int ct_date_encode_unchecked(const ct_date* date, uint8_t* dst)
+{
+    const unsigned encoded_year = encode_year(date->year);
+    const int year_group_count = get_year_group_count(encoded_year, SIZE_DATE_YEAR_UPPER_BITS);
+    write_uint16_le(date_accumulator(date, encoded_year, year_group_count), dst);
+    return BYTE_COUNT_DATE + rvlq_encode_32_unchecked(encoded_year, year_group_count, dst + BYTE_COUNT_DATE);
+}
 
-    int offset = 0;
-    const int accumulator_size = get_base_byte_count(BASE_SIZE_TIMESTAMP, magnitude);
-    if(accumulator_size > dst_length)
+int ct_time_encode_unchecked(const ct_time* time, uint8_t* dst)
+{
+    const int magnitude = get_subsecond_magnitude(time->nanosecond);
+    const uint64_t accumulator = time_accumulator(time, magnitude);
+    const int offset = get_base_byte_count(BASE_SIZE_TIME, magnitude);
+    copy_le(&accumulator, dst, offset);
+
+    const int timezone_byte_count = timezone_encode_unchecked(&time->timezone, dst + offset);
+    if(timezone_byte_count < 0)
     {
-        return FAILURE_AT_POS(accumulator_size);
+        return timezone_byte_count;
     }
-    copy_le(&accumulator, dst + offset, accumulator_size);
-    offset += accumulator_size;
+    return offset + timezone_byte_count;
+}
 
-    const int rvlq_byte_count = rvlq_encode_32(encoded_year & year_grouped_mask, dst+offset, dst_length - offset);
-    if(rvlq_byte_count <= 0)
+int ct_timestamp_encode_unchecked(const ct_timestamp* timestamp, uint8_t* dst)
+{
+    const int magnitude = get_subsecond_magnitude(timestamp->time.nanosecond);
+    const bool timezone_is_utc = timestamp->time.timezone.type == CT_TZ_ZERO;
+    const unsigned encoded_year = encode_year_and_utc_flag(timestamp->date.year, timezone_is_utc);
+    const int year_group_count = get_year_group_count(encoded_year, g_timestamp_year_upper_bits[magnitude]);
+    const uint64_t accumulator = timestamp_base_accumulator(&timestamp->date,
+                                                            timestamp->time.hour,
+                                                            timestamp->time.minute,
+                                                            timestamp->time.second,
+                                                            timestamp->time.nanosecond,
+                                                            magnitude,
+                                                            encoded_year,
+                                                            year_group_count);
+
+    int offset = g_timestamp_base_byte_counts[magnitude];
+    copy_le(&accumulator, dst, offset);
+    offset += rvlq_encode_32_unchecked(encoded_year, year_group_count, dst + offset);
+    if(timezone_is_utc)
     {
-        return FAILURE_AT_POS(offset) + rvlq_byte_count;
+        return offset;
     }
-    offset += rvlq_byte_count;
 
-    const int timezone_byte_count = timezone_encode(&timestamp->time.timezone, dst+offset, dst_length-offset);
+    const int timezone_byte_count = timezone_encode_unchecked(&timestamp->time.timezone, dst + offset);
     if(timezone_byte_count < 0)
     {
-        return FAILURE_AT_POS(offset) + timezone_byte_count;
+        return timezone_byte_count;
     }
-    offset += timezone_byte_count;
+    return offset + timezone_byte_count;
+}
 
-    return offset;
+int ct_timestamp_encode_utc_seconds(const ct_timestamp* timestamp, uint8_t* dst, int dst_length)
+{
+    const unsigned encoded_year = encode_year_and_utc_flag(timestamp->date.year, true);
+    if(timestamp->time.timezone.type != CT_TZ_ZERO ||
+       timestamp->time.nanosecond != 0 ||
+       encoded_year > UTC_SECONDS_MAX_ENCODED_YEAR ||
+       dst_length < UTC_SECONDS_BYTE_COUNT)
+    {
+        return ct_timestamp_encode(timestamp, dst, dst_length);
+    }
+
+    // Magnitude 0, so nothing is added at SHIFT_MAGNITUDE or in the subsecond bits.
+    const uint32_t accumulator = ((uint32_t)(encoded_year >> BITS_PER_YEAR_GROUP) << SHIFT_SUBSECOND) +
+                                 ((uint32_t)timestamp->date.month << SHIFT_MONTH) +
+                                 ((uint32_t)timestamp->date.day << SHIFT_DAY) +
+                                 ((uint32_t)timestamp->time.hour << SHIFT_HOUR) +
+                                 ((uint32_t)timestamp->time.minute << SHIFT_MINUTE) +
+                                 ((uint32_t)timestamp->time.second << SHIFT_SECOND);
+    write_uint32_le(accumulator, dst);
+    dst[UTC_SECONDS_ACCUMULATOR_SIZE] = encoded_year & UTC_SECONDS_MASK_YEAR_GROUP;
+    return UTC_SECONDS_BYTE_COUNT;
 }
 
 int ct_date_decode(const uint8_t* src, int src_length, ct_date* date)
@@ -485,7 +1195,11 @@ int ct_time_decode(const uint8_t* src, int src_length, ct_time* time)
     accumulator >>= SIZE_SECOND;
     time->nanosecond = (accumulator & mask_subsecond) * subsecond_multiplier;
 
-    int timezone_byte_count = timezone_decode(&time->timezone, src + offset, src_length - offset, timezone_is_utc);
+    int timezone_byte_count = timezone_decode(&time->timezone, src + offset, src_length - offset, offset, timezone_is_utc);
+    if(timezone_byte_count == ERROR_OUT_OF_RANGE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
     if(timezone_byte_count < 0)
     {
         return FAILURE_AT_POS(offset) + timezone_byte_count;
@@ -497,67 +1211,214 @@ int ct_time_decode(const uint8_t* src, int src_length, ct_time* time)
 
 int ct_timestamp_decode(const uint8_t* src, int src_length, ct_timestamp* timestamp)
 {
-    KSLOG_DATA_DEBUG(src, src_length, "ct_timestamp_decode()");
-    if(src_length < 1)
+    const int result = timestamp_decode(src, src_length, timestamp);
+    COUNT_TIMESTAMP_DECODE(src, src_length, timestamp, result);
+    return result;
+}
+
+int ct_timestamp_decode_view(const uint8_t* src, int src_length, ct_timestamp_view* timestamp)
+{
+    KSLOG_DATA_DEBUG(src, src_length, "ct_timestamp_decode_view()");
+    bool timezone_is_utc = false;
+    int offset = timestamp_base_decode(src,
+                                       src_length,
+                                       &timestamp->date,
+                                       &timestamp->hour,
+                                       &timestamp->minute,
+                                       &timestamp->second,
+                                       &timestamp->nanosecond,
+                                       &timezone_is_utc);
+    if(offset < 0)
     {
-        KSLOG_DEBUG("Failed because not even 1 byte available");
-        return FAILURE_AT_POS(1);
+        return offset;
     }
 
-    const int magnitude = src[0] & MASK_MAGNITUDE;
-    const int subsecond_multiplier = g_subsec_multipliers[magnitude];
-    const int size_subsecond = SIZE_SUBSECOND * magnitude;
-    const unsigned mask_subsecond = (1 << size_subsecond) - 1;
+    const int timezone_byte_count = timezone_decode_view(&timestamp->timezone, src + offset, src_length - offset, offset, timezone_is_utc);
+    if(timezone_byte_count == ERROR_OUT_OF_RANGE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(timezone_byte_count < 0)
+    {
+        return FAILURE_AT_POS(offset) + timezone_byte_count;
+    }
+    return offset + timezone_byte_count;
+}
 
-    int offset = get_base_byte_count(BASE_SIZE_TIMESTAMP, magnitude);
-    if(offset >= src_length)
+int ct_timestamp_decode_utc_seconds(const uint8_t* src, int src_length, ct_timestamp* timestamp)
+{
+    // Magnitude 0, and a final (UTC flagged) year group right after the accumulator.
+    if(src_length < UTC_SECONDS_BYTE_COUNT ||
+       (src[0] & MASK_MAGNITUDE) != 0 ||
+       (src[UTC_SECONDS_ACCUMULATOR_SIZE] & (RVLQ_CONTINUATION_BIT | 1)) != 1)
     {
-        KSLOG_DEBUG("Failed decoding base struct");
-        return FAILURE_AT_POS(offset);
+        return ct_timestamp_decode(src, src_length, timestamp);
     }
 
-    uint64_t accumulator = 0;
-    copy_le(src, &accumulator, offset);
+    const uint32_t accumulator = read_uint32_le(src);
+    const unsigned encoded_year = ((accumulator >> SHIFT_SUBSECOND) << BITS_PER_YEAR_GROUP) |
+                                  src[UTC_SECONDS_ACCUMULATOR_SIZE];
+    timestamp->date.year = decode_year(encoded_year >> 1);
+    timestamp->date.month = (accumulator >> SHIFT_MONTH) & MASK_MONTH;
+    timestamp->date.day = (accumulator >> SHIFT_DAY) & MASK_DAY;
+    timestamp->time.hour = (accumulator >> SHIFT_HOUR) & MASK_HOUR;
+    timestamp->time.minute = (accumulator >> SHIFT_MINUTE) & MASK_MINUTE;
+    timestamp->time.second = (accumulator >> SHIFT_SECOND) & MASK_SECOND;
+    timestamp->time.nanosecond = 0;
+    timestamp->time.timezone.type = CT_TZ_ZERO;
+    return UTC_SECONDS_BYTE_COUNT;
+}
 
-    accumulator >>= SIZE_MAGNITUDE;
-    timestamp->time.second = accumulator & MASK_SECOND;
-    accumulator >>= SIZE_SECOND;
-    timestamp->time.minute = accumulator & MASK_MINUTE;
-    accumulator >>= SIZE_MINUTE;
-    timestamp->time.hour = accumulator & MASK_HOUR;
-    accumulator >>= SIZE_HOUR;
-    timestamp->date.day = accumulator & MASK_DAY;
-    accumulator >>= SIZE_DAY;
-    timestamp->date.month = accumulator & MASK_MONTH;
-    accumulator >>= SIZE_MONTH;
-    timestamp->time.nanosecond = (accumulator & mask_subsecond) * subsecond_multiplier;
-    accumulator >>= size_subsecond;
-    uint32_t year_encoded = (uint32_t)accumulator;
+int ct_timestamp_encode_batch(const ct_timestamp* timestamps,
+                              int timestamp_count,
+                              uint8_t* dst,
+                              int dst_length,
+                              int* record_offsets,
+                              int* records_processed)
+{
+    int offset = 0;
+    int index = 0;
+    int result = 0;
 
-    const int decoded_group_count = rvlq_decode_32(&year_encoded, src + offset, src_length - offset);
-    if(decoded_group_count < 1)
+    // Runs of records usually share a subsecond value, so only redo the
+    // magnitude detection when the nanosecond field actually changes.
+    uint32_t previous_nanosecond = 0;
+    int magnitude = 0;
+
+    for(; index < timestamp_count; index++)
     {
-        KSLOG_DEBUG("Failed decoding RVLQ");
-        return FAILURE_AT_POS(offset) + decoded_group_count;
+        const ct_timestamp* timestamp = &timestamps[index];
+        if(timestamp->time.nanosecond != previous_nanosecond)
+        {
+            previous_nanosecond = timestamp->time.nanosecond;
+            magnitude = get_subsecond_magnitude(previous_nanosecond);
+        }
+
+        const int byte_count = timestamp_encode(timestamp, magnitude, dst + offset, dst_length - offset);
+        COUNT_TIMESTAMP_ENCODE(timestamp, magnitude, byte_count);
+        if(byte_count == ERROR_OUT_OF_RANGE)
+        {
+            result = ERROR_OUT_OF_RANGE;
+            break;
+        }
+        if(byte_count < 0)
+        {
+            result = FAILURE_AT_POS(offset) + byte_count;
+            break;
+        }
+        if(record_offsets != NULL)
+        {
+            record_offsets[index] = offset;
+        }
+        offset += byte_count;
+        result = offset;
     }
-    offset += decoded_group_count;
 
-    uint32_t timezone_is_utc = year_encoded & 1;
-    year_encoded >>= 1;
-    timestamp->date.year = decode_year(year_encoded);
+    if(records_processed != NULL)
+    {
+        *records_processed = index;
+    }
+    return result;
+}
 
-    int timezone_byte_count = timezone_decode(&timestamp->time.timezone, src + offset, src_length - offset, timezone_is_utc);
-    if(timezone_byte_count < 0)
+int ct_timestamp_decode_batch(const uint8_t* src,
+                              int src_length,
+                              ct_timestamp* timestamps,
+                              int max_timestamp_count,
+                              int* record_offsets,
+                              int* records_processed)
+{
+    int offset = 0;
+    int index = 0;
+    int result = 0;
+
+    for(; index < max_timestamp_count && offset < src_length; index++)
     {
-        KSLOG_DEBUG("Failed decoding timezone");
-        return FAILURE_AT_POS(offset) + timezone_byte_count;
+        const int byte_count = timestamp_decode(src + offset, src_length - offset, &timestamps[index]);
+        COUNT_TIMESTAMP_DECODE(src + offset, src_length - offset, &timestamps[index], byte_count);
+        if(byte_count == ERROR_OUT_OF_RANGE)
+        {
+            result = ERROR_OUT_OF_RANGE;
+            break;
+        }
+        if(byte_count < 0)
+        {
+            result = FAILURE_AT_POS(offset) + byte_count;
+            break;
+        }
+        if(record_offsets != NULL)
+        {
+            record_offsets[index] = offset;
+        }
+        offset += byte_count;
+        result = offset;
     }
-    offset += timezone_byte_count;
 
-    KSLOG_TRACE("TS = %d.%02d.%02d-%d:%02d:%02d.%09d, [%s], [%d/%d]",
-        timestamp->date.year, timestamp->date.month, timestamp->date.day,
-        timestamp->time.hour, timestamp->time.minute, timestamp->time.second, timestamp->time.nanosecond,
-        timestamp->time.timezone.as_string, timestamp->time.timezone.latitude, timestamp->time.timezone.longitude);
+    if(records_processed != NULL)
+    {
+        *records_processed = index;
+    }
+    return result;
+}
+
+void ct_timestamp_from_unix_ns(int64_t unix_ns, ct_timestamp* timestamp)
+{
+    unix_ns_to_fields(unix_ns,
+                      &timestamp->date,
+                      &timestamp->time.hour,
+                      &timestamp->time.minute,
+                      &timestamp->time.second,
+                      &timestamp->time.nanosecond);
+    timestamp->time.timezone.type = CT_TZ_ZERO;
+}
 
+int ct_timestamp_to_unix_ns(const ct_timestamp* timestamp, int64_t* unix_ns)
+{
+    if(timestamp->time.timezone.type != CT_TZ_ZERO)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    return fields_to_unix_ns(&timestamp->date,
+                             timestamp->time.hour,
+                             timestamp->time.minute,
+                             timestamp->time.second,
+                             timestamp->time.nanosecond,
+                             unix_ns);
+}
+
+int ct_timestamp_encode_unix_ns(int64_t unix_ns, uint8_t* dst, int dst_length)
+{
+    ct_date date;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint32_t nanosecond;
+    unix_ns_to_fields(unix_ns, &date, &hour, &minute, &second, &nanosecond);
+    const int magnitude = get_subsecond_magnitude(nanosecond);
+    return timestamp_base_encode(&date, hour, minute, second, nanosecond, magnitude, true, dst, dst_length);
+}
+
+int ct_timestamp_decode_unix_ns(const uint8_t* src, int src_length, int64_t* unix_ns)
+{
+    ct_date date;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint32_t nanosecond;
+    bool timezone_is_utc = false;
+    const int offset = timestamp_base_decode(src, src_length, &date, &hour, &minute, &second, &nanosecond, &timezone_is_utc);
+    if(offset < 0)
+    {
+        return offset;
+    }
+    if(!timezone_is_utc)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    const int result = fields_to_unix_ns(&date, hour, minute, second, nanosecond, unix_ns);
+    if(result < 0)
+    {
+        return result;
+    }
     return offset;
 }
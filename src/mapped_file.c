@@ -0,0 +1,265 @@
+/*
+ * Compact Time
+ * ============
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#if !defined(_WIN32)
+    // For madvise()
+    #define _DEFAULT_SOURCE
+#endif
+
+#include "compact_time/mapped_file.h"
+#include "compact_time_internal.h"
+
+#include <limits.h>
+#include <string.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// How far a cursor over a mapped file advances between page releases.
+static const int64_t RELEASE_INTERVAL = 32 * 1024 * 1024;
+
+#if defined(_WIN32)
+
+static bool map_file(ct_mapped_file* file, const char* path)
+{
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if(handle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(handle, &size))
+    {
+        CloseHandle(handle);
+        return false;
+    }
+    file->length = size.QuadPart;
+    if(file->length == 0)
+    {
+        CloseHandle(handle);
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(handle);
+    if(mapping == NULL)
+    {
+        return false;
+    }
+    file->data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if(file->data == NULL)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+    file->platform_handle = mapping;
+    return true;
+}
+
+static void unmap_file(ct_mapped_file* file)
+{
+    if(file->data != NULL)
+    {
+        UnmapViewOfFile(file->data);
+        CloseHandle(file->platform_handle);
+    }
+}
+
+static void release_pages(const ct_mapped_file* file, int64_t offset, int64_t length)
+{
+    (void)file;
+    (void)offset;
+    (void)length;
+}
+
+#else
+
+static bool map_file(ct_mapped_file* file, const char* path)
+{
+    const int fd = open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        return false;
+    }
+    struct stat file_stat;
+    if(fstat(fd, &file_stat) != 0 || (uint64_t)file_stat.st_size > SIZE_MAX)
+    {
+        close(fd);
+        return false;
+    }
+    file->length = file_stat.st_size;
+    if(file->length == 0)
+    {
+        close(fd);
+        return true;
+    }
+
+    // The mapping holds its own reference to the file.
+    void* data = mmap(NULL, file->length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED)
+    {
+        return false;
+    }
+    madvise(data, file->length, MADV_SEQUENTIAL);
+    file->data = data;
+    return true;
+}
+
+static void unmap_file(ct_mapped_file* file)
+{
+    if(file->data != NULL)
+    {
+        munmap((void*)file->data, file->length);
+    }
+}
+
+static void release_pages(const ct_mapped_file* file, int64_t offset, int64_t length)
+{
+    // The mapping is read-only, so dropped pages are simply re-read if touched.
+    madvise((void*)(file->data + offset), length, MADV_DONTNEED);
+}
+
+#endif
+
+static void release_behind(ct_record_cursor* cursor)
+{
+    if(cursor->file == NULL || cursor->offset - cursor->released_offset < RELEASE_INTERVAL)
+    {
+        return;
+    }
+    // Mappings start on a page boundary, and RELEASE_INTERVAL is a multiple of any page size.
+    release_pages(cursor->file, cursor->released_offset, RELEASE_INTERVAL);
+    cursor->released_offset += RELEASE_INTERVAL;
+}
+
+// Records are tiny, so a view of the buffer never needs more than INT_MAX bytes.
+static int get_remaining_length(const ct_record_cursor* cursor)
+{
+    const int64_t remaining = cursor->length - cursor->offset;
+    return remaining > INT_MAX ? INT_MAX : (int)remaining;
+}
+
+
+
+// ----------
+// Public API
+// ----------
+
+bool ct_mapped_file_open(ct_mapped_file* file, const char* path)
+{
+    memset(file, 0, sizeof(*file));
+    if(!map_file(file, path))
+    {
+        memset(file, 0, sizeof(*file));
+        return false;
+    }
+    return true;
+}
+
+void ct_mapped_file_close(ct_mapped_file* file)
+{
+    unmap_file(file);
+    memset(file, 0, sizeof(*file));
+}
+
+void ct_record_cursor_init(ct_record_cursor* cursor, const uint8_t* data, int64_t length)
+{
+    memset(cursor, 0, sizeof(*cursor));
+    cursor->data = data;
+    cursor->length = length;
+}
+
+void ct_record_cursor_init_mapped(ct_record_cursor* cursor, const ct_mapped_file* file)
+{
+    ct_record_cursor_init(cursor, file->data, file->length);
+    cursor->file = file;
+}
+
+int ct_record_cursor_next_span(ct_record_cursor* cursor, ct_record_span* span)
+{
+    if(cursor->offset >= cursor->length)
+    {
+        return 0;
+    }
+    const uint8_t* data = cursor->data + cursor->offset;
+    const int record_length = ct_internal_timestamp_record_length(data, get_remaining_length(cursor));
+    if(record_length < 0)
+    {
+        return record_length;
+    }
+    span->data = data;
+    span->length = record_length;
+    cursor->offset += record_length;
+    release_behind(cursor);
+    return record_length;
+}
+
+int ct_record_cursor_next(ct_record_cursor* cursor, ct_timestamp* timestamp)
+{
+    if(cursor->offset >= cursor->length)
+    {
+        return 0;
+    }
+    const int byte_count = ct_timestamp_decode(cursor->data + cursor->offset, get_remaining_length(cursor), timestamp);
+    if(byte_count < 0)
+    {
+        return byte_count;
+    }
+    cursor->offset += byte_count;
+    release_behind(cursor);
+    return byte_count;
+}
+
+int ct_record_cursor_next_view(ct_record_cursor* cursor, ct_timestamp_view* timestamp)
+{
+    if(cursor->offset >= cursor->length)
+    {
+        return 0;
+    }
+    const int byte_count = ct_timestamp_decode_view(cursor->data + cursor->offset, get_remaining_length(cursor), timestamp);
+    if(byte_count < 0)
+    {
+        return byte_count;
+    }
+    cursor->offset += byte_count;
+    release_behind(cursor);
+    return byte_count;
+}
+
+int64_t ct_record_cursor_offset(const ct_record_cursor* cursor)
+{
+    return cursor->offset;
+}
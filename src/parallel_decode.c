@@ -0,0 +1,316 @@
+/*
+ * Compact Time
+ * ============
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "compact_time/parallel_decode.h"
+#include "compact_time_internal.h"
+
+#include <limits.h>
+#include <stdatomic.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+// Records per chunk: big enough to amortize claiming a chunk, small enough
+// to balance the load across threads.
+static const int64_t CHUNK_RECORD_COUNT = 4096;
+static const int MAX_THREAD_COUNT = 256;
+
+typedef struct
+{
+    const uint8_t* stream;
+    int64_t stream_length;
+    // Chunks are found through a stream index, or directly from the offsets
+    // of their first records.
+    const ct_stream_index* index;
+    const int64_t* chunk_offsets;
+    ct_timestamp* timestamps;
+    int64_t first_record;
+    int64_t end_record;
+    int64_t chunk_record_count;
+    int64_t chunk_count;
+    atomic_llong next_chunk;
+    atomic_llong first_failed_record;
+} decode_job;
+
+static int64_t get_chunk_start(const decode_job* job, int64_t chunk_index)
+{
+    if(chunk_index == 0)
+    {
+        return job->first_record;
+    }
+    // Later chunks start on indexed records, so seeking to them is a lookup.
+    return (job->first_record / job->chunk_record_count + chunk_index) * job->chunk_record_count;
+}
+
+static void record_failure(decode_job* job, int64_t record)
+{
+    long long current = atomic_load(&job->first_failed_record);
+    while(record < current && !atomic_compare_exchange_weak(&job->first_failed_record, &current, record))
+    {
+    }
+}
+
+static void decode_chunk(decode_job* job, int64_t chunk_index)
+{
+    const int64_t start = get_chunk_start(job, chunk_index);
+    int64_t end = get_chunk_start(job, chunk_index + 1);
+    if(end > job->end_record)
+    {
+        end = job->end_record;
+    }
+
+    int64_t offset = job->chunk_offsets != NULL ? job->chunk_offsets[chunk_index] : ct_stream_seek(job->index, start, NULL);
+    if(offset < 0)
+    {
+        record_failure(job, start);
+        return;
+    }
+    for(int64_t record = start; record < end; record++)
+    {
+        const int64_t remaining = job->stream_length - offset;
+        const int byte_count = ct_timestamp_decode(job->stream + offset,
+                                                   remaining > INT_MAX ? INT_MAX : (int)remaining,
+                                                   &job->timestamps[record - job->first_record]);
+        if(byte_count <= 0)
+        {
+            record_failure(job, record);
+            return;
+        }
+        offset += byte_count;
+    }
+}
+
+static void decode_worker(decode_job* job)
+{
+    for(;;)
+    {
+        const int64_t chunk_index = atomic_fetch_add(&job->next_chunk, 1);
+        if(chunk_index >= job->chunk_count)
+        {
+            return;
+        }
+        // Chunks past a failure will be discarded anyway.
+        if(get_chunk_start(job, chunk_index) > atomic_load(&job->first_failed_record))
+        {
+            continue;
+        }
+        decode_chunk(job, chunk_index);
+    }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI decode_thread(LPVOID job)
+{
+    decode_worker(job);
+    return 0;
+}
+#else
+static void* decode_thread(void* job)
+{
+    decode_worker(job);
+    return NULL;
+}
+#endif
+
+static void run_job(decode_job* job, int thread_count)
+{
+    if(thread_count > MAX_THREAD_COUNT)
+    {
+        thread_count = MAX_THREAD_COUNT;
+    }
+    if(thread_count > job->chunk_count)
+    {
+        thread_count = job->chunk_count;
+    }
+
+    // If a thread can't be started, the threads that did start (and the
+    // calling thread) pick up its share of the chunks.
+#if defined(_WIN32)
+    HANDLE threads[MAX_THREAD_COUNT];
+    int started_count = 0;
+    while(started_count < thread_count - 1 &&
+          (threads[started_count] = CreateThread(NULL, 0, decode_thread, job, 0, NULL)) != NULL)
+    {
+        started_count++;
+    }
+    decode_worker(job);
+    for(int i = 0; i < started_count; i++)
+    {
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+    }
+#else
+    pthread_t threads[MAX_THREAD_COUNT];
+    int started_count = 0;
+    while(started_count < thread_count - 1 &&
+          pthread_create(&threads[started_count], NULL, decode_thread, job) == 0)
+    {
+        started_count++;
+    }
+    decode_worker(job);
+    for(int i = 0; i < started_count; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+#endif
+}
+
+// Decode the job's records, returning how many were decoded before the first failure.
+static int64_t decode_chunks(decode_job* job, int thread_count)
+{
+    const int64_t record_count = job->end_record - job->first_record;
+    job->chunk_count = (job->end_record - 1) / job->chunk_record_count - job->first_record / job->chunk_record_count + 1;
+    atomic_init(&job->next_chunk, 0);
+    atomic_init(&job->first_failed_record, INT64_MAX);
+
+    run_job(job, thread_count);
+
+    const int64_t first_failed_record = atomic_load(&job->first_failed_record);
+    return first_failed_record == INT64_MAX ? record_count : first_failed_record - job->first_record;
+}
+
+
+
+// ----------
+// Public API
+// ----------
+
+int64_t ct_timestamp_decode_parallel(const uint8_t* src,
+                                     int64_t src_length,
+                                     ct_timestamp* timestamps,
+                                     int64_t max_timestamp_count,
+                                     int thread_count,
+                                     int64_t* records_processed)
+{
+    if(records_processed != NULL)
+    {
+        *records_processed = 0;
+    }
+
+    // Find the chunk boundaries with a sequential pass over the record lengths.
+    ct_stream_index_builder builder;
+    if(!ct_stream_index_builder_init(&builder, CHUNK_RECORD_COUNT))
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    int64_t offset = 0;
+    int64_t truncated_result = 0;
+    while(builder.record_count < max_timestamp_count && offset < src_length)
+    {
+        const int64_t remaining = src_length - offset;
+        const int record_length = ct_internal_timestamp_record_length(src + offset,
+                                                                      remaining > INT_MAX ? INT_MAX : (int)remaining);
+        if(record_length < 0)
+        {
+            truncated_result = FAILURE_AT_POS(offset) + record_length;
+            break;
+        }
+        if(!ct_stream_index_builder_add(&builder, record_length))
+        {
+            ct_stream_index_builder_free(&builder);
+            return ERROR_OUT_OF_RANGE;
+        }
+        offset += record_length;
+    }
+
+    const int64_t record_count = builder.record_count;
+    int64_t decoded_count = 0;
+    if(record_count > 0)
+    {
+        // The builder's offsets are those of every chunk's first record.
+        decode_job job =
+        {
+            .stream = src,
+            .stream_length = offset,
+            .chunk_offsets = builder.offsets,
+            .timestamps = timestamps,
+            .first_record = 0,
+            .end_record = record_count,
+            .chunk_record_count = CHUNK_RECORD_COUNT,
+        };
+        decoded_count = decode_chunks(&job, thread_count);
+    }
+    ct_stream_index_builder_free(&builder);
+
+    if(records_processed != NULL)
+    {
+        *records_processed = decoded_count;
+    }
+    if(decoded_count < record_count)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(truncated_result < 0)
+    {
+        return truncated_result;
+    }
+    return offset;
+}
+
+int64_t ct_stream_decode_parallel(const ct_stream_index* index,
+                                  int64_t first_record,
+                                  int64_t record_count,
+                                  ct_timestamp* timestamps,
+                                  int thread_count,
+                                  int64_t* records_processed)
+{
+    if(records_processed != NULL)
+    {
+        *records_processed = 0;
+    }
+    if(first_record < 0 || record_count < 0 || record_count > index->record_count - first_record)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(record_count == 0)
+    {
+        return 0;
+    }
+
+    // Round chunks to a whole number of index intervals so that they start on indexed records.
+    decode_job job =
+    {
+        .stream = index->stream,
+        .stream_length = index->stream_length,
+        .index = index,
+        .timestamps = timestamps,
+        .first_record = first_record,
+        .end_record = first_record + record_count,
+        .chunk_record_count = (CHUNK_RECORD_COUNT + index->interval - 1) / index->interval * index->interval,
+    };
+    const int64_t decoded_count = decode_chunks(&job, thread_count);
+    if(records_processed != NULL)
+    {
+        *records_processed = decoded_count;
+    }
+    return decoded_count < record_count ? ERROR_OUT_OF_RANGE : record_count;
+}
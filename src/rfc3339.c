@@ -0,0 +1,720 @@
+/*
+ * Compact Time
+ * ============
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// RFC 3339 text conversion.
+//
+// The fixed "YYYY-MM-DDTHH:MM" start of a date-time fills exactly one SSE2
+// chunk, which is validated and converted at once: subtracting '0' turns
+// the digits into values, and the 16-bit lanes of the result (and of the
+// result shifted along a byte) then hold each two-digit field as its tens
+// and ones. Up to 8 fraction digits are converted together as a 64-bit word.
+// Everything else is short enough to do a byte at a time, and formatting
+// writes digit pairs from a table.
+
+#include "compact_time/rfc3339.h"
+#include "compact_time_internal.h"
+
+#include <endianness/endianness.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+    #define CT_HAS_TEXT_SIMD 1
+    #include <emmintrin.h>
+#endif
+
+static const int MINUTES_PER_DAY = 24 * 60;
+static const int MAX_FRACTION_DIGITS = 9;
+static const int MAX_TEXT_YEAR = 9999;
+
+// "YYYY-MM-DD"
+static const int DATE_LENGTH = 10;
+// "HH:MM"
+static const int HOUR_MINUTE_LENGTH = 5;
+// ":SS"
+static const int SECOND_LENGTH = 3;
+// "+HH:MM"
+static const int OFFSET_LENGTH = 6;
+
+static const char g_digit_pairs[200] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Fields parsed from text, with an astronomical year (0 is 1 BC).
+typedef struct
+{
+    int32_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint32_t nanosecond;
+    int offset_minutes; // East of UTC
+} text_fields;
+
+static int32_t to_compact_year(int64_t year)
+{
+    // Compact time has no year 0: astronomical year 0 is 1 BC (-1).
+    return (int32_t)(year <= 0 ? year - 1 : year);
+}
+
+static bool parse_digits(const char* text, int digit_count, int* value)
+{
+    int result = 0;
+    for(int i = 0; i < digit_count; i++)
+    {
+        const unsigned digit = (uint8_t)text[i] - (unsigned)'0';
+        if(digit > 9)
+        {
+            return false;
+        }
+        result = result * 10 + digit;
+    }
+    *value = result;
+    return true;
+}
+
+static bool is_date_time_separator(char ch)
+{
+    return ch == 'T' || ch == 't' || ch == ' ';
+}
+
+static bool is_valid_date(const text_fields* fields)
+{
+    return fields->month >= 1 && fields->month <= 12 &&
+           fields->day >= 1 && fields->day <= ct_internal_get_days_in_month(fields->year, fields->month);
+}
+
+static int parse_date_text(const char* text, int text_length, text_fields* fields)
+{
+    if(text_length < DATE_LENGTH)
+    {
+        return FAILURE_AT_POS(DATE_LENGTH);
+    }
+    int year = 0;
+    int month = 0;
+    int day = 0;
+    if(!parse_digits(text, 4, &year) || text[4] != '-' ||
+       !parse_digits(text + 5, 2, &month) || text[7] != '-' ||
+       !parse_digits(text + 8, 2, &day))
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    fields->year = year;
+    fields->month = month;
+    fields->day = day;
+    return is_valid_date(fields) ? DATE_LENGTH : ERROR_OUT_OF_RANGE;
+}
+
+static int parse_hour_minute_text(const char* text, int text_length, text_fields* fields)
+{
+    if(text_length < HOUR_MINUTE_LENGTH)
+    {
+        return FAILURE_AT_POS(HOUR_MINUTE_LENGTH);
+    }
+    int hour = 0;
+    int minute = 0;
+    if(!parse_digits(text, 2, &hour) || text[2] != ':' || !parse_digits(text + 3, 2, &minute))
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    fields->hour = hour;
+    fields->minute = minute;
+    return HOUR_MINUTE_LENGTH;
+}
+
+// Convert the leading digits of 8 bytes of text, as though the digits after
+// them were zeros. digit_count receives the number of leading digits.
+static uint32_t convert_fraction_word(const char* text, int* digit_count)
+{
+    const uint64_t word = read_uint64_le(text);
+    // A byte is a digit if its high nibble is 3 and its low nibble is under
+    // 10. Nothing carries between bytes.
+    const uint64_t not_digits = (word & 0xf0f0f0f0f0f0f0f0ull) ^ 0x3030303030303030ull;
+    const uint64_t over_nine = ((word & 0x0f0f0f0f0f0f0f0full) + 0x0606060606060606ull) & 0x1010101010101010ull;
+    const uint64_t bad = not_digits | over_nine;
+    const uint64_t bad_bytes = (((bad & 0x7f7f7f7f7f7f7f7full) + 0x7f7f7f7f7f7f7f7full) | bad) & 0x8080808080808080ull;
+    if(bad_bytes == 0)
+    {
+        *digit_count = 8;
+    }
+    else
+    {
+        *digit_count = __builtin_ctzll(bad_bytes) / 8;
+    }
+
+    // Keep only the digits, so the rest count as zeros.
+    uint64_t values = *digit_count == 8 ? word : word & ((1ull << (*digit_count * 8)) - 1);
+    values &= 0x0f0f0f0f0f0f0f0full;
+    values = (values * 2561) >> 8;
+    values = ((values & 0x00ff00ff00ff00ffull) * 6553601) >> 16;
+    return (uint32_t)(((values & 0x0000ffff0000ffffull) * 42949672960001ull) >> 32);
+}
+
+static int parse_fraction_text(const char* text, int text_length, uint32_t* nanosecond)
+{
+    int digit_count = 0;
+    uint32_t value = 0;
+    if(text_length >= 8)
+    {
+        value = convert_fraction_word(text, &digit_count);
+        if(digit_count < 8)
+        {
+            *nanosecond = value * 10;
+            return digit_count;
+        }
+    }
+
+    // Finish the digits (or all of them, if the text is too short).
+    for(; digit_count < text_length; digit_count++)
+    {
+        const unsigned digit = (uint8_t)text[digit_count] - (unsigned)'0';
+        if(digit > 9)
+        {
+            break;
+        }
+        if(digit_count >= MAX_FRACTION_DIGITS)
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        value = value * 10 + digit;
+    }
+    for(int i = digit_count; i < MAX_FRACTION_DIGITS; i++)
+    {
+        value *= 10;
+    }
+    *nanosecond = value;
+    return digit_count;
+}
+
+// Parse ":SS", an optional fraction, and the offset.
+static int parse_time_tail_text(const char* text, int text_length, int offset, text_fields* fields)
+{
+    if(text_length < offset + SECOND_LENGTH)
+    {
+        return FAILURE_AT_POS(offset + SECOND_LENGTH);
+    }
+    int second = 0;
+    if(text[offset] != ':' || !parse_digits(text + offset + 1, 2, &second) ||
+       fields->hour > 23 || fields->minute > 59 || second > 60)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    fields->second = second;
+    offset += SECOND_LENGTH;
+
+    if(offset >= text_length)
+    {
+        return FAILURE_AT_POS(offset + 1);
+    }
+    fields->nanosecond = 0;
+    if(text[offset] == '.')
+    {
+        offset++;
+        const int digit_count = parse_fraction_text(text + offset, text_length - offset, &fields->nanosecond);
+        if(digit_count < 0)
+        {
+            return digit_count;
+        }
+        offset += digit_count;
+        if(offset >= text_length)
+        {
+            return FAILURE_AT_POS(offset + 1);
+        }
+        if(digit_count == 0)
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+    }
+
+    const char designator = text[offset];
+    if(designator == 'Z' || designator == 'z')
+    {
+        fields->offset_minutes = 0;
+        return offset + 1;
+    }
+    if(designator != '+' && designator != '-')
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(text_length < offset + OFFSET_LENGTH)
+    {
+        return FAILURE_AT_POS(offset + OFFSET_LENGTH);
+    }
+    int offset_hour = 0;
+    int offset_minute = 0;
+    if(!parse_digits(text + offset + 1, 2, &offset_hour) || text[offset + 3] != ':' ||
+       !parse_digits(text + offset + 4, 2, &offset_minute) ||
+       offset_hour > 23 || offset_minute > 59)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    const int offset_minutes = offset_hour * 60 + offset_minute;
+    fields->offset_minutes = designator == '+' ? offset_minutes : -offset_minutes;
+    return offset + OFFSET_LENGTH;
+}
+
+#ifdef CT_HAS_TEXT_SIMD
+
+// "YYYY-MM-DDTHH:MM"
+#define PREFIX_CHUNK_SIZE 16
+#define PREFIX_SEPARATOR_BITS 0x2490 // Bytes 4, 7, 10 and 13
+#define PREFIX_DIGIT_BITS (0xffff & ~PREFIX_SEPARATOR_BITS)
+#define PREFIX_DATE_TIME_SEPARATOR 10
+
+static bool parse_date_time_prefix_simd(const char* text, text_fields* fields)
+{
+    const __m128i chunk = _mm_loadu_si128((const __m128i*)text);
+    const __m128i digits = _mm_sub_epi8(chunk, _mm_set1_epi8('0'));
+    const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+    // Fold the T to lower case so that t matches too.
+    const __m128i folded = _mm_or_si128(chunk, _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x20, 0, 0, 0, 0, 0));
+    const __m128i is_separator = _mm_cmpeq_epi8(folded, _mm_setr_epi8(0, 0, 0, 0, '-', 0, 0, '-', 0, 0, 't', 0, 0, ':', 0, 0));
+
+    unsigned separator_bits = (unsigned)_mm_movemask_epi8(is_separator);
+    separator_bits |= (unsigned)(text[PREFIX_DATE_TIME_SEPARATOR] == ' ') << PREFIX_DATE_TIME_SEPARATOR;
+    if(((unsigned)_mm_movemask_epi8(is_digit) & PREFIX_DIGIT_BITS) != PREFIX_DIGIT_BITS ||
+       (separator_bits & PREFIX_SEPARATOR_BITS) != PREFIX_SEPARATOR_BITS)
+    {
+        return false;
+    }
+
+    // tens * 10 + ones for the digit pairs starting at even and odd bytes
+    const __m128i low_bytes = _mm_set1_epi16(0x00ff);
+    const __m128i ten = _mm_set1_epi16(10);
+    const __m128i odd_digits = _mm_srli_si128(digits, 1);
+    const __m128i even_pairs = _mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(digits, low_bytes), ten),
+                                             _mm_srli_epi16(digits, 8));
+    const __m128i odd_pairs = _mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(odd_digits, low_bytes), ten),
+                                            _mm_srli_epi16(odd_digits, 8));
+
+    fields->year = _mm_extract_epi16(even_pairs, 0) * 100 + _mm_extract_epi16(even_pairs, 1);
+    fields->month = _mm_extract_epi16(odd_pairs, 2);
+    fields->day = _mm_extract_epi16(even_pairs, 4);
+    fields->hour = _mm_extract_epi16(odd_pairs, 5);
+    fields->minute = _mm_extract_epi16(even_pairs, 7);
+    return is_valid_date(fields);
+}
+
+#endif // CT_HAS_TEXT_SIMD
+
+static int parse_date_time_text(const char* text, int text_length, text_fields* fields)
+{
+#ifdef CT_HAS_TEXT_SIMD
+    if(text_length >= PREFIX_CHUNK_SIZE)
+    {
+        if(!parse_date_time_prefix_simd(text, fields))
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        return parse_time_tail_text(text, text_length, PREFIX_CHUNK_SIZE, fields);
+    }
+#endif
+
+    int offset = parse_date_text(text, text_length, fields);
+    if(offset < 0)
+    {
+        return offset;
+    }
+    if(offset >= text_length)
+    {
+        return FAILURE_AT_POS(offset + 1);
+    }
+    if(!is_date_time_separator(text[offset]))
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    offset++;
+    const int byte_count = parse_hour_minute_text(text + offset, text_length - offset, fields);
+    if(byte_count == ERROR_OUT_OF_RANGE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(byte_count < 0)
+    {
+        return FAILURE_AT_POS(offset) + byte_count;
+    }
+    return parse_time_tail_text(text, text_length, offset + byte_count, fields);
+}
+
+// Move the fields from their offset to UTC.
+static void apply_offset(text_fields* fields, bool has_date)
+{
+    int minute_of_day = fields->hour * 60 + fields->minute - fields->offset_minutes;
+    if(minute_of_day < 0)
+    {
+        minute_of_day += MINUTES_PER_DAY;
+        if(has_date && --fields->day < 1)
+        {
+            if(--fields->month < 1)
+            {
+                fields->month = 12;
+                fields->year--;
+            }
+            fields->day = ct_internal_get_days_in_month(fields->year, fields->month);
+        }
+    }
+    else if(minute_of_day >= MINUTES_PER_DAY)
+    {
+        minute_of_day -= MINUTES_PER_DAY;
+        if(has_date && ++fields->day > ct_internal_get_days_in_month(fields->year, fields->month))
+        {
+            fields->day = 1;
+            if(++fields->month > 12)
+            {
+                fields->month = 1;
+                fields->year++;
+            }
+        }
+    }
+    fields->hour = minute_of_day / 60;
+    fields->minute = minute_of_day % 60;
+    fields->offset_minutes = 0;
+}
+
+static void fields_to_date(const text_fields* fields, ct_date* date)
+{
+    date->year = to_compact_year(fields->year);
+    date->month = fields->month;
+    date->day = fields->day;
+}
+
+static void fields_to_time(const text_fields* fields, ct_time* time)
+{
+    time->hour = fields->hour;
+    time->minute = fields->minute;
+    time->second = fields->second;
+    time->nanosecond = fields->nanosecond;
+    time->timezone.type = CT_TZ_ZERO;
+}
+
+// Write digit_count digits of value, zero padded.
+static void write_digits(uint32_t value, int digit_count, char* dst)
+{
+    int position = digit_count;
+    while(position >= 2)
+    {
+        position -= 2;
+        memcpy(dst + position, g_digit_pairs + (value % 100) * 2, 2);
+        value /= 100;
+    }
+    if(position > 0)
+    {
+        dst[0] = '0' + value;
+    }
+}
+
+// Fewest digits that keep every nonzero digit of the nanoseconds (0, 3, 6 or 9)
+static int get_fraction_digit_count(uint32_t nanosecond)
+{
+    if(nanosecond == 0)
+    {
+        return 0;
+    }
+    if(nanosecond % 1000000 == 0)
+    {
+        return 3;
+    }
+    return nanosecond % 1000 == 0 ? 6 : 9;
+}
+
+static int get_time_text_length(int fraction_digit_count)
+{
+    // "HH:MM:SS", ".fff", "Z"
+    return 8 + (fraction_digit_count > 0 ? 1 + fraction_digit_count : 0) + 1;
+}
+
+static bool is_formattable_date(const ct_date* date)
+{
+    if(date->year == 0 || date->year < -1 || date->year > MAX_TEXT_YEAR ||
+       date->month < 1 || date->month > 12 || date->day < 1)
+    {
+        return false;
+    }
+    const int year = date->year < 0 ? 0 : date->year;
+    return date->day <= ct_internal_get_days_in_month(year, date->month);
+}
+
+static bool is_formattable_time(uint8_t hour, uint8_t minute, uint8_t second, uint32_t nanosecond)
+{
+    return hour <= 23 && minute <= 59 && second <= 60 && nanosecond <= 999999999;
+}
+
+static void write_date_text(const ct_date* date, char* dst)
+{
+    write_digits(date->year < 0 ? 0 : date->year, 4, dst);
+    dst[4] = '-';
+    write_digits(date->month, 2, dst + 5);
+    dst[7] = '-';
+    write_digits(date->day, 2, dst + 8);
+}
+
+static void write_time_text(uint8_t hour,
+                            uint8_t minute,
+                            uint8_t second,
+                            uint32_t nanosecond,
+                            int fraction_digit_count,
+                            char* dst)
+{
+    write_digits(hour, 2, dst);
+    dst[2] = ':';
+    write_digits(minute, 2, dst + 3);
+    dst[5] = ':';
+    write_digits(second, 2, dst + 6);
+    int offset = 8;
+
+    // Constant digit counts let the compiler unroll the writes and avoid
+    // dividing by a variable.
+    if(fraction_digit_count > 0)
+    {
+        dst[offset++] = '.';
+        switch(fraction_digit_count)
+        {
+            case 3:
+                write_digits(nanosecond / 1000000, 3, dst + offset);
+                break;
+            case 6:
+                write_digits(nanosecond / 1000, 6, dst + offset);
+                break;
+            default:
+                write_digits(nanosecond, 9, dst + offset);
+                break;
+        }
+        offset += fraction_digit_count;
+    }
+    dst[offset++] = 'Z';
+    dst[offset] = 0;
+}
+
+static int format_timestamp_fields(const ct_date* date,
+                                   uint8_t hour,
+                                   uint8_t minute,
+                                   uint8_t second,
+                                   uint32_t nanosecond,
+                                   char* dst,
+                                   int dst_length)
+{
+    if(!is_formattable_date(date) || !is_formattable_time(hour, minute, second, nanosecond))
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    const int fraction_digit_count = get_fraction_digit_count(nanosecond);
+    const int length = DATE_LENGTH + 1 + get_time_text_length(fraction_digit_count);
+    if(dst_length < length + 1)
+    {
+        return FAILURE_AT_POS(length + 1);
+    }
+    write_date_text(date, dst);
+    dst[DATE_LENGTH] = 'T';
+    write_time_text(hour, minute, second, nanosecond, fraction_digit_count, dst + DATE_LENGTH + 1);
+    return length;
+}
+
+
+
+// ----------
+// Public API
+// ----------
+
+int ct_date_parse_rfc3339(const char* text, int text_length, ct_date* date)
+{
+    text_fields fields;
+    const int length = parse_date_text(text, text_length, &fields);
+    if(length < 0)
+    {
+        return length;
+    }
+    fields_to_date(&fields, date);
+    return length;
+}
+
+int ct_time_parse_rfc3339(const char* text, int text_length, ct_time* time)
+{
+    text_fields fields;
+    const int byte_count = parse_hour_minute_text(text, text_length, &fields);
+    if(byte_count < 0)
+    {
+        return byte_count;
+    }
+    const int length = parse_time_tail_text(text, text_length, byte_count, &fields);
+    if(length < 0)
+    {
+        return length;
+    }
+    apply_offset(&fields, false);
+    fields_to_time(&fields, time);
+    return length;
+}
+
+int ct_timestamp_parse_rfc3339(const char* text, int text_length, ct_timestamp* timestamp)
+{
+    text_fields fields;
+    const int length = parse_date_time_text(text, text_length, &fields);
+    if(length < 0)
+    {
+        return length;
+    }
+    if(fields.offset_minutes != 0)
+    {
+        apply_offset(&fields, true);
+    }
+    fields_to_date(&fields, &timestamp->date);
+    fields_to_time(&fields, &timestamp->time);
+    return length;
+}
+
+int ct_date_format_rfc3339(const ct_date* date, char* dst, int dst_length)
+{
+    if(!is_formattable_date(date))
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(dst_length < DATE_LENGTH + 1)
+    {
+        return FAILURE_AT_POS(DATE_LENGTH + 1);
+    }
+    write_date_text(date, dst);
+    dst[DATE_LENGTH] = 0;
+    return DATE_LENGTH;
+}
+
+int ct_time_format_rfc3339(const ct_time* time, char* dst, int dst_length)
+{
+    if(time->timezone.type != CT_TZ_ZERO ||
+       !is_formattable_time(time->hour, time->minute, time->second, time->nanosecond))
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    const int fraction_digit_count = get_fraction_digit_count(time->nanosecond);
+    const int length = get_time_text_length(fraction_digit_count);
+    if(dst_length < length + 1)
+    {
+        return FAILURE_AT_POS(length + 1);
+    }
+    write_time_text(time->hour, time->minute, time->second, time->nanosecond, fraction_digit_count, dst);
+    return length;
+}
+
+int ct_timestamp_format_rfc3339(const ct_timestamp* timestamp, char* dst, int dst_length)
+{
+    if(timestamp->time.timezone.type != CT_TZ_ZERO)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    return format_timestamp_fields(&timestamp->date,
+                                   timestamp->time.hour,
+                                   timestamp->time.minute,
+                                   timestamp->time.second,
+                                   timestamp->time.nanosecond,
+                                   dst,
+                                   dst_length);
+}
+
+int ct_timestamp_encode_rfc3339(const char* text,
+                                int text_length,
+                                uint8_t* dst,
+                                int dst_length,
+                                int* chars_read)
+{
+    text_fields fields;
+    const int length = parse_date_time_text(text, text_length, &fields);
+    if(chars_read != NULL)
+    {
+        *chars_read = length > 0 ? length : 0;
+    }
+    if(length <= 0)
+    {
+        return length;
+    }
+    if(fields.offset_minutes != 0)
+    {
+        apply_offset(&fields, true);
+    }
+
+    ct_date date;
+    fields_to_date(&fields, &date);
+    return ct_internal_timestamp_base_encode(&date,
+                                             fields.hour,
+                                             fields.minute,
+                                             fields.second,
+                                             fields.nanosecond,
+                                             true,
+                                             dst,
+                                             dst_length);
+}
+
+int ct_timestamp_decode_rfc3339(const uint8_t* src,
+                                int src_length,
+                                char* dst,
+                                int dst_length,
+                                int* bytes_read)
+{
+    ct_date date;
+    uint8_t hour = 0;
+    uint8_t minute = 0;
+    uint8_t second = 0;
+    uint32_t nanosecond = 0;
+    bool timezone_is_utc = false;
+    int record_length = ct_internal_timestamp_base_decode(src,
+                                                          src_length,
+                                                          &date,
+                                                          &hour,
+                                                          &minute,
+                                                          &second,
+                                                          &nanosecond,
+                                                          &timezone_is_utc);
+    if(record_length > 0 && !timezone_is_utc)
+    {
+        // Only UTC can be written as text, but report the whole record so
+        // that callers can step over it.
+        record_length = ct_internal_timestamp_record_length(src, src_length);
+    }
+    if(bytes_read != NULL)
+    {
+        *bytes_read = record_length > 0 ? record_length : 0;
+    }
+    if(record_length <= 0)
+    {
+        return record_length;
+    }
+    if(!timezone_is_utc)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    return format_timestamp_fields(&date, hour, minute, second, nanosecond, dst, dst_length);
+}
@@ -0,0 +1,290 @@
+/*
+ * Compact Time
+ * ============
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "compact_time/sequence.h"
+#include "compact_time_internal.h"
+
+#include <vlq/vlq.h>
+
+#include <string.h>
+
+static const uint64_t HEADER_KEYFRAME = 1;
+static const unsigned SHIFT_DELTA_UNIT = 1;
+static const unsigned SHIFT_DELTA = 3;
+static const uint64_t MASK_DELTA_UNIT = 3;
+static const uint64_t MAX_ZIGZAG_DELTA = UINT64_MAX >> 3;
+
+// Nanoseconds per delta unit, indexed by unit
+static const int64_t g_delta_unit_ns[] = { 1000000000, 1000000, 1000, 1 };
+
+static uint64_t zigzag_encode_64(const int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t zigzag_decode_64(const uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static bool add_would_overflow(const int64_t a, const int64_t b)
+{
+    return (b > 0 && a > INT64_MAX - b) || (b < 0 && a < INT64_MIN - b);
+}
+
+static bool subtract_would_overflow(const int64_t a, const int64_t b)
+{
+    return (b > 0 && a < INT64_MIN + b) || (b < 0 && a > INT64_MAX + b);
+}
+
+static int get_delta_unit(const int64_t delta_ns)
+{
+    if(delta_ns % g_delta_unit_ns[0] == 0)
+    {
+        return 0;
+    }
+    if(delta_ns % g_delta_unit_ns[1] == 0)
+    {
+        return 1;
+    }
+    if(delta_ns % g_delta_unit_ns[2] == 0)
+    {
+        return 2;
+    }
+    return 3;
+}
+
+/**
+ * Get the RVLQ header for a delta from the encoder's previous record, or
+ * HEADER_KEYFRAME if the record must be written as a keyframe.
+ */
+static uint64_t get_delta_header(const ct_sequence_encoder* encoder,
+                                 const ct_timezone* timezone,
+                                 const bool has_wall_ns,
+                                 const int64_t wall_ns)
+{
+    const bool keyframe_is_due = encoder->keyframe_interval > 0 &&
+                                 encoder->records_since_keyframe >= encoder->keyframe_interval;
+    if(!has_wall_ns ||
+       !encoder->has_previous ||
+       keyframe_is_due ||
+       !ct_internal_timezones_are_equal(timezone, &encoder->previous_timezone) ||
+       subtract_would_overflow(wall_ns, encoder->previous_wall_ns))
+    {
+        return HEADER_KEYFRAME;
+    }
+
+    const int64_t delta_ns = wall_ns - encoder->previous_wall_ns;
+    const int unit = get_delta_unit(delta_ns);
+    const uint64_t zigzag_delta = zigzag_encode_64(delta_ns / g_delta_unit_ns[unit]);
+    if(zigzag_delta > MAX_ZIGZAG_DELTA)
+    {
+        return HEADER_KEYFRAME;
+    }
+    return (zigzag_delta << SHIFT_DELTA) | ((uint64_t)unit << SHIFT_DELTA_UNIT);
+}
+
+static int keyframe_decode(const uint8_t* src, int src_length, int offset, ct_timestamp* timestamp)
+{
+    const int byte_count = ct_timestamp_decode(src + offset, src_length - offset, timestamp);
+    if(byte_count == ERROR_OUT_OF_RANGE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(byte_count < 0)
+    {
+        return FAILURE_AT_POS(offset) + byte_count;
+    }
+    return offset + byte_count;
+}
+
+static int header_decode(const uint8_t* src, int src_length, uint64_t* header)
+{
+    if(src_length < 1)
+    {
+        return FAILURE_AT_POS(1);
+    }
+    *header = 0;
+    return rvlq_decode_64(header, src, src_length);
+}
+
+
+
+// ----------
+// Public API
+// ----------
+
+void ct_sequence_encoder_init(ct_sequence_encoder* encoder, int keyframe_interval)
+{
+    memset(encoder, 0, sizeof(*encoder));
+    encoder->keyframe_interval = keyframe_interval;
+}
+
+int ct_sequence_encoder_encode(ct_sequence_encoder* encoder,
+                               const ct_timestamp* timestamp,
+                               uint8_t* dst,
+                               int dst_length)
+{
+    int64_t wall_ns = 0;
+    const bool has_wall_ns = ct_internal_timestamp_to_wall_ns(timestamp, &wall_ns) == 0;
+    const uint64_t header = get_delta_header(encoder, &timestamp->time.timezone, has_wall_ns, wall_ns);
+
+    int offset = rvlq_encode_64(header, dst, dst_length);
+    if(offset <= 0)
+    {
+        return offset;
+    }
+
+    if(header == HEADER_KEYFRAME)
+    {
+        const int byte_count = ct_timestamp_encode(timestamp, dst + offset, dst_length - offset);
+        if(byte_count == ERROR_OUT_OF_RANGE)
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        if(byte_count < 0)
+        {
+            return FAILURE_AT_POS(offset) + byte_count;
+        }
+        offset += byte_count;
+        encoder->records_since_keyframe = 0;
+        encoder->previous_timezone = timestamp->time.timezone;
+    }
+
+    encoder->records_since_keyframe++;
+    encoder->has_previous = has_wall_ns;
+    encoder->previous_wall_ns = wall_ns;
+    return offset;
+}
+
+void ct_sequence_decoder_init(ct_sequence_decoder* decoder)
+{
+    memset(decoder, 0, sizeof(*decoder));
+}
+
+int ct_sequence_decoder_decode(ct_sequence_decoder* decoder,
+                               const uint8_t* src,
+                               int src_length,
+                               ct_timestamp* timestamp)
+{
+    uint64_t header = 0;
+    int offset = header_decode(src, src_length, &header);
+    if(offset < 1)
+    {
+        return offset;
+    }
+
+    if(header & HEADER_KEYFRAME)
+    {
+        if(header != HEADER_KEYFRAME)
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        offset = keyframe_decode(src, src_length, offset, timestamp);
+        if(offset < 0)
+        {
+            return offset;
+        }
+        decoder->has_previous = ct_internal_timestamp_to_wall_ns(timestamp, &decoder->previous_wall_ns) == 0;
+        decoder->previous_timezone = timestamp->time.timezone;
+        return offset;
+    }
+
+    if(!decoder->has_previous)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    const int64_t unit_ns = g_delta_unit_ns[(header >> SHIFT_DELTA_UNIT) & MASK_DELTA_UNIT];
+    const int64_t delta = zigzag_decode_64(header >> SHIFT_DELTA);
+    if(delta > INT64_MAX / unit_ns || delta < INT64_MIN / unit_ns ||
+       add_would_overflow(decoder->previous_wall_ns, delta * unit_ns))
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+
+    decoder->previous_wall_ns += delta * unit_ns;
+    ct_internal_timestamp_from_wall_ns(decoder->previous_wall_ns, timestamp);
+    timestamp->time.timezone = decoder->previous_timezone;
+    return offset;
+}
+
+int ct_sequence_seek_keyframe(const uint8_t* src,
+                              int src_length,
+                              int record_index,
+                              int* keyframe_record_index)
+{
+    int keyframe_offset = ERROR_OUT_OF_RANGE;
+    int offset = 0;
+    for(int index = 0; index <= record_index; index++)
+    {
+        if(offset >= src_length)
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+
+        // The keyframe flag is in the header's last (lowest) RVLQ group, so
+        // deltas can be skipped without decoding them.
+        int header_end = offset;
+        while(header_end < src_length && (src[header_end] & RVLQ_CONTINUATION_BIT))
+        {
+            header_end++;
+        }
+        if(header_end >= src_length)
+        {
+            return FAILURE_AT_POS(header_end + 1);
+        }
+        if(!(src[header_end] & HEADER_KEYFRAME))
+        {
+            offset = header_end + 1;
+            continue;
+        }
+
+        uint64_t header = 0;
+        const int header_length = header_decode(src + offset, src_length - offset, &header);
+        if(header_length < 1)
+        {
+            return FAILURE_AT_POS(offset) + header_length;
+        }
+        if(header != HEADER_KEYFRAME)
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+
+        keyframe_offset = offset;
+        *keyframe_record_index = index;
+        offset += header_length;
+        const int record_length = ct_internal_timestamp_record_length(src + offset, src_length - offset);
+        if(record_length < 0)
+        {
+            return FAILURE_AT_POS(offset) + record_length;
+        }
+        offset += record_length;
+    }
+    return keyframe_offset;
+}
@@ -0,0 +1,190 @@
+/*
+ * Compact Time
+ * ============
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "compact_time/statistics.h"
+#include "compact_time_internal.h"
+
+#include <string.h>
+
+#if COMPACT_TIME_STATISTICS
+
+#if !defined(__GNUC__)
+    #error "Statistics need the GCC/Clang __atomic builtins"
+#endif
+
+#include <stdlib.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+#ifdef __cplusplus
+    #define CT_THREAD_LOCAL thread_local
+#else
+    #define CT_THREAD_LOCAL _Thread_local
+#endif
+
+#define COUNTER_COUNT (sizeof(ct_statistics) / sizeof(uint64_t))
+
+// Blocks are only ever added to the list, never removed. A block is written
+// by the one thread that holds it, and read by anyone summing the totals.
+typedef struct counter_block
+{
+    uint64_t counters[COUNTER_COUNT];
+    struct counter_block* next;
+    int in_use;
+} counter_block;
+
+static counter_block* g_blocks = NULL;
+static CT_THREAD_LOCAL counter_block* t_block = NULL;
+
+// Runs when a thread that holds a block exits.
+static void release_block(void* block)
+{
+    __atomic_store_n(&((counter_block*)block)->in_use, 0, __ATOMIC_RELEASE);
+}
+
+#if defined(_WIN32)
+static DWORD g_release_index = FLS_OUT_OF_INDEXES;
+static INIT_ONCE g_release_index_once = INIT_ONCE_STATIC_INIT;
+
+// Fiber local storage is the only per-thread slot with a destructor.
+static VOID WINAPI release_fiber_block(PVOID block)
+{
+    if(block != NULL)
+    {
+        release_block(block);
+    }
+}
+
+static BOOL CALLBACK create_release_index(PINIT_ONCE once, PVOID parameter, PVOID* context)
+{
+    (void)once;
+    (void)parameter;
+    (void)context;
+    g_release_index = FlsAlloc(release_fiber_block);
+    return TRUE;
+}
+
+static void register_release(counter_block* block)
+{
+    InitOnceExecuteOnce(&g_release_index_once, create_release_index, NULL, NULL);
+    if(g_release_index != FLS_OUT_OF_INDEXES)
+    {
+        FlsSetValue(g_release_index, block);
+    }
+}
+#else
+static pthread_key_t g_release_key;
+static pthread_once_t g_release_key_once = PTHREAD_ONCE_INIT;
+
+static void create_release_key(void)
+{
+    pthread_key_create(&g_release_key, release_block);
+}
+
+static void register_release(counter_block* block)
+{
+    pthread_once(&g_release_key_once, create_release_key);
+    pthread_setspecific(g_release_key, block);
+}
+#endif
+
+static counter_block* claim_block(void)
+{
+    counter_block* block = __atomic_load_n(&g_blocks, __ATOMIC_ACQUIRE);
+    for(; block != NULL; block = block->next)
+    {
+        int expected = 0;
+        if(__atomic_compare_exchange_n(&block->in_use, &expected, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            return block;
+        }
+    }
+
+    block = (counter_block*)calloc(1, sizeof(*block));
+    if(block == NULL)
+    {
+        return NULL;
+    }
+    block->in_use = 1;
+    block->next = __atomic_load_n(&g_blocks, __ATOMIC_RELAXED);
+    while(!__atomic_compare_exchange_n(&g_blocks, &block->next, block, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+    {
+    }
+    return block;
+}
+
+uint64_t* ct_internal_statistics_counters(void)
+{
+    if(t_block == NULL)
+    {
+        t_block = claim_block();
+        if(t_block == NULL)
+        {
+            return NULL;
+        }
+        register_release(t_block);
+    }
+    return t_block->counters;
+}
+
+bool ct_statistics_enabled(void)
+{
+    return true;
+}
+
+void ct_statistics_get(ct_statistics* statistics)
+{
+    memset(statistics, 0, sizeof(*statistics));
+    uint64_t* totals = (uint64_t*)statistics;
+    for(const counter_block* block = __atomic_load_n(&g_blocks, __ATOMIC_ACQUIRE); block != NULL; block = block->next)
+    {
+        for(size_t i = 0; i < COUNTER_COUNT; i++)
+        {
+            totals[i] += __atomic_load_n(&block->counters[i], __ATOMIC_RELAXED);
+        }
+    }
+}
+
+#else
+
+bool ct_statistics_enabled(void)
+{
+    return false;
+}
+
+void ct_statistics_get(ct_statistics* statistics)
+{
+    memset(statistics, 0, sizeof(*statistics));
+}
+
+#endif // COMPACT_TIME_STATISTICS
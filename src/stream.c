@@ -0,0 +1,253 @@
+/*
+ * Compact Time
+ * ============
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "compact_time/stream.h"
+#include "compact_time_internal.h"
+
+#include <string.h>
+
+static int min_int(int a, int b)
+{
+    return a < b ? a : b;
+}
+
+static int drain_pending(ct_stream_encoder* encoder, uint8_t* dst, int dst_length)
+{
+    const int byte_count = min_int(encoder->pending_length, dst_length);
+    memcpy(dst, encoder->buffer + encoder->pending_offset, byte_count);
+    encoder->pending_offset += byte_count;
+    encoder->pending_length -= byte_count;
+    return byte_count;
+}
+
+/**
+ * Complete the record held in the decoder using bytes from the chunk. The
+ * record's structure is walked to size each top-up, and the record is only
+ * decoded once it is complete.
+ *
+ * Returns the number of chunk bytes consumed (all of them if the record is
+ * still incomplete), or ERROR_OUT_OF_RANGE.
+ */
+static int complete_buffered_record(ct_stream_decoder* decoder,
+                                    const uint8_t* chunk,
+                                    int chunk_length,
+                                    ct_timestamp* timestamp,
+                                    bool* is_complete)
+{
+    int consumed = 0;
+    int record_length = ct_internal_timestamp_record_length(decoder->buffer, decoder->buffered_length);
+    while(record_length < 0)
+    {
+        // The walk stops where the data runs out, which is a lower bound on
+        // the record's size.
+        const int needed = FAILURE_AT_POS(record_length);
+        if(needed > CT_STREAM_BUFFER_SIZE)
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        const int byte_count = min_int(needed - decoder->buffered_length, chunk_length - consumed);
+        if(byte_count == 0)
+        {
+            *is_complete = false;
+            return consumed;
+        }
+        memcpy(decoder->buffer + decoder->buffered_length, chunk + consumed, byte_count);
+        decoder->buffered_length += byte_count;
+        consumed += byte_count;
+        record_length = ct_internal_timestamp_record_length(decoder->buffer, decoder->buffered_length);
+    }
+
+    if(ct_timestamp_decode(decoder->buffer, record_length, timestamp) != record_length)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    // Give back any bytes the record turned out not to need.
+    consumed -= decoder->buffered_length - record_length;
+    decoder->buffered_length = 0;
+    *is_complete = true;
+    return consumed;
+}
+
+// Hold a partial record at the end of a chunk until the next one arrives.
+static int buffer_partial_record(ct_stream_decoder* decoder, const uint8_t* src, int src_length)
+{
+    if(src_length > CT_STREAM_BUFFER_SIZE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    memcpy(decoder->buffer, src, src_length);
+    decoder->buffered_length = src_length;
+    return src_length;
+}
+
+static int decode_chunk(ct_stream_decoder* decoder,
+                        const uint8_t* chunk,
+                        int chunk_length,
+                        ct_timestamp* timestamps,
+                        int max_timestamp_count,
+                        int* decoded_count)
+{
+    int consumed = 0;
+
+    if(decoder->buffered_length > 0 && max_timestamp_count > 0)
+    {
+        bool is_complete = false;
+        consumed = complete_buffered_record(decoder, chunk, chunk_length, &timestamps[0], &is_complete);
+        if(consumed < 0 || !is_complete)
+        {
+            return consumed;
+        }
+        (*decoded_count)++;
+    }
+
+    while(*decoded_count < max_timestamp_count && consumed < chunk_length)
+    {
+        const uint8_t* src = chunk + consumed;
+        const int remaining = chunk_length - consumed;
+        // Near the end of the chunk, walk the record's structure first so that
+        // a partial record is buffered without being decoded.
+        if(remaining < CT_TIMESTAMP_MAX_ENCODED_SIZE && ct_internal_timestamp_record_length(src, remaining) < 0)
+        {
+            const int result = buffer_partial_record(decoder, src, remaining);
+            return result < 0 ? result : chunk_length;
+        }
+        const int byte_count = ct_timestamp_decode(src, remaining, &timestamps[*decoded_count]);
+        if(byte_count == ERROR_OUT_OF_RANGE)
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        if(byte_count < 0)
+        {
+            // A record padded past the largest encoder output, cut off by the
+            // end of the chunk
+            const int result = buffer_partial_record(decoder, src, remaining);
+            return result < 0 ? result : chunk_length;
+        }
+        consumed += byte_count;
+        (*decoded_count)++;
+    }
+    return consumed;
+}
+
+static int encode_chunk(ct_stream_encoder* encoder,
+                        const ct_timestamp* timestamps,
+                        int timestamp_count,
+                        uint8_t* dst,
+                        int dst_length,
+                        int* encoded_count)
+{
+    int offset = drain_pending(encoder, dst, dst_length);
+
+    while(encoder->pending_length == 0 && *encoded_count < timestamp_count && offset < dst_length)
+    {
+        const ct_timestamp* timestamp = &timestamps[*encoded_count];
+        int byte_count = ct_timestamp_encode(timestamp, dst + offset, dst_length - offset);
+        if(byte_count == ERROR_OUT_OF_RANGE)
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        if(byte_count < 0)
+        {
+            // Doesn't fit: encode it on the side and write what we can.
+            byte_count = ct_timestamp_encode(timestamp, encoder->buffer, sizeof(encoder->buffer));
+            if(byte_count < 0)
+            {
+                return ERROR_OUT_OF_RANGE;
+            }
+            encoder->pending_offset = 0;
+            encoder->pending_length = byte_count;
+            offset += drain_pending(encoder, dst + offset, dst_length - offset);
+        }
+        else
+        {
+            offset += byte_count;
+        }
+        (*encoded_count)++;
+    }
+    return offset;
+}
+
+
+
+// ----------
+// Public API
+// ----------
+
+void ct_stream_decoder_init(ct_stream_decoder* decoder)
+{
+    decoder->buffered_length = 0;
+}
+
+int ct_stream_decoder_feed(ct_stream_decoder* decoder,
+                           const uint8_t* chunk,
+                           int chunk_length,
+                           ct_timestamp* timestamps,
+                           int max_timestamp_count,
+                           int* records_processed)
+{
+    int decoded_count = 0;
+    const int result = decode_chunk(decoder, chunk, chunk_length, timestamps, max_timestamp_count, &decoded_count);
+    if(records_processed != NULL)
+    {
+        *records_processed = decoded_count;
+    }
+    return result;
+}
+
+bool ct_stream_decoder_is_mid_record(const ct_stream_decoder* decoder)
+{
+    return decoder->buffered_length > 0;
+}
+
+void ct_stream_encoder_init(ct_stream_encoder* encoder)
+{
+    encoder->pending_offset = 0;
+    encoder->pending_length = 0;
+}
+
+int ct_stream_encoder_encode(ct_stream_encoder* encoder,
+                             const ct_timestamp* timestamps,
+                             int timestamp_count,
+                             uint8_t* dst,
+                             int dst_length,
+                             int* records_processed)
+{
+    int encoded_count = 0;
+    const int result = encode_chunk(encoder, timestamps, timestamp_count, dst, dst_length, &encoded_count);
+    if(records_processed != NULL)
+    {
+        *records_processed = encoded_count;
+    }
+    return result;
+}
+
+int ct_stream_encoder_flush(ct_stream_encoder* encoder, uint8_t* dst, int dst_length)
+{
+    return drain_pending(encoder, dst, dst_length);
+}
@@ -0,0 +1,356 @@
+/*
+ * Compact Time
+ * ============
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "compact_time/stream_index.h"
+#include "compact_time_internal.h"
+
+#include <endianness/endianness.h>
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int INITIAL_OFFSET_CAPACITY = 64;
+
+static const int OFFSET_WIDTH_32 = 4;
+static const int OFFSET_WIDTH_64 = 8;
+
+static const int OFFSET_HEADER_INTERVAL = 0;
+static const int OFFSET_HEADER_WIDTH = 4;
+static const int OFFSET_HEADER_RECORD_COUNT = 8;
+static const int OFFSET_HEADER_STREAM_LENGTH = 16;
+
+static int get_offset_width(int64_t stream_length)
+{
+    return stream_length <= UINT32_MAX ? OFFSET_WIDTH_32 : OFFSET_WIDTH_64;
+}
+
+static int64_t read_offset(const ct_stream_index* index, int64_t offset_index)
+{
+    const uint8_t* src = index->offsets + offset_index * index->offset_width;
+    if(index->offset_width == OFFSET_WIDTH_32)
+    {
+        return read_uint32_le(src);
+    }
+    return (int64_t)read_uint64_le(src);
+}
+
+// Offsets come from the index data, and a corrupt 8-byte offset reads back
+// as negative, so compare as unsigned.
+static bool is_in_stream(const ct_stream_index* index, int64_t offset)
+{
+    return (uint64_t)offset < (uint64_t)index->stream_length;
+}
+
+// Records are tiny, so a view of the stream never needs more than INT_MAX bytes.
+static int get_remaining_length(const ct_stream_index* index, int64_t offset)
+{
+    const int64_t remaining = index->stream_length - offset;
+    return remaining > INT_MAX ? INT_MAX : (int)remaining;
+}
+
+static int decode_at(const ct_stream_index* index, int64_t offset, ct_timestamp* timestamp)
+{
+    const int byte_count = ct_timestamp_decode(index->stream + offset, get_remaining_length(index, offset), timestamp);
+    return byte_count > 0 ? byte_count : ERROR_OUT_OF_RANGE;
+}
+
+static int compare_date_time(const ct_timestamp* a, const ct_timestamp* b)
+{
+    if(a->date.year != b->date.year)
+    {
+        return a->date.year < b->date.year ? -1 : 1;
+    }
+    if(a->date.month != b->date.month)
+    {
+        return a->date.month < b->date.month ? -1 : 1;
+    }
+    if(a->date.day != b->date.day)
+    {
+        return a->date.day < b->date.day ? -1 : 1;
+    }
+    if(a->time.hour != b->time.hour)
+    {
+        return a->time.hour < b->time.hour ? -1 : 1;
+    }
+    if(a->time.minute != b->time.minute)
+    {
+        return a->time.minute < b->time.minute ? -1 : 1;
+    }
+    if(a->time.second != b->time.second)
+    {
+        return a->time.second < b->time.second ? -1 : 1;
+    }
+    if(a->time.nanosecond != b->time.nanosecond)
+    {
+        return a->time.nanosecond < b->time.nanosecond ? -1 : 1;
+    }
+    return 0;
+}
+
+
+
+// ----------
+// Public API
+// ----------
+
+bool ct_stream_index_builder_init(ct_stream_index_builder* builder, int interval)
+{
+    memset(builder, 0, sizeof(*builder));
+    if(interval < 1)
+    {
+        return false;
+    }
+    builder->interval = interval;
+    builder->offsets = malloc(sizeof(*builder->offsets) * INITIAL_OFFSET_CAPACITY);
+    if(builder->offsets == NULL)
+    {
+        return false;
+    }
+    builder->offset_capacity = INITIAL_OFFSET_CAPACITY;
+    return true;
+}
+
+void ct_stream_index_builder_free(ct_stream_index_builder* builder)
+{
+    free(builder->offsets);
+    memset(builder, 0, sizeof(*builder));
+}
+
+bool ct_stream_index_builder_add(ct_stream_index_builder* builder, int record_length)
+{
+    if(builder->record_count % builder->interval == 0)
+    {
+        if(builder->offset_count >= builder->offset_capacity)
+        {
+            const int64_t new_capacity = builder->offset_capacity * 2;
+            int64_t* offsets = realloc(builder->offsets, sizeof(*offsets) * new_capacity);
+            if(offsets == NULL)
+            {
+                return false;
+            }
+            builder->offsets = offsets;
+            builder->offset_capacity = new_capacity;
+        }
+        builder->offsets[builder->offset_count++] = builder->stream_length;
+    }
+    builder->record_count++;
+    builder->stream_length += record_length;
+    return true;
+}
+
+int ct_stream_index_builder_scan(ct_stream_index_builder* builder, const uint8_t* chunk, int chunk_length)
+{
+    int offset = 0;
+    while(offset < chunk_length)
+    {
+        const int record_length = ct_internal_timestamp_record_length(chunk + offset, chunk_length - offset);
+        if(record_length < 0)
+        {
+            break;
+        }
+        if(!ct_stream_index_builder_add(builder, record_length))
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        offset += record_length;
+    }
+    return offset;
+}
+
+int64_t ct_stream_index_serialized_size(const ct_stream_index_builder* builder)
+{
+    return CT_STREAM_INDEX_HEADER_SIZE + builder->offset_count * get_offset_width(builder->stream_length);
+}
+
+int64_t ct_stream_index_serialize(const ct_stream_index_builder* builder, uint8_t* dst, int64_t dst_length)
+{
+    const int64_t size = ct_stream_index_serialized_size(builder);
+    if(size > dst_length)
+    {
+        return FAILURE_AT_POS(size);
+    }
+
+    const int offset_width = get_offset_width(builder->stream_length);
+    memset(dst, 0, CT_STREAM_INDEX_HEADER_SIZE);
+    write_uint32_le(builder->interval, dst + OFFSET_HEADER_INTERVAL);
+    dst[OFFSET_HEADER_WIDTH] = offset_width;
+    write_uint64_le(builder->record_count, dst + OFFSET_HEADER_RECORD_COUNT);
+    write_uint64_le(builder->stream_length, dst + OFFSET_HEADER_STREAM_LENGTH);
+
+    uint8_t* offsets = dst + CT_STREAM_INDEX_HEADER_SIZE;
+    for(int64_t i = 0; i < builder->offset_count; i++)
+    {
+        if(offset_width == OFFSET_WIDTH_32)
+        {
+            write_uint32_le(builder->offsets[i], offsets + i * offset_width);
+        }
+        else
+        {
+            write_uint64_le(builder->offsets[i], offsets + i * offset_width);
+        }
+    }
+    return size;
+}
+
+int ct_stream_index_open(ct_stream_index* index,
+                         const uint8_t* index_data,
+                         int64_t index_length,
+                         const uint8_t* stream,
+                         int64_t stream_length)
+{
+    memset(index, 0, sizeof(*index));
+    if(index_length < CT_STREAM_INDEX_HEADER_SIZE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+
+    const uint32_t interval = read_uint32_le(index_data + OFFSET_HEADER_INTERVAL);
+    const int offset_width = index_data[OFFSET_HEADER_WIDTH];
+    const uint64_t record_count = read_uint64_le(index_data + OFFSET_HEADER_RECORD_COUNT);
+    const uint64_t indexed_stream_length = read_uint64_le(index_data + OFFSET_HEADER_STREAM_LENGTH);
+    if(interval < 1 || interval > INT_MAX ||
+       offset_width != get_offset_width(stream_length) ||
+       indexed_stream_length != (uint64_t)stream_length ||
+       record_count > (uint64_t)stream_length)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+
+    const int64_t offset_count = (record_count + interval - 1) / interval;
+    if(offset_count > (index_length - CT_STREAM_INDEX_HEADER_SIZE) / offset_width)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+
+    index->offsets = index_data + CT_STREAM_INDEX_HEADER_SIZE;
+    index->offset_width = offset_width;
+    index->interval = interval;
+    index->record_count = record_count;
+    index->offset_count = offset_count;
+    index->stream = stream;
+    index->stream_length = stream_length;
+    return 0;
+}
+
+int64_t ct_stream_index_record_count(const ct_stream_index* index)
+{
+    return index->record_count;
+}
+
+int64_t ct_stream_seek(const ct_stream_index* index, int64_t record_index, ct_timestamp* timestamp)
+{
+    if(record_index < 0 || record_index >= index->record_count)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+
+    int64_t offset = read_offset(index, record_index / index->interval);
+    for(int64_t skip_count = record_index % index->interval; skip_count > 0; skip_count--)
+    {
+        if(!is_in_stream(index, offset))
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        const int record_length = ct_internal_timestamp_record_length(index->stream + offset,
+                                                                      get_remaining_length(index, offset));
+        if(record_length < 0)
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        offset += record_length;
+    }
+    if(!is_in_stream(index, offset))
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+
+    if(timestamp != NULL && decode_at(index, offset, timestamp) < 0)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    return offset;
+}
+
+int64_t ct_stream_find(const ct_stream_index* index, const ct_timestamp* timestamp)
+{
+    ct_timestamp record;
+
+    // Find the first indexed record at or after the target.
+    int64_t low = 0;
+    int64_t high = index->offset_count;
+    while(low < high)
+    {
+        const int64_t middle = low + (high - low) / 2;
+        const int64_t offset = read_offset(index, middle);
+        if(!is_in_stream(index, offset) || decode_at(index, offset, &record) < 0)
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        if(compare_date_time(&record, timestamp) < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    if(low == 0)
+    {
+        return 0;
+    }
+
+    // The target is in the block before it, or is the indexed record itself.
+    int64_t record_index = (low - 1) * index->interval;
+    int64_t end_index = low * index->interval;
+    if(end_index > index->record_count)
+    {
+        end_index = index->record_count;
+    }
+    int64_t offset = read_offset(index, low - 1);
+    for(; record_index < end_index; record_index++)
+    {
+        if(!is_in_stream(index, offset))
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        const int byte_count = decode_at(index, offset, &record);
+        if(byte_count < 0)
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        if(compare_date_time(&record, timestamp) >= 0)
+        {
+            return record_index;
+        }
+        offset += byte_count;
+    }
+    return end_index;
+}
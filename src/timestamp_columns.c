@@ -0,0 +1,309 @@
+/*
+ * Compact Time
+ * ============
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "compact_time/timestamp_columns.h"
+#include "compact_time_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const int MAX_TIMEZONE_COUNT = UINT16_MAX + 1;
+static const int INITIAL_TIMEZONE_CAPACITY = 16;
+
+static int find_or_add_timezone(ct_timestamp_columns* columns, const ct_timezone* timezone)
+{
+    if(timezone->type == CT_TZ_ZERO)
+    {
+        return CT_TIMEZONE_INDEX_UTC;
+    }
+
+    // Feeds tend to repeat the same zone, with only UTC rows in between.
+    if(ct_internal_timezones_are_equal(&columns->timezones[columns->last_timezone_index], timezone))
+    {
+        return columns->last_timezone_index;
+    }
+    for(int i = CT_TIMEZONE_INDEX_UTC + 1; i < columns->timezone_count; i++)
+    {
+        if(ct_internal_timezones_are_equal(&columns->timezones[i], timezone))
+        {
+            columns->last_timezone_index = i;
+            return i;
+        }
+    }
+
+    if(columns->timezone_count >= MAX_TIMEZONE_COUNT)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(columns->timezone_count >= columns->timezone_capacity)
+    {
+        const int new_capacity = columns->timezone_capacity * 2;
+        ct_timezone* timezones = realloc(columns->timezones, sizeof(*timezones) * new_capacity);
+        if(timezones == NULL)
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        columns->timezones = timezones;
+        columns->timezone_capacity = new_capacity;
+    }
+
+    const int index = columns->timezone_count++;
+    columns->timezones[index] = *timezone;
+    columns->last_timezone_index = index;
+    return index;
+}
+
+static ct_timestamp_fields get_fields_from_row(const ct_timestamp_columns* columns, int row)
+{
+    ct_timestamp_fields fields =
+    {
+        .year = columns->fields.year + row,
+        .month = columns->fields.month + row,
+        .day = columns->fields.day + row,
+        .hour = columns->fields.hour + row,
+        .minute = columns->fields.minute + row,
+        .second = columns->fields.second + row,
+        .nanosecond = columns->fields.nanosecond + row,
+    };
+    return fields;
+}
+
+
+
+// ----------
+// Public API
+// ----------
+
+bool ct_timestamp_columns_init(ct_timestamp_columns* columns, int row_capacity)
+{
+    memset(columns, 0, sizeof(*columns));
+    columns->row_capacity = row_capacity;
+    columns->fields.year = malloc(sizeof(*columns->fields.year) * row_capacity);
+    columns->fields.month = malloc(sizeof(*columns->fields.month) * row_capacity);
+    columns->fields.day = malloc(sizeof(*columns->fields.day) * row_capacity);
+    columns->fields.hour = malloc(sizeof(*columns->fields.hour) * row_capacity);
+    columns->fields.minute = malloc(sizeof(*columns->fields.minute) * row_capacity);
+    columns->fields.second = malloc(sizeof(*columns->fields.second) * row_capacity);
+    columns->fields.nanosecond = malloc(sizeof(*columns->fields.nanosecond) * row_capacity);
+    columns->timezone_index = malloc(sizeof(*columns->timezone_index) * row_capacity);
+    columns->timezone_capacity = INITIAL_TIMEZONE_CAPACITY;
+    columns->timezones = malloc(sizeof(*columns->timezones) * columns->timezone_capacity);
+
+    if(columns->fields.year == NULL ||
+       columns->fields.month == NULL ||
+       columns->fields.day == NULL ||
+       columns->fields.hour == NULL ||
+       columns->fields.minute == NULL ||
+       columns->fields.second == NULL ||
+       columns->fields.nanosecond == NULL ||
+       columns->timezone_index == NULL ||
+       columns->timezones == NULL)
+    {
+        ct_timestamp_columns_free(columns);
+        return false;
+    }
+
+    ct_timestamp_columns_clear(columns);
+    return true;
+}
+
+void ct_timestamp_columns_free(ct_timestamp_columns* columns)
+{
+    free(columns->fields.year);
+    free(columns->fields.month);
+    free(columns->fields.day);
+    free(columns->fields.hour);
+    free(columns->fields.minute);
+    free(columns->fields.second);
+    free(columns->fields.nanosecond);
+    free(columns->timezone_index);
+    free(columns->timezones);
+    memset(columns, 0, sizeof(*columns));
+}
+
+void ct_timestamp_columns_clear(ct_timestamp_columns* columns)
+{
+    columns->row_count = 0;
+    memset(&columns->timezones[CT_TIMEZONE_INDEX_UTC], 0, sizeof(columns->timezones[0]));
+    columns->timezones[CT_TIMEZONE_INDEX_UTC].type = CT_TZ_ZERO;
+    columns->timezone_count = CT_TIMEZONE_INDEX_UTC + 1;
+    columns->last_timezone_index = CT_TIMEZONE_INDEX_UTC;
+}
+
+int ct_timestamp_columns_append(ct_timestamp_columns* columns, const ct_timestamp* timestamp)
+{
+    if(columns->row_count >= columns->row_capacity)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    const int timezone_index = find_or_add_timezone(columns, &timestamp->time.timezone);
+    if(timezone_index < 0)
+    {
+        return timezone_index;
+    }
+
+    const int row = columns->row_count++;
+    columns->fields.year[row] = timestamp->date.year;
+    columns->fields.month[row] = timestamp->date.month;
+    columns->fields.day[row] = timestamp->date.day;
+    columns->fields.hour[row] = timestamp->time.hour;
+    columns->fields.minute[row] = timestamp->time.minute;
+    columns->fields.second[row] = timestamp->time.second;
+    columns->fields.nanosecond[row] = timestamp->time.nanosecond;
+    columns->timezone_index[row] = timezone_index;
+    return row;
+}
+
+void ct_timestamp_columns_get(const ct_timestamp_columns* columns, int row, ct_timestamp* timestamp)
+{
+    timestamp->date.year = columns->fields.year[row];
+    timestamp->date.month = columns->fields.month[row];
+    timestamp->date.day = columns->fields.day[row];
+    timestamp->time.hour = columns->fields.hour[row];
+    timestamp->time.minute = columns->fields.minute[row];
+    timestamp->time.second = columns->fields.second[row];
+    timestamp->time.nanosecond = columns->fields.nanosecond[row];
+    timestamp->time.timezone = columns->timezones[columns->timezone_index[row]];
+}
+
+int ct_timestamp_decode_columns(const uint8_t* src,
+                                int src_length,
+                                ct_timestamp_columns* columns,
+                                int* records_processed)
+{
+    const int first_row = columns->row_count;
+    int offset = 0;
+    int result = 0;
+
+    while(offset < src_length && columns->row_count < columns->row_capacity)
+    {
+        const ct_timestamp_fields fields = get_fields_from_row(columns, columns->row_count);
+        int run_count = 0;
+        const int run_byte_count = ct_timestamp_decode_utc_run(src + offset,
+                                                               src_length - offset,
+                                                               &fields,
+                                                               columns->row_capacity - columns->row_count,
+                                                               &run_count);
+        memset(columns->timezone_index + columns->row_count, 0, sizeof(*columns->timezone_index) * run_count);
+        columns->row_count += run_count;
+        if(run_byte_count < 0)
+        {
+            result = FAILURE_AT_POS(offset) + run_byte_count;
+            break;
+        }
+        offset += run_byte_count;
+        result = offset;
+        if(offset >= src_length || columns->row_count >= columns->row_capacity)
+        {
+            break;
+        }
+
+        // The run stopped at a record with a non-UTC timezone.
+        ct_timestamp timestamp;
+        const int byte_count = ct_timestamp_decode(src + offset, src_length - offset, &timestamp);
+        if(byte_count == ERROR_OUT_OF_RANGE)
+        {
+            result = ERROR_OUT_OF_RANGE;
+            break;
+        }
+        if(byte_count < 0)
+        {
+            result = FAILURE_AT_POS(offset) + byte_count;
+            break;
+        }
+        const int row = ct_timestamp_columns_append(columns, &timestamp);
+        if(row < 0)
+        {
+            result = row;
+            break;
+        }
+        offset += byte_count;
+        result = offset;
+    }
+
+    if(records_processed != NULL)
+    {
+        *records_processed = columns->row_count - first_row;
+    }
+    return result;
+}
+
+int ct_timestamp_encode_columns(const ct_timestamp_columns* columns,
+                                int first_row,
+                                int row_count,
+                                uint8_t* dst,
+                                int dst_length,
+                                int* records_processed)
+{
+    ct_timestamp timestamp;
+    memset(&timestamp, 0, sizeof(timestamp));
+    int previous_timezone_index = CT_TIMEZONE_INDEX_UTC;
+    timestamp.time.timezone.type = CT_TZ_ZERO;
+
+    int offset = 0;
+    int result = 0;
+    int encoded_count = 0;
+    for(; encoded_count < row_count; encoded_count++)
+    {
+        const int row = first_row + encoded_count;
+        timestamp.date.year = columns->fields.year[row];
+        timestamp.date.month = columns->fields.month[row];
+        timestamp.date.day = columns->fields.day[row];
+        timestamp.time.hour = columns->fields.hour[row];
+        timestamp.time.minute = columns->fields.minute[row];
+        timestamp.time.second = columns->fields.second[row];
+        timestamp.time.nanosecond = columns->fields.nanosecond[row];
+        // Only copy the timezone out of the dictionary when it changes.
+        if(columns->timezone_index[row] != previous_timezone_index)
+        {
+            previous_timezone_index = columns->timezone_index[row];
+            timestamp.time.timezone = columns->timezones[previous_timezone_index];
+        }
+
+        const int byte_count = ct_timestamp_encode(&timestamp, dst + offset, dst_length - offset);
+        if(byte_count == ERROR_OUT_OF_RANGE)
+        {
+            result = ERROR_OUT_OF_RANGE;
+            break;
+        }
+        if(byte_count < 0)
+        {
+            result = FAILURE_AT_POS(offset) + byte_count;
+            break;
+        }
+        offset += byte_count;
+        result = offset;
+    }
+
+    if(records_processed != NULL)
+    {
+        *records_processed = encoded_count;
+    }
+    return result;
+}
@@ -0,0 +1,298 @@
+/*
+ * Compact Time
+ * ============
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "compact_time/timestamp_compare.h"
+#include "compact_time_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Everything but the nanosecond, most significant first:
+// year (sign flipped) | month | day | hour | minute | second
+#define SHIFT_SORT_SECOND 0
+#define SHIFT_SORT_MINUTE (SHIFT_SORT_SECOND + SIZE_SECOND)
+#define SHIFT_SORT_HOUR   (SHIFT_SORT_MINUTE + SIZE_MINUTE)
+#define SHIFT_SORT_DAY    (SHIFT_SORT_HOUR + SIZE_HOUR)
+#define SHIFT_SORT_MONTH  (SHIFT_SORT_DAY + SIZE_DAY)
+#define SHIFT_SORT_YEAR   (SHIFT_SORT_MONTH + SIZE_MONTH)
+
+static const uint32_t FLIP_SIGN_32 = 0x80000000u;
+
+// One radix pass per byte of the nanosecond and the other fields.
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)
+#define NANOSECOND_DIGIT_COUNT 4
+#define FIELDS_DIGIT_COUNT 8
+#define DIGIT_COUNT (NANOSECOND_DIGIT_COUNT + FIELDS_DIGIT_COUNT)
+
+typedef struct
+{
+    uint64_t fields;
+    uint32_t nanosecond;
+    // Relative to the start of the record
+    int timezone_offset;
+    int timezone_length;
+    int record_offset;
+} sort_key;
+
+// Read the ordering fields of a record. Returns the record length or an error.
+static int read_sort_key(const uint8_t* src, int src_length, sort_key* key)
+{
+    ct_date date;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    bool timezone_is_utc;
+    const int base_length = ct_internal_timestamp_base_decode(src, src_length, &date, &hour, &minute, &second,
+                                                              &key->nanosecond, &timezone_is_utc);
+    if(base_length < 0)
+    {
+        return base_length;
+    }
+    const int record_length = timezone_is_utc ? base_length : ct_internal_timestamp_record_length(src, src_length);
+    if(record_length < 0)
+    {
+        return record_length;
+    }
+
+    key->fields = ((uint64_t)((uint32_t)date.year ^ FLIP_SIGN_32) << SHIFT_SORT_YEAR) |
+                  ((uint64_t)date.month << SHIFT_SORT_MONTH) |
+                  ((uint64_t)date.day << SHIFT_SORT_DAY) |
+                  ((uint64_t)hour << SHIFT_SORT_HOUR) |
+                  ((uint64_t)minute << SHIFT_SORT_MINUTE) |
+                  ((uint64_t)second << SHIFT_SORT_SECOND);
+    key->timezone_offset = base_length;
+    key->timezone_length = record_length - base_length;
+    return record_length;
+}
+
+static int compare_values(const uint64_t a, const uint64_t b)
+{
+    return (a > b) - (a < b);
+}
+
+// UTC (no timezone bytes) sorts first, then by the raw timezone bytes.
+static int compare_timezones(const uint8_t* a, int a_length, const uint8_t* b, int b_length)
+{
+    const int common_length = a_length < b_length ? a_length : b_length;
+    const int result = common_length > 0 ? memcmp(a, b, common_length) : 0;
+    return result != 0 ? result : compare_values(a_length, b_length);
+}
+
+static int compare_sort_keys(const uint8_t* a, const sort_key* a_key, const uint8_t* b, const sort_key* b_key)
+{
+    if(a_key->fields != b_key->fields)
+    {
+        return compare_values(a_key->fields, b_key->fields);
+    }
+    if(a_key->nanosecond != b_key->nanosecond)
+    {
+        return compare_values(a_key->nanosecond, b_key->nanosecond);
+    }
+    return compare_timezones(a + a_key->timezone_offset, a_key->timezone_length,
+                             b + b_key->timezone_offset, b_key->timezone_length);
+}
+
+int ct_timestamp_compare_encoded(const uint8_t* a, int a_length, const uint8_t* b, int b_length)
+{
+    sort_key a_key;
+    sort_key b_key;
+    const bool a_is_valid = read_sort_key(a, a_length, &a_key) > 0;
+    const bool b_is_valid = read_sort_key(b, b_length, &b_key) > 0;
+    if(!a_is_valid || !b_is_valid)
+    {
+        return (int)b_is_valid - (int)a_is_valid;
+    }
+    return compare_sort_keys(a, &a_key, b, &b_key);
+}
+
+static unsigned get_digit(const sort_key* key, int digit)
+{
+    if(digit < NANOSECOND_DIGIT_COUNT)
+    {
+        return (key->nanosecond >> (digit * RADIX_BITS)) & (RADIX_SIZE - 1);
+    }
+    return (key->fields >> ((digit - NANOSECOND_DIGIT_COUNT) * RADIX_BITS)) & (RADIX_SIZE - 1);
+}
+
+// LSD radix sort, skipping digits that are the same in every key (such as
+// the year bytes of timestamps from the same era). Returns the sorted array,
+// which is either keys or scratch.
+static sort_key* radix_sort(sort_key* keys, sort_key* scratch, int count)
+{
+    int histograms[DIGIT_COUNT][RADIX_SIZE];
+    memset(histograms, 0, sizeof(histograms));
+    for(int i = 0; i < count; i++)
+    {
+        for(int digit = 0; digit < DIGIT_COUNT; digit++)
+        {
+            histograms[digit][get_digit(&keys[i], digit)]++;
+        }
+    }
+
+    for(int digit = 0; digit < DIGIT_COUNT; digit++)
+    {
+        int* histogram = histograms[digit];
+        if(histogram[get_digit(&keys[0], digit)] == count)
+        {
+            continue;
+        }
+        int position = 0;
+        for(int bucket = 0; bucket < RADIX_SIZE; bucket++)
+        {
+            const int bucket_count = histogram[bucket];
+            histogram[bucket] = position;
+            position += bucket_count;
+        }
+        for(int i = 0; i < count; i++)
+        {
+            scratch[histogram[get_digit(&keys[i], digit)]++] = keys[i];
+        }
+        sort_key* swap = keys;
+        keys = scratch;
+        scratch = swap;
+    }
+    return keys;
+}
+
+static bool key_fields_are_equal(const sort_key* a, const sort_key* b)
+{
+    return a->fields == b->fields && a->nanosecond == b->nanosecond;
+}
+
+static int compare_key_timezones(const uint8_t* src, const sort_key* a, const sort_key* b)
+{
+    return compare_timezones(src + a->record_offset + a->timezone_offset, a->timezone_length,
+                             src + b->record_offset + b->timezone_offset, b->timezone_length);
+}
+
+// Stable bottom-up merge sort by timezone. scratch must hold count keys.
+static void merge_sort_timezones(const uint8_t* src, sort_key* keys, sort_key* scratch, int count)
+{
+    sort_key* from = keys;
+    sort_key* to = scratch;
+    for(int width = 1; width < count; width = width > count / 2 ? count : width * 2)
+    {
+        for(int start = 0; start < count;)
+        {
+            const int middle = width < count - start ? start + width : count;
+            const int end = width < count - middle ? middle + width : count;
+            int left = start;
+            int right = middle;
+            int out = start;
+            while(left < middle && right < end)
+            {
+                // Take from the left on ties to keep the sort stable.
+                to[out++] = compare_key_timezones(src, &from[right], &from[left]) < 0 ? from[right++] : from[left++];
+            }
+            while(left < middle)
+            {
+                to[out++] = from[left++];
+            }
+            while(right < end)
+            {
+                to[out++] = from[right++];
+            }
+            start = end;
+        }
+        sort_key* swap = from;
+        from = to;
+        to = swap;
+    }
+    if(from != keys)
+    {
+        memcpy(keys, from, sizeof(*keys) * count);
+    }
+}
+
+// The radix sort leaves records with the same fields in their original order.
+// Such runs can be long (for example the same instant in many timezones), so
+// sort each one by timezone in O(k log k), skipping runs already in order
+// (such as all-UTC runs).
+static void sort_equal_fields(const uint8_t* src, sort_key* keys, sort_key* scratch, int count)
+{
+    int run_start = 0;
+    bool run_is_sorted = true;
+    for(int i = 1; i <= count; i++)
+    {
+        if(i < count && key_fields_are_equal(&keys[run_start], &keys[i]))
+        {
+            run_is_sorted = run_is_sorted && compare_key_timezones(src, &keys[i - 1], &keys[i]) <= 0;
+            continue;
+        }
+        if(!run_is_sorted)
+        {
+            merge_sort_timezones(src, keys + run_start, scratch, i - run_start);
+        }
+        run_start = i;
+        run_is_sorted = true;
+    }
+}
+
+int ct_timestamp_sort_encoded(const uint8_t* src,
+                              int src_length,
+                              int* record_offsets,
+                              int record_count)
+{
+    if(record_count < 2)
+    {
+        return 0;
+    }
+
+    sort_key* keys = (sort_key*)malloc(sizeof(*keys) * record_count * 2);
+    if(keys == NULL)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    for(int i = 0; i < record_count; i++)
+    {
+        const int offset = record_offsets[i];
+        if(offset < 0 || offset >= src_length)
+        {
+            free(keys);
+            return ERROR_OUT_OF_RANGE;
+        }
+        const int result = read_sort_key(src + offset, src_length - offset, &keys[i]);
+        if(result < 0)
+        {
+            free(keys);
+            return result == ERROR_OUT_OF_RANGE ? result : FAILURE_AT_POS(offset) + result;
+        }
+        keys[i].record_offset = offset;
+    }
+
+    sort_key* sorted = radix_sort(keys, keys + record_count, record_count);
+    sort_equal_fields(src, sorted, sorted == keys ? keys + record_count : keys, record_count);
+    for(int i = 0; i < record_count; i++)
+    {
+        record_offsets[i] = sorted[i].record_offset;
+    }
+    free(keys);
+    return 0;
+}
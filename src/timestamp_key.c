@@ -0,0 +1,254 @@
+/*
+ * Compact Time
+ * ============
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "compact_time/timestamp_key.h"
+#include "compact_time_internal.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#define SIZE_NANOSECOND 30
+
+static const uint32_t NANOSECONDS_PER_SECOND = 1000000000;
+static const uint32_t FLIP_SIGN_32 = 0x80000000u;
+static const uint16_t FLIP_SIGN_16 = 0x8000u;
+
+// Year (4 bytes), then the other fields packed into 7 bytes, then the
+// timezone type.
+static const int KEY_YEAR_SIZE = 4;
+static const int KEY_FIELDS_SIZE = 7;
+static const int KEY_TIMEZONE_TYPE_OFFSET = 11;
+static const int KEY_LATLONG_SIZE = 4;
+
+static void write_uint_be(uint64_t value, int byte_count, uint8_t* dst)
+{
+    for(int i = byte_count - 1; i >= 0; i--)
+    {
+        dst[i] = (uint8_t)value;
+        value >>= 8;
+    }
+}
+
+static uint64_t read_uint_be(const uint8_t* src, int byte_count)
+{
+    uint64_t value = 0;
+    for(int i = 0; i < byte_count; i++)
+    {
+        value = (value << 8) | src[i];
+    }
+    return value;
+}
+
+static bool is_latlong_in_range(const ct_timezone* timezone)
+{
+    return timezone->latitude >= MIN_LATITUDE && timezone->latitude <= MAX_LATITUDE &&
+           timezone->longitude >= MIN_LONGITUDE && timezone->longitude <= MAX_LONGITUDE;
+}
+
+int ct_timestamp_key_size(const ct_timestamp* timestamp)
+{
+    switch(timestamp->time.timezone.type)
+    {
+        case CT_TZ_STRING:
+        {
+            int name_length = 0;
+            ct_internal_timezone_name_scan(timestamp->time.timezone.as_string, &name_length);
+            return CT_TIMESTAMP_KEY_MIN_SIZE + name_length + 1;
+        }
+        case CT_TZ_LATLONG:
+            return CT_TIMESTAMP_KEY_MIN_SIZE + KEY_LATLONG_SIZE;
+        default:
+            return CT_TIMESTAMP_KEY_MIN_SIZE;
+    }
+}
+
+int ct_timestamp_key_encode(const ct_timestamp* timestamp, uint8_t* dst, int dst_length)
+{
+    const ct_date* date = &timestamp->date;
+    const ct_time* time = &timestamp->time;
+    if(date->month > MASK_MONTH || date->day > MASK_DAY ||
+       time->hour > MASK_HOUR || time->minute > MASK_MINUTE || time->second > MASK_SECOND ||
+       time->nanosecond >= NANOSECONDS_PER_SECOND)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+
+    const ct_timezone* timezone = &time->timezone;
+    int name_length = 0;
+    if(timezone->type == CT_TZ_STRING && ct_internal_timezone_name_scan(timezone->as_string, &name_length) < 0)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    else if(timezone->type == CT_TZ_LATLONG && !is_latlong_in_range(timezone))
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+
+    const int key_size = ct_timestamp_key_size(timestamp);
+    if(key_size > dst_length)
+    {
+        return FAILURE_AT_POS(key_size);
+    }
+
+    uint64_t fields = date->month;
+    fields = (fields << SIZE_DAY) | date->day;
+    fields = (fields << SIZE_HOUR) | time->hour;
+    fields = (fields << SIZE_MINUTE) | time->minute;
+    fields = (fields << SIZE_SECOND) | time->second;
+    fields = (fields << SIZE_NANOSECOND) | time->nanosecond;
+    write_uint_be((uint32_t)date->year ^ FLIP_SIGN_32, KEY_YEAR_SIZE, dst);
+    write_uint_be(fields, KEY_FIELDS_SIZE, dst + KEY_YEAR_SIZE);
+    dst[KEY_TIMEZONE_TYPE_OFFSET] = (uint8_t)timezone->type;
+
+    uint8_t* timezone_data = dst + CT_TIMESTAMP_KEY_MIN_SIZE;
+    switch(timezone->type)
+    {
+        case CT_TZ_STRING:
+            memcpy(timezone_data, timezone->as_string, name_length + 1);
+            break;
+        case CT_TZ_LATLONG:
+            write_uint_be((uint16_t)timezone->latitude ^ FLIP_SIGN_16, 2, timezone_data);
+            write_uint_be((uint16_t)timezone->longitude ^ FLIP_SIGN_16, 2, timezone_data + 2);
+            break;
+        default:
+            break;
+    }
+    return key_size;
+}
+
+int ct_timestamp_key_decode(const uint8_t* src, int src_length, ct_timestamp* timestamp)
+{
+    if(src_length < CT_TIMESTAMP_KEY_MIN_SIZE)
+    {
+        return FAILURE_AT_POS(CT_TIMESTAMP_KEY_MIN_SIZE);
+    }
+
+    ct_date* date = &timestamp->date;
+    ct_time* time = &timestamp->time;
+    date->year = (int32_t)((uint32_t)read_uint_be(src, KEY_YEAR_SIZE) ^ FLIP_SIGN_32);
+    uint64_t fields = read_uint_be(src + KEY_YEAR_SIZE, KEY_FIELDS_SIZE);
+    time->nanosecond = fields & ((1u << SIZE_NANOSECOND) - 1);
+    fields >>= SIZE_NANOSECOND;
+    time->second = fields & MASK_SECOND;
+    fields >>= SIZE_SECOND;
+    time->minute = fields & MASK_MINUTE;
+    fields >>= SIZE_MINUTE;
+    time->hour = fields & MASK_HOUR;
+    fields >>= SIZE_HOUR;
+    date->day = fields & MASK_DAY;
+    fields >>= SIZE_DAY;
+    date->month = fields & MASK_MONTH;
+    if(time->nanosecond >= NANOSECONDS_PER_SECOND)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+
+    ct_timezone* timezone = &time->timezone;
+    const uint8_t* timezone_data = src + CT_TIMESTAMP_KEY_MIN_SIZE;
+    const int timezone_data_length = src_length - CT_TIMESTAMP_KEY_MIN_SIZE;
+    switch(src[KEY_TIMEZONE_TYPE_OFFSET])
+    {
+        case CT_TZ_ZERO:
+            timezone->type = CT_TZ_ZERO;
+            return CT_TIMESTAMP_KEY_MIN_SIZE;
+        case CT_TZ_STRING:
+        {
+            const uint8_t* end = (const uint8_t*)memchr(timezone_data, 0, timezone_data_length);
+            if(end == NULL)
+            {
+                // The name could be any length, but needs at least a terminator.
+                return timezone_data_length > MAX_TIMEZONE_LENGTH ? ERROR_OUT_OF_RANGE : FAILURE_AT_POS(src_length + 1);
+            }
+            const int name_length = end - timezone_data;
+            // The format allows longer names than ct_timezone can hold.
+            if(name_length >= (int)sizeof(timezone->as_string) ||
+               !ct_internal_timezone_name_is_printable(timezone_data, name_length,
+                                                       CT_TIMESTAMP_KEY_MIN_SIZE, timezone_data_length))
+            {
+                return ERROR_OUT_OF_RANGE;
+            }
+            timezone->type = CT_TZ_STRING;
+            memcpy(timezone->as_string, timezone_data, name_length + 1);
+            return CT_TIMESTAMP_KEY_MIN_SIZE + name_length + 1;
+        }
+        case CT_TZ_LATLONG:
+            if(timezone_data_length < KEY_LATLONG_SIZE)
+            {
+                return FAILURE_AT_POS(CT_TIMESTAMP_KEY_MIN_SIZE + KEY_LATLONG_SIZE);
+            }
+            timezone->type = CT_TZ_LATLONG;
+            timezone->latitude = (int16_t)((uint16_t)read_uint_be(timezone_data, 2) ^ FLIP_SIGN_16);
+            timezone->longitude = (int16_t)((uint16_t)read_uint_be(timezone_data + 2, 2) ^ FLIP_SIGN_16);
+            if(!is_latlong_in_range(timezone))
+            {
+                return ERROR_OUT_OF_RANGE;
+            }
+            return CT_TIMESTAMP_KEY_MIN_SIZE + KEY_LATLONG_SIZE;
+        default:
+            return ERROR_OUT_OF_RANGE;
+    }
+}
+
+int ct_timestamp_key_from_encoded(const uint8_t* src,
+                                  int src_length,
+                                  uint8_t* dst,
+                                  int dst_length,
+                                  int* bytes_read)
+{
+    ct_timestamp timestamp;
+    const int record_length = ct_timestamp_decode(src, src_length, &timestamp);
+    if(bytes_read != NULL)
+    {
+        *bytes_read = record_length > 0 ? record_length : 0;
+    }
+    if(record_length <= 0)
+    {
+        return record_length;
+    }
+    return ct_timestamp_key_encode(&timestamp, dst, dst_length);
+}
+
+int ct_timestamp_key_to_encoded(const uint8_t* src,
+                                int src_length,
+                                uint8_t* dst,
+                                int dst_length,
+                                int* bytes_read)
+{
+    ct_timestamp timestamp;
+    const int key_length = ct_timestamp_key_decode(src, src_length, &timestamp);
+    if(bytes_read != NULL)
+    {
+        *bytes_read = key_length > 0 ? key_length : 0;
+    }
+    if(key_length <= 0)
+    {
+        return key_length;
+    }
+    return ct_timestamp_encode(&timestamp, dst, dst_length);
+}
@@ -0,0 +1,304 @@
+/*
+ * Compact Time
+ * ============
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "compact_time/timezone_arena.h"
+#include "compact_time_internal.h"
+
+#include <string.h>
+
+// Offset 0 is never a name, since every name follows its length byte.
+static const uint32_t NO_NAME = 0;
+
+static int get_recent_slot(const uint8_t* encoded, int name_length)
+{
+    // Cheap enough to run on every record. A collision only costs storing
+    // a name twice.
+    uint32_t key = encoded[0];
+    if(name_length > 0)
+    {
+        key = key * 31 + encoded[1];
+        key = key * 31 + encoded[1 + name_length / 2];
+        key = key * 31 + encoded[name_length];
+    }
+    return key & (CT_TIMEZONE_ARENA_RECENT_NAME_COUNT - 1);
+}
+
+static uint32_t find_recent_name(const ct_timezone_arena* arena, const uint8_t* encoded, int name_length, int slot)
+{
+    const uint32_t recent = arena->recent_names[slot];
+    if(recent == NO_NAME)
+    {
+        return NO_NAME;
+    }
+    const uint8_t* stored = arena->memory + recent - 1;
+    // Lengths must match before the stored name can be read that far.
+    if(stored[0] != encoded[0] || memcmp(stored + 1, encoded + 1, name_length) != 0)
+    {
+        return NO_NAME;
+    }
+    return recent;
+}
+
+// encoded points to the name's length byte.
+static int store_name(ct_timezone_arena* arena, const uint8_t* encoded, int name_length, int slot)
+{
+    const int encoded_length = name_length + 1;
+    // Length byte, name, null terminator
+    if(encoded_length + 1 > ct_timezone_arena_remaining(arena))
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    uint8_t* entry = arena->memory + arena->used;
+    memcpy(entry, encoded, encoded_length);
+    entry[encoded_length] = 0;
+
+    const int name_offset = arena->used + 1;
+    arena->used += encoded_length + 1;
+    arena->recent_names[slot] = (uint32_t)name_offset;
+    return name_offset;
+}
+
+typedef struct
+{
+    ct_timezone_arena* arena;
+    ct_arena_timestamp* timestamp;
+} store_context;
+
+// A ct_internal_string_timezone_decoder
+static int store_string_timezone(void* context, const uint8_t* src, int src_length, int preceding_length)
+{
+    ct_timezone_arena* arena = ((store_context*)context)->arena;
+    ct_arena_timestamp* timestamp = ((store_context*)context)->timestamp;
+    const int length = src[0] >> SHIFT_LENGTH;
+    const int offset = 1;
+    if(offset + length > src_length)
+    {
+        return FAILURE_AT_POS(offset + length);
+    }
+    // Longer names would re-encode past CT_TIMESTAMP_MAX_ENCODED_SIZE.
+    if(length > MAX_TIMEZONE_LENGTH)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+
+    // A name found in the arena has already been validated.
+    const int slot = get_recent_slot(src, length);
+    int name_offset = (int)find_recent_name(arena, src, length, slot);
+    if(name_offset == NO_NAME)
+    {
+        if(!ct_internal_timezone_name_is_printable(src + offset,
+                                                   length,
+                                                   preceding_length + offset,
+                                                   src_length - offset))
+        {
+            return ERROR_OUT_OF_RANGE;
+        }
+        name_offset = store_name(arena, src, length, slot);
+        if(name_offset < 0)
+        {
+            return name_offset;
+        }
+    }
+    timestamp->timezone_type = CT_TZ_STRING;
+    timestamp->name_offset = (uint32_t)name_offset;
+    return offset + length;
+}
+
+
+
+// ----------
+// Public API
+// ----------
+
+void ct_timezone_arena_init(ct_timezone_arena* arena, void* memory, int capacity)
+{
+    memset(arena, 0, sizeof(*arena));
+    arena->memory = memory;
+    arena->capacity = capacity;
+}
+
+void ct_timezone_arena_reset(ct_timezone_arena* arena)
+{
+    arena->used = 0;
+    memset(arena->recent_names, 0, sizeof(arena->recent_names));
+}
+
+const char* ct_timezone_arena_get_name(const ct_timezone_arena* arena, uint32_t name_offset)
+{
+    return (const char*)arena->memory + name_offset;
+}
+
+int ct_timezone_arena_get_name_length(const ct_timezone_arena* arena, uint32_t name_offset)
+{
+    return arena->memory[name_offset - 1] >> SHIFT_LENGTH;
+}
+
+int ct_timezone_arena_remaining(const ct_timezone_arena* arena)
+{
+    return arena->capacity - arena->used;
+}
+
+int ct_arena_timestamp_decode(ct_timezone_arena* arena,
+                              const uint8_t* src,
+                              int src_length,
+                              ct_arena_timestamp* timestamp)
+{
+    bool timezone_is_utc = false;
+    int offset = ct_internal_timestamp_base_decode(src,
+                                                   src_length,
+                                                   &timestamp->date,
+                                                   &timestamp->hour,
+                                                   &timestamp->minute,
+                                                   &timestamp->second,
+                                                   &timestamp->nanosecond,
+                                                   &timezone_is_utc);
+    if(offset < 0)
+    {
+        return offset;
+    }
+
+    timestamp->latitude = 0;
+    timestamp->longitude = 0;
+    timestamp->name_offset = NO_NAME;
+    if(timezone_is_utc)
+    {
+        timestamp->timezone_type = CT_TZ_ZERO;
+        return offset;
+    }
+
+    // Replaced by store_string_timezone() for a string timezone
+    timestamp->timezone_type = CT_TZ_LATLONG;
+    store_context context = {arena, timestamp};
+    return ct_internal_timezone_decode(src,
+                                       src_length,
+                                       offset,
+                                       &timestamp->latitude,
+                                       &timestamp->longitude,
+                                       store_string_timezone,
+                                       &context);
+}
+
+int ct_arena_timestamp_decode_batch(ct_timezone_arena* arena,
+                                    const uint8_t* src,
+                                    int src_length,
+                                    ct_arena_timestamp* timestamps,
+                                    int max_timestamp_count,
+                                    int* record_offsets,
+                                    int* records_processed)
+{
+    int offset = 0;
+    int index = 0;
+    int result = 0;
+
+    for(; index < max_timestamp_count && offset < src_length; index++)
+    {
+        const int byte_count = ct_arena_timestamp_decode(arena, src + offset, src_length - offset, &timestamps[index]);
+        if(byte_count == ERROR_OUT_OF_RANGE)
+        {
+            result = ERROR_OUT_OF_RANGE;
+            break;
+        }
+        if(byte_count < 0)
+        {
+            result = FAILURE_AT_POS(offset) + byte_count;
+            break;
+        }
+        if(record_offsets != NULL)
+        {
+            record_offsets[index] = offset;
+        }
+        offset += byte_count;
+        result = offset;
+    }
+
+    if(records_processed != NULL)
+    {
+        *records_processed = index;
+    }
+    return result;
+}
+
+int ct_arena_timestamp_encode(const ct_timezone_arena* arena,
+                              const ct_arena_timestamp* timestamp,
+                              uint8_t* dst,
+                              int dst_length)
+{
+    const bool timezone_is_utc = timestamp->timezone_type == CT_TZ_ZERO;
+    int offset = ct_internal_timestamp_base_encode(&timestamp->date,
+                                                   timestamp->hour,
+                                                   timestamp->minute,
+                                                   timestamp->second,
+                                                   timestamp->nanosecond,
+                                                   timezone_is_utc,
+                                                   dst,
+                                                   dst_length);
+    if(offset <= 0 || timezone_is_utc)
+    {
+        return offset;
+    }
+
+    int timezone_byte_count = 0;
+    switch(timestamp->timezone_type)
+    {
+        case CT_TZ_STRING:
+        {
+            const uint32_t name_offset = timestamp->name_offset;
+            if(name_offset == NO_NAME || name_offset >= (uint32_t)arena->used)
+            {
+                return ERROR_OUT_OF_RANGE;
+            }
+            const int encoded_length = ct_timezone_arena_get_name_length(arena, name_offset) + 1;
+            if(offset + encoded_length > dst_length)
+            {
+                return FAILURE_AT_POS(offset + encoded_length);
+            }
+            memcpy(dst + offset, arena->memory + name_offset - 1, encoded_length);
+            timezone_byte_count = encoded_length;
+            break;
+        }
+        case CT_TZ_LATLONG:
+            timezone_byte_count = ct_internal_latlong_encode(timestamp->latitude,
+                                                             timestamp->longitude,
+                                                             dst + offset,
+                                                             dst_length - offset);
+            break;
+        default:
+            return ERROR_OUT_OF_RANGE;
+    }
+
+    if(timezone_byte_count == ERROR_OUT_OF_RANGE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(timezone_byte_count < 0)
+    {
+        return FAILURE_AT_POS(offset) + timezone_byte_count;
+    }
+    return offset + timezone_byte_count;
+}
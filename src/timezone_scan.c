@@ -0,0 +1,191 @@
+/*
+ * Compact Time
+ * ============
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// Timezone name scanning.
+//
+// Names are short (at most 63 bytes, and at most 40 in a ct_timezone), so
+// they are checked in 16-byte SSE2 chunks rather than a byte at a time: one
+// pass finds the terminator and flags any byte outside printable ASCII. A
+// typical name fits in a single chunk. SSE2 is part of the x86-64 baseline,
+// so unlike the UTC run decoder there is nothing to pick at runtime.
+
+#include "compact_time/compact_time.h"
+#include "compact_time_internal.h"
+
+#include <stdbool.h>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+    #define CT_HAS_NAME_SIMD 1
+    #include <emmintrin.h>
+#endif
+
+static const uint8_t FIRST_PRINTABLE = 0x20;
+static const uint8_t LAST_PRINTABLE = 0x7e;
+
+#define NAME_BUFFER_SIZE ((int)sizeof(((ct_timezone*)0)->as_string))
+
+static bool is_printable(const uint8_t ch)
+{
+    return ch >= FIRST_PRINTABLE && ch <= LAST_PRINTABLE;
+}
+
+static bool check_printable_scalar(const uint8_t* name, int length)
+{
+    for(int i = 0; i < length; i++)
+    {
+        if(!is_printable(name[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef CT_HAS_NAME_SIMD
+
+#define NAME_CHUNK_SIZE 16
+
+// Get one bit per byte of a chunk for bytes that are zero, and for bytes
+// that are outside printable ASCII (signed compares also reject 0x80-0xff).
+static void get_chunk_masks(const uint8_t* src, uint32_t* zeros, uint32_t* unprintable)
+{
+    const __m128i chunk = _mm_loadu_si128((const __m128i*)src);
+    const __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8(FIRST_PRINTABLE - 1)),
+                                            _mm_cmplt_epi8(chunk, _mm_set1_epi8(LAST_PRINTABLE + 1)));
+    *zeros = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_setzero_si128()));
+    *unprintable = ~(uint32_t)_mm_movemask_epi8(printable) & 0xffff;
+}
+
+// Bits below bit_count (at most a whole chunk)
+static uint32_t low_bits_mask(const int bit_count)
+{
+    return ((uint32_t)1 << bit_count) - 1;
+}
+
+int ct_internal_timezone_name_scan(const char* name, int* length)
+{
+    const uint8_t* bytes = (const uint8_t*)name;
+    uint32_t zeros = 0;
+    uint32_t unprintable = 0;
+
+    // Most names end within the first chunk.
+    get_chunk_masks(bytes, &zeros, &unprintable);
+    if(zeros != 0)
+    {
+        const int name_length = __builtin_ctz(zeros);
+        *length = name_length;
+        return (unprintable & low_bits_mask(name_length)) == 0 ? 0 : ERROR_OUT_OF_RANGE;
+    }
+
+    bool is_valid = unprintable == 0;
+    for(int offset = NAME_CHUNK_SIZE; offset < NAME_BUFFER_SIZE; offset += NAME_CHUNK_SIZE)
+    {
+        // The last chunk ends at the end of the buffer, overlapping the one
+        // before it rather than reading past the buffer.
+        const int position = offset + NAME_CHUNK_SIZE <= NAME_BUFFER_SIZE ? offset : NAME_BUFFER_SIZE - NAME_CHUNK_SIZE;
+        get_chunk_masks(bytes + position, &zeros, &unprintable);
+        zeros >>= offset - position;
+        unprintable >>= offset - position;
+        if(zeros != 0)
+        {
+            const int chunk_length = __builtin_ctz(zeros);
+            *length = offset + chunk_length;
+            is_valid = is_valid && (unprintable & low_bits_mask(chunk_length)) == 0;
+            return is_valid && *length <= MAX_TIMEZONE_LENGTH ? 0 : ERROR_OUT_OF_RANGE;
+        }
+        is_valid = is_valid && unprintable == 0;
+    }
+
+    // Not terminated within the buffer
+    *length = NAME_BUFFER_SIZE;
+    return ERROR_OUT_OF_RANGE;
+}
+
+bool ct_internal_timezone_name_is_printable(const uint8_t* name, int length, int preceding_length, int readable_length)
+{
+    int offset = 0;
+    uint32_t zeros = 0;
+    uint32_t unprintable = 0;
+    // Whole chunks, the last of which may run past the name (but not past
+    // the readable bytes) and is masked down to it.
+    for(; offset < length && offset + NAME_CHUNK_SIZE <= readable_length; offset += NAME_CHUNK_SIZE)
+    {
+        get_chunk_masks(name + offset, &zeros, &unprintable);
+        if(length - offset < NAME_CHUNK_SIZE)
+        {
+            unprintable &= low_bits_mask(length - offset);
+        }
+        if(unprintable != 0)
+        {
+            return false;
+        }
+    }
+    if(offset >= length)
+    {
+        return true;
+    }
+    // Otherwise, finish with a chunk that ends at the end of the name,
+    // reaching back before it if need be, and keep only its unchecked bytes.
+    if(preceding_length + length >= NAME_CHUNK_SIZE)
+    {
+        get_chunk_masks(name + length - NAME_CHUNK_SIZE, &zeros, &unprintable);
+        return (unprintable >> (NAME_CHUNK_SIZE - (length - offset))) == 0;
+    }
+    return check_printable_scalar(name + offset, length - offset);
+}
+
+#else
+
+int ct_internal_timezone_name_scan(const char* name, int* length)
+{
+    const uint8_t* bytes = (const uint8_t*)name;
+    bool is_valid = true;
+    for(int i = 0; i < NAME_BUFFER_SIZE; i++)
+    {
+        if(bytes[i] == 0)
+        {
+            *length = i;
+            return is_valid && i <= MAX_TIMEZONE_LENGTH ? 0 : ERROR_OUT_OF_RANGE;
+        }
+        is_valid = is_valid && is_printable(bytes[i]);
+    }
+
+    // Not terminated within the buffer
+    *length = NAME_BUFFER_SIZE;
+    return ERROR_OUT_OF_RANGE;
+}
+
+bool ct_internal_timezone_name_is_printable(const uint8_t* name, int length, int preceding_length, int readable_length)
+{
+    (void)preceding_length;
+    (void)readable_length;
+    return check_printable_scalar(name, length);
+}
+
+#endif // CT_HAS_NAME_SIMD
@@ -0,0 +1,274 @@
+/*
+ * Compact Time
+ * ============
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "compact_time/timezone_table.h"
+#include "compact_time_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const int32_t EMPTY_SLOT = -1;
+static const int MIN_HASH_SLOT_COUNT = 16;
+
+static uint32_t hash_name(const char* name, int name_length)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for(int i = 0; i < name_length; i++)
+    {
+        hash ^= (uint8_t)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool entry_has_name(const ct_interned_timezone_name* entry, const char* name, int name_length)
+{
+    return entry->encoded_length == name_length + 1 && memcmp(entry->name, name, name_length) == 0;
+}
+
+typedef struct
+{
+    ct_timezone_table* table;
+    ct_interned_timezone* timezone;
+} intern_context;
+
+// A ct_internal_string_timezone_decoder
+static int intern_string_timezone(void* context, const uint8_t* src, int src_length, int preceding_length)
+{
+    (void)preceding_length;
+    ct_timezone_table* table = ((intern_context*)context)->table;
+    ct_interned_timezone* timezone = ((intern_context*)context)->timezone;
+    const int length = src[0] >> SHIFT_LENGTH;
+    const int offset = 1;
+    if(offset + length > src_length)
+    {
+        return FAILURE_AT_POS(offset + length);
+    }
+    const int id = ct_timezone_table_intern(table, (const char*)src + offset, length);
+    if(id < 0)
+    {
+        return id;
+    }
+    timezone->type = CT_TZ_STRING;
+    timezone->id = id;
+    timezone->name = table->entries[id].name;
+    return offset + length;
+}
+
+
+
+// ----------
+// Public API
+// ----------
+
+bool ct_timezone_table_init(ct_timezone_table* table, int max_name_count)
+{
+    memset(table, 0, sizeof(*table));
+
+    int hash_slot_count = MIN_HASH_SLOT_COUNT;
+    while(hash_slot_count < max_name_count * 2)
+    {
+        hash_slot_count <<= 1;
+    }
+
+    table->entries = malloc(sizeof(*table->entries) * max_name_count);
+    table->hash_slots = malloc(sizeof(*table->hash_slots) * hash_slot_count);
+    if(table->entries == NULL || table->hash_slots == NULL)
+    {
+        ct_timezone_table_free(table);
+        return false;
+    }
+
+    for(int i = 0; i < hash_slot_count; i++)
+    {
+        table->hash_slots[i] = EMPTY_SLOT;
+    }
+    table->entry_capacity = max_name_count;
+    table->hash_slot_mask = hash_slot_count - 1;
+    return true;
+}
+
+void ct_timezone_table_free(ct_timezone_table* table)
+{
+    free(table->entries);
+    free(table->hash_slots);
+    memset(table, 0, sizeof(*table));
+}
+
+int ct_timezone_table_intern(ct_timezone_table* table, const char* name, int name_length)
+{
+    if(name_length < 0 || name_length > CT_MAX_TIMEZONE_NAME_LENGTH)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+
+    // Feeds tend to repeat the same zone many times in a row.
+    if(table->entry_count > 0 && entry_has_name(&table->entries[table->last_id], name, name_length))
+    {
+        return table->last_id;
+    }
+    if(!ct_internal_timezone_name_is_printable((const uint8_t*)name, name_length, 0, name_length))
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+
+    int slot = hash_name(name, name_length) & table->hash_slot_mask;
+    for(;;)
+    {
+        const int32_t id = table->hash_slots[slot];
+        if(id == EMPTY_SLOT)
+        {
+            break;
+        }
+        if(entry_has_name(&table->entries[id], name, name_length))
+        {
+            table->last_id = id;
+            return id;
+        }
+        slot = (slot + 1) & table->hash_slot_mask;
+    }
+
+    if(table->entry_count >= table->entry_capacity)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+
+    const int id = table->entry_count++;
+    ct_interned_timezone_name* entry = &table->entries[id];
+    memcpy(entry->name, name, name_length);
+    entry->name[name_length] = 0;
+    entry->encoded[0] = name_length << SHIFT_LENGTH;
+    memcpy(entry->encoded + 1, name, name_length);
+    entry->encoded_length = name_length + 1;
+    table->hash_slots[slot] = id;
+    table->last_id = id;
+    return id;
+}
+
+const char* ct_timezone_table_get_name(const ct_timezone_table* table, int id)
+{
+    return table->entries[id].name;
+}
+
+int ct_interned_timestamp_decode(ct_timezone_table* table,
+                                 const uint8_t* src,
+                                 int src_length,
+                                 ct_interned_timestamp* timestamp)
+{
+    bool timezone_is_utc = false;
+    int offset = ct_internal_timestamp_base_decode(src,
+                                                   src_length,
+                                                   &timestamp->date,
+                                                   &timestamp->hour,
+                                                   &timestamp->minute,
+                                                   &timestamp->second,
+                                                   &timestamp->nanosecond,
+                                                   &timezone_is_utc);
+    if(offset < 0)
+    {
+        return offset;
+    }
+
+    if(timezone_is_utc)
+    {
+        timestamp->timezone.type = CT_TZ_ZERO;
+        return offset;
+    }
+
+    // Replaced by intern_string_timezone() for a string timezone
+    timestamp->timezone.type = CT_TZ_LATLONG;
+    intern_context context = {table, &timestamp->timezone};
+    return ct_internal_timezone_decode(src,
+                                       src_length,
+                                       offset,
+                                       &timestamp->timezone.latitude,
+                                       &timestamp->timezone.longitude,
+                                       intern_string_timezone,
+                                       &context);
+}
+
+int ct_interned_timestamp_encode(const ct_timezone_table* table,
+                                 const ct_interned_timestamp* timestamp,
+                                 uint8_t* dst,
+                                 int dst_length)
+{
+    const bool timezone_is_utc = timestamp->timezone.type == CT_TZ_ZERO;
+    int offset = ct_internal_timestamp_base_encode(&timestamp->date,
+                                                   timestamp->hour,
+                                                   timestamp->minute,
+                                                   timestamp->second,
+                                                   timestamp->nanosecond,
+                                                   timezone_is_utc,
+                                                   dst,
+                                                   dst_length);
+    if(offset <= 0 || timezone_is_utc)
+    {
+        return offset;
+    }
+
+    int timezone_byte_count = 0;
+    switch(timestamp->timezone.type)
+    {
+        case CT_TZ_STRING:
+        {
+            const int id = timestamp->timezone.id;
+            if(id < 0 || id >= table->entry_count)
+            {
+                return ERROR_OUT_OF_RANGE;
+            }
+            const ct_interned_timezone_name* entry = &table->entries[id];
+            if(offset + entry->encoded_length > dst_length)
+            {
+                return FAILURE_AT_POS(offset + entry->encoded_length);
+            }
+            memcpy(dst + offset, entry->encoded, entry->encoded_length);
+            timezone_byte_count = entry->encoded_length;
+            break;
+        }
+        case CT_TZ_LATLONG:
+            timezone_byte_count = ct_internal_latlong_encode(timestamp->timezone.latitude,
+                                                             timestamp->timezone.longitude,
+                                                             dst + offset,
+                                                             dst_length - offset);
+            break;
+        default:
+            return ERROR_OUT_OF_RANGE;
+    }
+
+    if(timezone_byte_count == ERROR_OUT_OF_RANGE)
+    {
+        return ERROR_OUT_OF_RANGE;
+    }
+    if(timezone_byte_count < 0)
+    {
+        return FAILURE_AT_POS(offset) + timezone_byte_count;
+    }
+    return offset + timezone_byte_count;
+}
@@ -0,0 +1,332 @@
+/*
+ * Compact Time
+ * ============
+ *
+ *
+ * License
+ * -------
+ *
+ * Copyright 2019 Karl Stenerud
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// Struct-of-arrays decoding of UTC timestamp runs.
+//
+// Runs where consecutive records share a subsecond magnitude and have a
+// single-byte year are fixed-stride, so blocks of them can be unpacked in
+// parallel lanes. The lane width is picked at runtime based on CPU support,
+// with a scalar decoder covering everything else.
+
+#include "compact_time/compact_time.h"
+#include "compact_time_internal.h"
+#include <endianness/endianness.h>
+
+#include <vlq/vlq.h>
+
+#include <stdbool.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+    #define CT_HAS_X86_SIMD 1
+    #include <immintrin.h>
+#endif
+
+typedef void (*decode_block_function)(const uint8_t* src, int magnitude, const ct_timestamp_fields* fields, int index);
+
+typedef struct
+{
+    int record_count;
+    decode_block_function decode;
+} block_decoder;
+
+static int decode_year_group(const uint64_t year_group)
+{
+    // Drop the UTC flag, then undo the zigzag encoding.
+    const uint32_t encoded_year = (uint32_t)(year_group >> 1);
+    return (int)((encoded_year >> 1) ^ -(encoded_year & 1)) + YEAR_BIAS;
+}
+
+static int decode_utc_record(const uint8_t* src, int src_length, const ct_timestamp_fields* fields, int index)
+{
+    if(src_length < 1)
+    {
+        return FAILURE_AT_POS(1);
+    }
+
+    const int magnitude = src[0] & MASK_MAGNITUDE;
+    const int size_subsecond = SIZE_SUBSECOND * magnitude;
+    const unsigned mask_subsecond = (1 << size_subsecond) - 1;
+
+    int offset = g_timestamp_base_byte_counts[magnitude];
+    if(offset >= src_length)
+    {
+        return FAILURE_AT_POS(offset);
+    }
+
+    uint64_t accumulator = 0;
+    copy_le(src, &accumulator, offset);
+    uint32_t year_group = (uint32_t)(accumulator >> (SHIFT_SUBSECOND + size_subsecond));
+
+    const int decoded_group_count = rvlq_decode_32(&year_group, src + offset, src_length - offset);
+    if(decoded_group_count < 1)
+    {
+        return FAILURE_AT_POS(offset) + decoded_group_count;
+    }
+    offset += decoded_group_count;
+
+    if((year_group & 1) == 0)
+    {
+        // Not UTC. Leave it for the general decoder.
+        return 0;
+    }
+
+    fields->second[index] = (accumulator >> SHIFT_SECOND) & MASK_SECOND;
+    fields->minute[index] = (accumulator >> SHIFT_MINUTE) & MASK_MINUTE;
+    fields->hour[index] = (accumulator >> SHIFT_HOUR) & MASK_HOUR;
+    fields->day[index] = (accumulator >> SHIFT_DAY) & MASK_DAY;
+    fields->month[index] = (accumulator >> SHIFT_MONTH) & MASK_MONTH;
+    fields->nanosecond[index] = ((accumulator >> SHIFT_SUBSECOND) & mask_subsecond) * g_subsec_multipliers[magnitude];
+    fields->year[index] = decode_year_group(year_group);
+
+    return offset;
+}
+
+static bool is_fixed_stride_utc_block(const uint8_t* src, int src_length, int magnitude, int record_count)
+{
+    const int base_byte_count = g_timestamp_base_byte_counts[magnitude];
+    const int stride = base_byte_count + 1;
+    // Every lane is loaded as a full 64-bit word.
+    const int load_size = stride > (int)sizeof(uint64_t) ? stride : (int)sizeof(uint64_t);
+    if((record_count - 1) * stride + load_size > src_length)
+    {
+        return false;
+    }
+
+    for(int i = 0; i < record_count; i++)
+    {
+        const uint8_t* record = src + i * stride;
+        if((int)(record[0] & MASK_MAGNITUDE) != magnitude)
+        {
+            return false;
+        }
+        // Single year group with the UTC flag set
+        if((record[base_byte_count] & (RVLQ_CONTINUATION_BIT | 1)) != 1)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint64_t get_accumulator_mask(int magnitude)
+{
+    const int base_byte_count = g_timestamp_base_byte_counts[magnitude];
+    if(base_byte_count >= (int)sizeof(uint64_t))
+    {
+        return ~(uint64_t)0;
+    }
+    return ((uint64_t)1 << (base_byte_count * 8)) - 1;
+}
+
+#ifdef CT_HAS_X86_SIMD
+
+__attribute__((target("avx2")))
+static void decode_block_avx2(const uint8_t* src, int magnitude, const ct_timestamp_fields* fields, int index)
+{
+    const int base_byte_count = g_timestamp_base_byte_counts[magnitude];
+    const int stride = base_byte_count + 1;
+    const int size_subsecond = SIZE_SUBSECOND * magnitude;
+
+    __m256i accumulator = _mm256_set_epi64x(read_uint64_le(src + stride * 3),
+                                            read_uint64_le(src + stride * 2),
+                                            read_uint64_le(src + stride),
+                                            read_uint64_le(src));
+    const __m256i year_group_low = _mm256_set_epi64x(src[stride * 3 + base_byte_count],
+                                                      src[stride * 2 + base_byte_count],
+                                                      src[stride + base_byte_count],
+                                                      src[base_byte_count]);
+    accumulator = _mm256_and_si256(accumulator, _mm256_set1_epi64x(get_accumulator_mask(magnitude)));
+
+    const __m256i second = _mm256_and_si256(_mm256_srli_epi64(accumulator, SHIFT_SECOND), _mm256_set1_epi64x(MASK_SECOND));
+    const __m256i minute = _mm256_and_si256(_mm256_srli_epi64(accumulator, SHIFT_MINUTE), _mm256_set1_epi64x(MASK_MINUTE));
+    const __m256i hour = _mm256_and_si256(_mm256_srli_epi64(accumulator, SHIFT_HOUR), _mm256_set1_epi64x(MASK_HOUR));
+    const __m256i day = _mm256_and_si256(_mm256_srli_epi64(accumulator, SHIFT_DAY), _mm256_set1_epi64x(MASK_DAY));
+    const __m256i month = _mm256_and_si256(_mm256_srli_epi64(accumulator, SHIFT_MONTH), _mm256_set1_epi64x(MASK_MONTH));
+    const __m256i subsecond = _mm256_and_si256(_mm256_srli_epi64(accumulator, SHIFT_SUBSECOND),
+                                               _mm256_set1_epi64x((1 << size_subsecond) - 1));
+    const __m256i nanosecond = _mm256_mul_epu32(subsecond, _mm256_set1_epi64x(g_subsec_multipliers[magnitude]));
+
+    const __m256i year_group_high = _mm256_srl_epi64(accumulator, _mm_cvtsi32_si128(SHIFT_SUBSECOND + size_subsecond));
+    const __m256i year_group = _mm256_or_si256(_mm256_slli_epi64(year_group_high, BITS_PER_YEAR_GROUP), year_group_low);
+    const __m256i year_sign = _mm256_sub_epi64(_mm256_setzero_si256(),
+                                               _mm256_and_si256(_mm256_srli_epi64(year_group, 1), _mm256_set1_epi64x(1)));
+    const __m256i year = _mm256_add_epi64(_mm256_xor_si256(_mm256_srli_epi64(year_group, 2), year_sign),
+                                          _mm256_set1_epi64x(YEAR_BIAS));
+
+    // Narrow the 32-bit fields by gathering the low half of each lane.
+    const __m256i low_halves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    _mm_storeu_si128((__m128i*)(fields->year + index),
+                     _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(year, low_halves)));
+    _mm_storeu_si128((__m128i*)(fields->nanosecond + index),
+                     _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(nanosecond, low_halves)));
+
+    // Pack the byte fields into one word per lane so they narrow in one pass.
+    const __m256i packed = _mm256_or_si256(_mm256_or_si256(second, _mm256_slli_epi64(minute, 8)),
+                                           _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi64(hour, 16),
+                                                                           _mm256_slli_epi64(day, 24)),
+                                                           _mm256_slli_epi64(month, 32)));
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, packed);
+    for(int i = 0; i < 4; i++)
+    {
+        fields->second[index + i] = (uint8_t)lanes[i];
+        fields->minute[index + i] = (uint8_t)(lanes[i] >> 8);
+        fields->hour[index + i] = (uint8_t)(lanes[i] >> 16);
+        fields->day[index + i] = (uint8_t)(lanes[i] >> 24);
+        fields->month[index + i] = (uint8_t)(lanes[i] >> 32);
+    }
+}
+
+__attribute__((target("sse4.2")))
+static void decode_block_sse42(const uint8_t* src, int magnitude, const ct_timestamp_fields* fields, int index)
+{
+    const int base_byte_count = g_timestamp_base_byte_counts[magnitude];
+    const int stride = base_byte_count + 1;
+    const int size_subsecond = SIZE_SUBSECOND * magnitude;
+
+    __m128i accumulator = _mm_set_epi64x(read_uint64_le(src + stride), read_uint64_le(src));
+    const __m128i year_group_low = _mm_set_epi64x(src[stride + base_byte_count], src[base_byte_count]);
+    accumulator = _mm_and_si128(accumulator, _mm_set1_epi64x(get_accumulator_mask(magnitude)));
+
+    const __m128i second = _mm_and_si128(_mm_srli_epi64(accumulator, SHIFT_SECOND), _mm_set1_epi64x(MASK_SECOND));
+    const __m128i minute = _mm_and_si128(_mm_srli_epi64(accumulator, SHIFT_MINUTE), _mm_set1_epi64x(MASK_MINUTE));
+    const __m128i hour = _mm_and_si128(_mm_srli_epi64(accumulator, SHIFT_HOUR), _mm_set1_epi64x(MASK_HOUR));
+    const __m128i day = _mm_and_si128(_mm_srli_epi64(accumulator, SHIFT_DAY), _mm_set1_epi64x(MASK_DAY));
+    const __m128i month = _mm_and_si128(_mm_srli_epi64(accumulator, SHIFT_MONTH), _mm_set1_epi64x(MASK_MONTH));
+    const __m128i subsecond = _mm_and_si128(_mm_srli_epi64(accumulator, SHIFT_SUBSECOND),
+                                            _mm_set1_epi64x((1 << size_subsecond) - 1));
+    const __m128i nanosecond = _mm_mul_epu32(subsecond, _mm_set1_epi64x(g_subsec_multipliers[magnitude]));
+
+    const __m128i year_group_high = _mm_srl_epi64(accumulator, _mm_cvtsi32_si128(SHIFT_SUBSECOND + size_subsecond));
+    const __m128i year_group = _mm_or_si128(_mm_slli_epi64(year_group_high, BITS_PER_YEAR_GROUP), year_group_low);
+    const __m128i year_sign = _mm_sub_epi64(_mm_setzero_si128(),
+                                            _mm_and_si128(_mm_srli_epi64(year_group, 1), _mm_set1_epi64x(1)));
+    const __m128i year = _mm_add_epi64(_mm_xor_si128(_mm_srli_epi64(year_group, 2), year_sign),
+                                       _mm_set1_epi64x(YEAR_BIAS));
+
+    // Narrow the 32-bit fields by gathering the low half of each lane.
+    _mm_storel_epi64((__m128i*)(fields->year + index), _mm_shuffle_epi32(year, _MM_SHUFFLE(3, 1, 2, 0)));
+    _mm_storel_epi64((__m128i*)(fields->nanosecond + index), _mm_shuffle_epi32(nanosecond, _MM_SHUFFLE(3, 1, 2, 0)));
+
+    const __m128i packed = _mm_or_si128(_mm_or_si128(second, _mm_slli_epi64(minute, 8)),
+                                        _mm_or_si128(_mm_or_si128(_mm_slli_epi64(hour, 16),
+                                                                  _mm_slli_epi64(day, 24)),
+                                                     _mm_slli_epi64(month, 32)));
+    for(int i = 0; i < 2; i++)
+    {
+        const uint64_t lane = i == 0 ? (uint64_t)_mm_cvtsi128_si64(packed) : (uint64_t)_mm_extract_epi64(packed, 1);
+        fields->second[index + i] = (uint8_t)lane;
+        fields->minute[index + i] = (uint8_t)(lane >> 8);
+        fields->hour[index + i] = (uint8_t)(lane >> 16);
+        fields->day[index + i] = (uint8_t)(lane >> 24);
+        fields->month[index + i] = (uint8_t)(lane >> 32);
+    }
+}
+
+static const block_decoder g_block_decoder_avx2 = { 4, decode_block_avx2 };
+static const block_decoder g_block_decoder_sse42 = { 2, decode_block_sse42 };
+
+#endif // CT_HAS_X86_SIMD
+
+static const block_decoder g_block_decoder_scalar = { 0, NULL };
+
+static const block_decoder* get_block_decoder()
+{
+#ifdef CT_HAS_X86_SIMD
+    // Threads may race to select the decoder, but they all store the same
+    // pointer, so relaxed atomics are enough.
+    static const block_decoder* g_selected_decoder = NULL;
+    const block_decoder* decoder = __atomic_load_n(&g_selected_decoder, __ATOMIC_RELAXED);
+    if(decoder == NULL)
+    {
+        decoder = &g_block_decoder_scalar;
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2"))
+        {
+            decoder = &g_block_decoder_avx2;
+        }
+        else if(__builtin_cpu_supports("sse4.2"))
+        {
+            decoder = &g_block_decoder_sse42;
+        }
+        __atomic_store_n(&g_selected_decoder, decoder, __ATOMIC_RELAXED);
+    }
+    return decoder;
+#else
+    return &g_block_decoder_scalar;
+#endif
+}
+
+int ct_timestamp_decode_utc_run(const uint8_t* src,
+                                int src_length,
+                                const ct_timestamp_fields* fields,
+                                int max_timestamp_count,
+                                int* records_processed)
+{
+    const block_decoder* decoder = get_block_decoder();
+    int offset = 0;
+    int index = 0;
+    int result = 0;
+
+    while(index < max_timestamp_count && offset < src_length)
+    {
+        if(decoder->record_count > 0 && index + decoder->record_count <= max_timestamp_count)
+        {
+            const int magnitude = src[offset] & MASK_MAGNITUDE;
+            if(is_fixed_stride_utc_block(src + offset, src_length - offset, magnitude, decoder->record_count))
+            {
+                decoder->decode(src + offset, magnitude, fields, index);
+                offset += (g_timestamp_base_byte_counts[magnitude] + 1) * decoder->record_count;
+                index += decoder->record_count;
+                result = offset;
+                continue;
+            }
+        }
+
+        const int byte_count = decode_utc_record(src + offset, src_length - offset, fields, index);
+        if(byte_count == 0)
+        {
+            break;
+        }
+        if(byte_count < 0)
+        {
+            result = FAILURE_AT_POS(offset) + byte_count;
+            break;
+        }
+        offset += byte_count;
+        index++;
+        result = offset;
+    }
+
+    if(records_processed != NULL)
+    {
+        *records_processed = index;
+    }
+    return result;
+}
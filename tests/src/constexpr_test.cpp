@@ -0,0 +1,160 @@
+// Exercises the C++ constexpr codec in compact_time.hpp, both at compile time
+// and against the C library at run time.
+#include <gtest/gtest.h>
+#include <compact_time/compact_time.hpp>
+#include <vector>
+
+// std::array's operator== is only constexpr from C++20.
+template<size_t N>
+static constexpr bool bytes_equal(const std::array<uint8_t, N>& a, const std::array<uint8_t, N>& b)
+{
+    for(size_t i = 0; i < N; i++)
+    {
+        if(a[i] != b[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// August 31, 3190, 00:54:47.394129, location 59.94, 10.71
+static constexpr ct_timestamp LOCATION_TIMESTAMP = {{3190, 8, 31}, {0, 54, 47, 394129000, {CT_TZ_LATLONG, 5994, 1071, ""}}};
+static constexpr std::array<uint8_t, 12> LOCATION_TIMESTAMP_BYTES = {0xbe, 0x36, 0xf8, 0x18, 0x39, 0x60, 0xa5, 0x18, 0xd5, 0x2e, 0x2f, 0x04};
+static_assert(bytes_equal(ct::encode_array<LOCATION_TIMESTAMP>(), LOCATION_TIMESTAMP_BYTES), "Timestamp encodes at compile time");
+static_assert(ct::encoded_size(LOCATION_TIMESTAMP) == 12, "Timestamp size is known at compile time");
+
+static constexpr ct_date DATE = {2051, 10, 22};
+static_assert(bytes_equal(ct::encode_array<DATE>(), std::array<uint8_t, 3>{0x56, 0x01, 0x66}), "Date encodes at compile time");
+
+static constexpr ct_time NAMED_TIME = {13, 15, 59, 529435422, {CT_TZ_STRING, 0, 0, "E/Berlin"}};
+static_assert(bytes_equal(ct::encode_array<NAMED_TIME>(),
+                          std::array<uint8_t, 16>{0x6e, 0xcf, 0xee, 0xb1, 0xe8, 0xf8, 0x01, 0x10, 'E', '/', 'B', 'e', 'r', 'l', 'i', 'n'}),
+              "Time encodes at compile time");
+
+static constexpr ct_timestamp decode_at_compile_time(const std::array<uint8_t, 12>& bytes)
+{
+    ct_timestamp timestamp {};
+    ct::decode(bytes.data(), bytes.size(), timestamp);
+    return timestamp;
+}
+static constexpr ct_timestamp DECODED = decode_at_compile_time(LOCATION_TIMESTAMP_BYTES);
+static_assert(DECODED.date.year == 3190 && DECODED.time.nanosecond == 394129000 &&
+              DECODED.time.timezone.latitude == 5994 && DECODED.time.timezone.longitude == 1071,
+              "Timestamp decodes at compile time");
+
+static std::vector<ct_timestamp> make_timestamps()
+{
+    std::vector<ct_timestamp> timestamps;
+    for(int year: { -1000000, -65, 1, 1999, 2000, 2064, 3190, 1000000 })
+    {
+        for(uint32_t nanosecond: { 0u, 5000000u, 999999u, 123456789u })
+        {
+            for(ct_tz_type type: { CT_TZ_ZERO, CT_TZ_STRING, CT_TZ_LATLONG })
+            {
+                ct_timestamp timestamp {};
+                timestamp.date = {year, 12, 31};
+                timestamp.time.hour = 23;
+                timestamp.time.minute = 59;
+                timestamp.time.second = 60;
+                timestamp.time.nanosecond = nanosecond;
+                timestamp.time.timezone.type = type;
+                strcpy(timestamp.time.timezone.as_string, "America/Argentina/ComodRivadavia");
+                timestamp.time.timezone.latitude = -8999;
+                timestamp.time.timezone.longitude = 17999;
+                timestamps.push_back(timestamp);
+            }
+        }
+    }
+    return timestamps;
+}
+
+TEST(Constexpr, matches_library)
+{
+    for(const ct_timestamp& timestamp: make_timestamps())
+    {
+        uint8_t expected[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+        uint8_t actual[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+
+        int byte_count = ct_timestamp_encode(&timestamp, expected, sizeof(expected));
+        ASSERT_GT(byte_count, 0);
+        ASSERT_EQ(ct_timestamp_encoded_size(&timestamp), ct::encoded_size(timestamp));
+        ASSERT_EQ(byte_count, ct::encode(timestamp, actual, sizeof(actual)));
+        ASSERT_EQ(0, memcmp(expected, actual, byte_count));
+        ct_timestamp decoded {};
+        ASSERT_EQ(byte_count, ct::decode(expected, byte_count, decoded));
+        ASSERT_EQ(timestamp.date.year, decoded.date.year);
+        ASSERT_EQ(timestamp.time.nanosecond, decoded.time.nanosecond);
+        ASSERT_EQ(timestamp.time.timezone.type, decoded.time.timezone.type);
+        ASSERT_LT(ct::decode(expected, byte_count - 1, decoded), 0);
+
+        byte_count = ct_time_encode(&timestamp.time, expected, sizeof(expected));
+        ASSERT_GT(byte_count, 0);
+        ASSERT_EQ(ct_time_encoded_size(&timestamp.time), ct::encoded_size(timestamp.time));
+        ASSERT_EQ(byte_count, ct::encode(timestamp.time, actual, sizeof(actual)));
+        ASSERT_EQ(0, memcmp(expected, actual, byte_count));
+        ct_time decoded_time {};
+        ASSERT_EQ(byte_count, ct::decode(expected, byte_count, decoded_time));
+        ASSERT_EQ(timestamp.time.second, decoded_time.second);
+        ASSERT_EQ(timestamp.time.nanosecond, decoded_time.nanosecond);
+
+        byte_count = ct_date_encode(&timestamp.date, expected, sizeof(expected));
+        ASSERT_GT(byte_count, 0);
+        ASSERT_EQ(ct_date_encoded_size(&timestamp.date), ct::encoded_size(timestamp.date));
+        ASSERT_EQ(byte_count, ct::encode(timestamp.date, actual, sizeof(actual)));
+        ASSERT_EQ(0, memcmp(expected, actual, byte_count));
+        ct_date decoded_date {};
+        ASSERT_EQ(byte_count, ct::decode(expected, byte_count, decoded_date));
+        ASSERT_EQ(timestamp.date.year, decoded_date.year);
+    }
+}
+
+TEST(Constexpr, fixed_magnitude_and_timezone)
+{
+    ct_timestamp timestamp = LOCATION_TIMESTAMP;
+    uint8_t actual[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    int byte_count = ct::encode_timestamp<2, CT_TZ_LATLONG>(timestamp, actual, sizeof(actual));
+    ASSERT_EQ((int)LOCATION_TIMESTAMP_BYTES.size(), byte_count);
+    ASSERT_EQ(0, memcmp(LOCATION_TIMESTAMP_BYTES.data(), actual, byte_count));
+
+    timestamp.time.timezone.type = CT_TZ_ZERO;
+    uint8_t expected[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    byte_count = ct_timestamp_encode(&timestamp, expected, sizeof(expected));
+    ASSERT_EQ(byte_count, (ct::encode_timestamp<2, CT_TZ_ZERO>(timestamp, actual, sizeof(actual))));
+    ASSERT_EQ(0, memcmp(expected, actual, byte_count));
+
+    byte_count = ct_time_encode(&timestamp.time, expected, sizeof(expected));
+    ASSERT_EQ(byte_count, (ct::encode_time<2, CT_TZ_ZERO>(timestamp.time, actual, sizeof(actual))));
+    ASSERT_EQ(0, memcmp(expected, actual, byte_count));
+}
+
+TEST(Constexpr, errors)
+{
+    ct_timestamp timestamp = LOCATION_TIMESTAMP;
+    uint8_t buffer[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    ASSERT_EQ(ct_timestamp_encode(&timestamp, buffer, 5), ct::encode(timestamp, buffer, 5));
+    ASSERT_EQ(ct_timestamp_encode(&timestamp, buffer, 9), ct::encode(timestamp, buffer, 9));
+
+    timestamp.time.timezone.latitude = 9001;
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct::encode(timestamp, buffer, sizeof(buffer)));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct::encode(timestamp).length);
+
+    // The name scan stops at the end of the buffer, as in the library.
+    timestamp.time.timezone.type = CT_TZ_STRING;
+    memset(timestamp.time.timezone.as_string, 'x', sizeof(timestamp.time.timezone.as_string));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct::encoded_size(timestamp));
+    ASSERT_EQ(ct_timestamp_encoded_size(&timestamp), ct::encoded_size(timestamp));
+    ASSERT_EQ(ct_time_encoded_size(&timestamp.time), ct::encoded_size(timestamp.time));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct::encode(timestamp, buffer, sizeof(buffer)));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct::encode(timestamp.time, buffer, sizeof(buffer)));
+
+    // An unknown timezone type must not select another magnitude's encoder.
+    timestamp = LOCATION_TIMESTAMP;
+    timestamp.time.nanosecond = 0;
+    timestamp.time.timezone.type = static_cast<ct_tz_type>(3);
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_encode(&timestamp, buffer, sizeof(buffer)));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct::encode(timestamp, buffer, sizeof(buffer)));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct::encode(timestamp.time, buffer, sizeof(buffer)));
+    ASSERT_EQ(ct_timestamp_encoded_size(&timestamp), ct::encoded_size(timestamp));
+    ASSERT_EQ(ct_time_encoded_size(&timestamp.time), ct::encoded_size(timestamp.time));
+}
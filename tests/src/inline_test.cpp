@@ -0,0 +1,45 @@
+// Exercises the header-only build. Every codec function used here is a
+// static inline copy compiled into this file, not the shared library's.
+#include <gtest/gtest.h>
+#include <compact_time/compact_time_inline.h>
+#include <vector>
+
+#if defined(COMPACT_TIME_PUBLIC) || defined(COMPACT_TIME_INTERNAL)
+    #error "compact_time_inline.h leaked its linkage macros"
+#endif
+
+TEST(Inline, version)
+{
+    ASSERT_STREQ("1.0.0", ct_version());
+}
+
+TEST(Inline, timestamp)
+{
+    // August 31, 3190, 00:54:47.394129, location 59.94, 10.71
+    std::vector<uint8_t> expected = {0xbe, 0x36, 0xf8, 0x18, 0x39, 0x60, 0xa5, 0x18, 0xd5, 0x2e, 0x2f, 0x04};
+    ct_timestamp timestamp;
+    memset(&timestamp, 0, sizeof(timestamp));
+    ASSERT_EQ(expected.size(), ct_timestamp_decode(expected.data(), expected.size(), &timestamp));
+    ASSERT_EQ(3190, timestamp.date.year);
+    ASSERT_EQ(394129000u, timestamp.time.nanosecond);
+    ASSERT_EQ(CT_TZ_LATLONG, timestamp.time.timezone.type);
+
+    std::vector<uint8_t> actual(ct_timestamp_encoded_size(&timestamp));
+    ASSERT_EQ(expected.size(), ct_timestamp_encode(&timestamp, actual.data(), actual.size()));
+    ASSERT_EQ(expected, actual);
+}
+
+TEST(Inline, date_and_time)
+{
+    ct_date date = {2031, 10, 30};
+    std::vector<uint8_t> expected = {0x5e, 0x01, 0x3e};
+    std::vector<uint8_t> actual(ct_date_encoded_size(&date));
+    ASSERT_EQ(expected.size(), ct_date_encode(&date, actual.data(), actual.size()));
+    ASSERT_EQ(expected, actual);
+
+    ct_time time;
+    memset(&time, 0, sizeof(time));
+    expected = {0x05, 0xe4, 0x23, 0x45, 0xef};
+    ASSERT_EQ(expected.size(), ct_time_decode(expected.data(), expected.size(), &time));
+    ASSERT_EQ(980050000u, time.nanosecond);
+}
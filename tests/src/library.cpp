@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <compact_time/compact_time.h>
+#include <time.h>
 
 // #define KSLog_LocalMinLevel KSLOG_LEVEL_TRACE
 #include <kslog/kslog.h>
@@ -187,6 +188,8 @@ TEST(CDate, timestamp_loc_ ## YEAR ## _ ## MONTH ## _ ## DAY ## _ ## HOUR ## _ #
 
 TEST_DATE( , 2000,1,1, {0x21, 0x00, 0x00})
 TEST_DATE(-, 2000,12,21, {0x95, 0x7d, 0x3f})
+// The leading year group is zero, and must still be written
+TEST_DATE( , 10192,1,1, {0x21, 0x02, 0x80, 0x00})
 
 
 
@@ -202,6 +205,22 @@ TEST_TIME_TZ_LOC(7, 45, 0, 1000000, -3876, 2730, {0x3a, 0x2d, 0x10, 0x00, 0xb9,
 TEST_TIME_TZ_LOC(7, 45, 0, 2000000, -9000, -18000, {0x3a, 0x2d, 0x20, 0x00, 0xb1, 0xb9, 0xb0, 0xb9})
 TEST_TIME_TZ_LOC(7, 45, 0, 3000000, 9000, 18000, {0x3a, 0x2d, 0x30, 0x00, 0x51, 0x46, 0x50, 0x46})
 
+TEST(CDate, time_timezone_out_of_range)
+{
+    ct_time time;
+    fill_time(&time, 7, 45, 0, 0);
+    fill_timezone_loc(&time.timezone, 9001, 0);
+    uint8_t buffer[CT_TIME_MAX_ENCODED_SIZE + 1];
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_time_encode(&time, buffer, sizeof(buffer)));
+
+    // Longest name the format allows, which doesn't fit in ct_timezone.
+    fill_timezone_named(&time.timezone, "E/Berlin");
+    const int offset = ct_time_encode(&time, buffer, sizeof(buffer)) - 9;
+    buffer[offset] = 63 << 1;
+    memset(buffer + offset + 1, 'x', 63);
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_time_decode(buffer, offset + 64, &time));
+}
+
 
 // ---------
 // Timestamp
@@ -222,6 +241,7 @@ TEST_TIMESTAMP_TZ_UTC( ,  2000,1,1,0,0,0,      999, {0x03, 0x00, 0x08, 0x71, 0x3
 TEST_TIMESTAMP_TZ_UTC( ,  2009,1,1,0,0,0,        0, {0x00, 0x00, 0x08, 0x01, 0x25})
 TEST_TIMESTAMP_TZ_UTC( ,  3009,1,1,0,0,0,        0, {0x00, 0x00, 0x08, 0x01, 0x9f, 0x45})
 TEST_TIMESTAMP_TZ_UTC(-, 50000,1,1,0,0,0,        0, {0x00, 0x00, 0x08, 0xc1, 0xd8, 0x7f})
+TEST_TIMESTAMP_TZ_UTC( ,  6096,1,1,0,0,0,  1000000, {0x01, 0x00, 0x08, 0x11, 0x40, 0x80, 0x01})
 
 
 
@@ -249,3 +269,575 @@ TEST_DATE( , 2051,10,22, {0x56, 0x01, 0x66})
 TEST_TIME_TZ_NAMED(13, 15, 59, 529435422, "E/Berlin", {0x6e, 0xcf, 0xee, 0xb1, 0xe8, 0xf8, 0x01, 0x10, 'E', '/', 'B', 'e', 'r', 'l', 'i', 'n'})
 
 TEST_TIMESTAMP_TZ_LOC( , 1985, 10, 26, 1, 22, 16, 0, 3399, -11793, {0x40, 0x56, 0xd0, 0x0a, 0x3a, 0x8f, 0x1a, 0xef, 0xd1})
+
+
+
+// -----
+// Batch
+// -----
+
+static std::vector<ct_timestamp> make_batch_timestamps()
+{
+    std::vector<ct_timestamp> timestamps(4);
+    fill_timestamp(&timestamps[0], 2020,8,30,15,33,14,19577323);
+    fill_timezone_utc(&timestamps[0].time.timezone);
+    fill_timestamp(&timestamps[1], 2020,8,30,15,33,15,19577323);
+    fill_timezone_utc(&timestamps[1].time.timezone);
+    fill_timestamp(&timestamps[2], 1998,1,7,8,19,20,0);
+    fill_timezone_named(&timestamps[2].time.timezone, "E/Rome");
+    fill_timestamp(&timestamps[3], 3190,8,31,0,54,47,394129000);
+    fill_timezone_loc(&timestamps[3].time.timezone, 5994, 1071);
+    return timestamps;
+}
+
+TEST(Batch, encode_decode)
+{
+    std::vector<ct_timestamp> timestamps = make_batch_timestamps();
+    std::vector<uint8_t> expected;
+    std::vector<int> expected_offsets;
+    for(const ct_timestamp& timestamp: timestamps)
+    {
+        uint8_t buffer[100];
+        int byte_count = ct_timestamp_encode(&timestamp, buffer, sizeof(buffer));
+        ASSERT_GT(byte_count, 0);
+        expected_offsets.push_back(expected.size());
+        expected.insert(expected.end(), buffer, buffer + byte_count);
+    }
+
+    std::vector<uint8_t> actual(expected.size());
+    std::vector<int> offsets(timestamps.size());
+    int records_processed = 0;
+    int bytes_encoded = ct_timestamp_encode_batch(timestamps.data(), timestamps.size(), actual.data(), actual.size(), offsets.data(), &records_processed);
+    ASSERT_EQ(expected.size(), bytes_encoded);
+    ASSERT_EQ(timestamps.size(), records_processed);
+    ASSERT_EQ(expected, actual);
+    ASSERT_EQ(expected_offsets, offsets);
+
+    std::vector<ct_timestamp> decoded(timestamps.size() + 1);
+    memset(decoded.data(), 0, decoded.size() * sizeof(decoded[0]));
+    std::fill(offsets.begin(), offsets.end(), 0);
+    int bytes_decoded = ct_timestamp_decode_batch(actual.data(), actual.size(), decoded.data(), decoded.size(), offsets.data(), &records_processed);
+    ASSERT_EQ(expected.size(), bytes_decoded);
+    ASSERT_EQ(timestamps.size(), records_processed);
+    ASSERT_EQ(expected_offsets, offsets);
+    for(size_t i = 0; i < timestamps.size(); i++)
+    {
+        ASSERT_DATE_EQ(decoded[i].date, timestamps[i].date);
+        ASSERT_TIME_EQ(decoded[i].time, timestamps[i].time);
+    }
+}
+
+TEST(Batch, encode_stops_at_first_failure)
+{
+    std::vector<ct_timestamp> timestamps = make_batch_timestamps();
+    std::vector<uint8_t> buffer(20);
+    int records_processed = -1;
+    int result = ct_timestamp_encode_batch(timestamps.data(), timestamps.size(), buffer.data(), buffer.size(), NULL, &records_processed);
+    ASSERT_LT(result, 0);
+    ASSERT_EQ(2, records_processed);
+}
+
+TEST(Batch, decode_stops_at_truncated_record)
+{
+    std::vector<ct_timestamp> timestamps = make_batch_timestamps();
+    std::vector<uint8_t> buffer(100);
+    int bytes_encoded = ct_timestamp_encode_batch(timestamps.data(), timestamps.size(), buffer.data(), buffer.size(), NULL, NULL);
+    ASSERT_GT(bytes_encoded, 0);
+
+    std::vector<ct_timestamp> decoded(timestamps.size());
+    int records_processed = -1;
+    int result = ct_timestamp_decode_batch(buffer.data(), bytes_encoded - 1, decoded.data(), decoded.size(), NULL, &records_processed);
+    ASSERT_LT(result, 0);
+    ASSERT_EQ(3, records_processed);
+}
+
+TEST(Batch, encoded_size_total)
+{
+    std::vector<ct_timestamp> timestamps = make_batch_timestamps();
+    std::vector<uint8_t> buffer(100);
+    int bytes_encoded = ct_timestamp_encode_batch(timestamps.data(), timestamps.size(), buffer.data(), buffer.size(), NULL, NULL);
+    ASSERT_EQ(bytes_encoded, ct_timestamps_encoded_size_total(timestamps.data(), timestamps.size()));
+    ASSERT_EQ(0, ct_timestamps_encoded_size_total(timestamps.data(), 0));
+}
+
+TEST(Size, matches_encoded_length)
+{
+    const int years[] = { -1000000, -8193, -65, -1, 0, 1, 63, 64, 1999, 2000, 2001, 2063, 2064, 10000, 1000000 };
+    const uint32_t nanoseconds[] = { 0, 1, 999, 1000, 1001, 999000, 999999, 1000000, 1000001, 5000000, 123456789, 999000000, 999999999 };
+    for(int year: years)
+    {
+        for(uint32_t nanosecond: nanoseconds)
+        {
+            ct_timestamp timestamp;
+            memset(&timestamp, 0, sizeof(timestamp));
+            timestamp.date.year = year;
+            timestamp.date.month = 1;
+            timestamp.date.day = 1;
+            timestamp.time.nanosecond = nanosecond;
+            timestamp.time.timezone.type = CT_TZ_ZERO;
+            uint8_t buffer[100];
+            ASSERT_EQ(ct_timestamp_encode(&timestamp, buffer, sizeof(buffer)), ct_timestamp_encoded_size(&timestamp)) << year << " " << nanosecond;
+
+            ct_date date = timestamp.date;
+            ASSERT_EQ(ct_date_encode(&date, buffer, sizeof(buffer)), ct_date_encoded_size(&date)) << year;
+        }
+    }
+}
+
+
+
+// ---------
+// Unchecked
+// ---------
+
+TEST(Unchecked, matches_checked)
+{
+    std::vector<ct_timestamp> timestamps = make_batch_timestamps();
+    for(int year: { -1000000, -65, 0, 2000, 2064, 1000000 })
+    {
+        for(uint32_t nanosecond: { 0, 5000000, 999999, 123456789 })
+        {
+            ct_timestamp timestamp;
+            fill_timestamp(&timestamp, year, 12, 31, 23, 59, 60, nanosecond);
+            fill_timezone_named(&timestamp.time.timezone, "America/Argentina/ComodRivadavia");
+            timestamps.push_back(timestamp);
+        }
+    }
+
+    for(const ct_timestamp& timestamp: timestamps)
+    {
+        uint8_t expected[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+        uint8_t actual[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+
+        int byte_count = ct_timestamp_encode(&timestamp, expected, sizeof(expected));
+        ASSERT_GT(byte_count, 0);
+        ASSERT_EQ(byte_count, ct_timestamp_encode_unchecked(&timestamp, actual));
+        ASSERT_EQ(0, memcmp(expected, actual, byte_count));
+
+        byte_count = ct_time_encode(&timestamp.time, expected, sizeof(expected));
+        ASSERT_GT(byte_count, 0);
+        ASSERT_EQ(byte_count, ct_time_encode_unchecked(&timestamp.time, actual));
+        ASSERT_EQ(0, memcmp(expected, actual, byte_count));
+
+        byte_count = ct_date_encode(&timestamp.date, expected, sizeof(expected));
+        ASSERT_GT(byte_count, 0);
+        ASSERT_EQ(byte_count, ct_date_encode_unchecked(&timestamp.date, actual));
+        ASSERT_EQ(0, memcmp(expected, actual, byte_count));
+    }
+}
+
+TEST(Unchecked, out_of_range)
+{
+    ct_timestamp timestamp;
+    fill_timestamp(&timestamp, 2000, 1, 1, 0, 0, 0, 0);
+    fill_timezone_loc(&timestamp.time.timezone, 9001, 0);
+    uint8_t buffer[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_encode_unchecked(&timestamp, buffer));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_time_encode_unchecked(&timestamp.time, buffer));
+}
+
+TEST(Unchecked, max_encoded_sizes)
+{
+    ct_timestamp timestamp;
+    fill_timestamp(&timestamp, -1000000, 12, 31, 23, 59, 60, 999999999);
+    fill_timezone_named(&timestamp.time.timezone, "0123456789012345678901234567890123456789");
+    ASSERT_LE(ct_timestamp_encoded_size(&timestamp), CT_TIMESTAMP_MAX_ENCODED_SIZE);
+    ASSERT_LE(ct_time_encoded_size(&timestamp.time), CT_TIME_MAX_ENCODED_SIZE);
+    ASSERT_LE(ct_date_encoded_size(&timestamp.date), CT_DATE_MAX_ENCODED_SIZE);
+}
+
+
+
+// ----
+// View
+// ----
+
+TEST(View, matches_decode)
+{
+    std::vector<ct_timestamp> timestamps = make_batch_timestamps();
+    for(const ct_timestamp& timestamp: timestamps)
+    {
+        uint8_t buffer[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+        int byte_count = ct_timestamp_encode(&timestamp, buffer, sizeof(buffer));
+        ASSERT_GT(byte_count, 0);
+
+        ct_timestamp_view view;
+        ASSERT_EQ(byte_count, ct_timestamp_decode_view(buffer, byte_count, &view));
+        ASSERT_DATE_EQ(view.date, timestamp.date);
+        ASSERT_EQ(timestamp.time.hour, view.hour);
+        ASSERT_EQ(timestamp.time.minute, view.minute);
+        ASSERT_EQ(timestamp.time.second, view.second);
+        ASSERT_EQ(timestamp.time.nanosecond, view.nanosecond);
+        ASSERT_EQ(timestamp.time.timezone.type, view.timezone.type);
+        if(view.timezone.type == CT_TZ_STRING)
+        {
+            ASSERT_EQ(std::string(timestamp.time.timezone.as_string), std::string(view.timezone.name, view.timezone.name_length));
+            ASSERT_GE((const uint8_t*)view.timezone.name, buffer);
+            ASSERT_LT((const uint8_t*)view.timezone.name, buffer + byte_count);
+        }
+        else if(view.timezone.type == CT_TZ_LATLONG)
+        {
+            ASSERT_EQ(timestamp.time.timezone.latitude, view.timezone.latitude);
+            ASSERT_EQ(timestamp.time.timezone.longitude, view.timezone.longitude);
+        }
+
+        ASSERT_LT(ct_timestamp_decode_view(buffer, byte_count - 1, &view), 0);
+    }
+}
+
+TEST(View, long_timezone_name)
+{
+    ct_timestamp timestamp;
+    fill_timestamp(&timestamp, 2020, 1, 1, 0, 0, 0, 0);
+    fill_timezone_named(&timestamp.time.timezone, "E/Rome");
+    uint8_t buffer[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    int offset = ct_timestamp_encode(&timestamp, buffer, sizeof(buffer)) - 7;
+
+    // Longest name the format allows, which doesn't fit in ct_timezone.
+    const std::string name(63, 'x');
+    buffer[offset] = name.size() << 1;
+    memcpy(buffer + offset + 1, name.data(), name.size());
+    const int byte_count = offset + 1 + name.size();
+
+    ct_timestamp_view view;
+    ASSERT_EQ(byte_count, ct_timestamp_decode_view(buffer, byte_count, &view));
+    ASSERT_EQ(CT_TZ_STRING, view.timezone.type);
+    ASSERT_EQ(name, std::string(view.timezone.name, view.timezone.name_length));
+
+    ct_timestamp decoded;
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_decode(buffer, byte_count, &decoded));
+}
+
+
+
+// --------------
+// Timezone Names
+// --------------
+
+static std::string make_timezone_name(int length)
+{
+    std::string name;
+    for(int i = 0; i < length; i++)
+    {
+        name += (char)(' ' + (i * 7) % ('~' - ' ' + 1));
+    }
+    return name;
+}
+
+TEST(TimezoneName, every_length)
+{
+    ct_timestamp timestamp;
+    fill_timestamp(&timestamp, 2020, 1, 1, 0, 0, 0, 0);
+    for(int length = 0; length < (int)sizeof(timestamp.time.timezone.as_string); length++)
+    {
+        const std::string name = make_timezone_name(length);
+        fill_timezone_named(&timestamp.time.timezone, name.c_str());
+        uint8_t buffer[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+        const int byte_count = ct_timestamp_encode(&timestamp, buffer, sizeof(buffer));
+        ASSERT_EQ(byte_count, ct_timestamp_encoded_size(&timestamp)) << "length " << length;
+        ASSERT_EQ(byte_count, ct_timestamp_encode_unchecked(&timestamp, buffer)) << "length " << length;
+
+        ct_timestamp decoded;
+        ASSERT_EQ(byte_count, ct_timestamp_decode(buffer, byte_count, &decoded)) << "length " << length;
+        ASSERT_STREQ(name.c_str(), decoded.time.timezone.as_string);
+
+        for(int position = 0; position < length; position++)
+        {
+            for(char ch: {'\x01', '\x1f', '\x7f', '\x80', '\xff'})
+            {
+                timestamp.time.timezone.as_string[position] = ch;
+                ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_encode(&timestamp, buffer, sizeof(buffer)))
+                    << "length " << length << ", position " << position;
+                ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_encode_unchecked(&timestamp, buffer));
+                ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_time_encode(&timestamp.time, buffer, sizeof(buffer)));
+            }
+            timestamp.time.timezone.as_string[position] = name[position];
+        }
+    }
+}
+
+TEST(TimezoneName, unterminated)
+{
+    ct_timestamp timestamp;
+    fill_timestamp(&timestamp, 2020, 1, 1, 0, 0, 0, 0);
+    fill_timezone_named(&timestamp.time.timezone, "E/Rome");
+    memset(timestamp.time.timezone.as_string, 'x', sizeof(timestamp.time.timezone.as_string));
+    uint8_t buffer[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_encode(&timestamp, buffer, sizeof(buffer)));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_encode_unchecked(&timestamp, buffer));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_encoded_size(&timestamp));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_time_encoded_size(&timestamp.time));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamps_encoded_size_total(&timestamp, 1));
+}
+
+TEST(Timezone, unknown_type)
+{
+    ct_timestamp timestamp;
+    fill_timestamp(&timestamp, 2020, 1, 1, 0, 0, 0, 0);
+    uint8_t buffer[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    static_assert(sizeof(timestamp.time.timezone.type) == sizeof(int), "ct_tz_type must be int sized");
+    for(const int type: {3, 100000})
+    {
+        // Stored as the C library would see it, without forming the enum value in C++.
+        memcpy(&timestamp.time.timezone.type, &type, sizeof(type));
+        ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_encode(&timestamp, buffer, sizeof(buffer))) << type;
+        ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_encode_unchecked(&timestamp, buffer)) << type;
+        ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_encoded_size(&timestamp)) << type;
+        ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_time_encode(&timestamp.time, buffer, sizeof(buffer))) << type;
+        ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_time_encode_unchecked(&timestamp.time, buffer)) << type;
+        ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_time_encoded_size(&timestamp.time)) << type;
+    }
+}
+
+TEST(TimezoneName, decode_rejects_unprintable)
+{
+    ct_timestamp timestamp;
+    fill_timestamp(&timestamp, 2020, 1, 1, 0, 0, 0, 0);
+    fill_timezone_named(&timestamp.time.timezone, "E/Rome");
+    uint8_t encoded[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    const int base_byte_count = ct_timestamp_encode(&timestamp, encoded, sizeof(encoded)) - 7;
+
+    for(int length = 0; length <= 63; length++)
+    {
+        // Decode both with the name at the end of the buffer and with bytes
+        // after it, which the scan may read but must not judge.
+        const std::string name = make_timezone_name(length);
+        std::vector<uint8_t> buffer(encoded, encoded + base_byte_count);
+        buffer.push_back(length << 1);
+        buffer.insert(buffer.end(), name.begin(), name.end());
+        const int byte_count = buffer.size();
+        for(int padding: {0, 32})
+        {
+            buffer.resize(byte_count + padding, 0x01);
+            ct_timestamp_view view;
+            ASSERT_EQ(byte_count, ct_timestamp_decode_view(buffer.data(), buffer.size(), &view)) << "length " << length;
+            for(int position = 0; position < length; position++)
+            {
+                uint8_t& ch = buffer[base_byte_count + 1 + position];
+                ch = 0x7f;
+                ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_decode_view(buffer.data(), buffer.size(), &view))
+                    << "length " << length << ", position " << position;
+                if(length < (int)sizeof(timestamp.time.timezone.as_string))
+                {
+                    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_decode(buffer.data(), buffer.size(), &timestamp));
+                }
+                ch = name[position];
+            }
+        }
+    }
+
+    // The length byte allows up to 127, but no encoder writes more than 63.
+    for(int length: {64, 100, 127})
+    {
+        const std::string name = make_timezone_name(length);
+        std::vector<uint8_t> buffer(encoded, encoded + base_byte_count);
+        buffer.push_back(length << 1);
+        buffer.insert(buffer.end(), name.begin(), name.end());
+        ct_timestamp_view view;
+        ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_decode_view(buffer.data(), buffer.size(), &view)) << "length " << length;
+        ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_decode(buffer.data(), buffer.size(), &timestamp)) << "length " << length;
+    }
+}
+
+
+
+// ---------
+// Unix Time
+// ---------
+
+TEST(UnixTime, matches_gmtime)
+{
+    static const int64_t seconds[] = {0, 1, -1, 59, 86399, 86400, -86400, 951782400, 1561398784, -2208988800LL, 4102444799LL, -5000000000LL, 9000000000LL};
+    for(int64_t second: seconds)
+    {
+        time_t t = second;
+        struct tm expected;
+        ASSERT_TRUE(gmtime_r(&t, &expected) != NULL);
+
+        ct_timestamp timestamp;
+        ct_timestamp_from_unix_ns(second * 1000000000 + 123, &timestamp);
+        ASSERT_EQ(expected.tm_year + 1900, timestamp.date.year) << second;
+        ASSERT_EQ(expected.tm_mon + 1, timestamp.date.month) << second;
+        ASSERT_EQ(expected.tm_mday, timestamp.date.day) << second;
+        ASSERT_EQ(expected.tm_hour, timestamp.time.hour) << second;
+        ASSERT_EQ(expected.tm_min, timestamp.time.minute) << second;
+        ASSERT_EQ(expected.tm_sec, timestamp.time.second) << second;
+        ASSERT_EQ(123u, timestamp.time.nanosecond) << second;
+        ASSERT_EQ(CT_TZ_ZERO, timestamp.time.timezone.type);
+
+        int64_t unix_ns = 0;
+        ASSERT_EQ(0, ct_timestamp_to_unix_ns(&timestamp, &unix_ns));
+        ASSERT_EQ(second * 1000000000 + 123, unix_ns);
+    }
+}
+
+TEST(UnixTime, round_trip_extremes)
+{
+    static const int64_t values[] = {INT64_MIN, INT64_MIN + 1, -1, 0, 1, INT64_MAX - 1, INT64_MAX};
+    for(int64_t value: values)
+    {
+        ct_timestamp timestamp;
+        ct_timestamp_from_unix_ns(value, &timestamp);
+        int64_t unix_ns = 0;
+        ASSERT_EQ(0, ct_timestamp_to_unix_ns(&timestamp, &unix_ns));
+        ASSERT_EQ(value, unix_ns);
+    }
+}
+
+TEST(UnixTime, out_of_range)
+{
+    ct_timestamp timestamp;
+    fill_timestamp(&timestamp, 2263,1,1,0,0,0,0);
+    fill_timezone_utc(&timestamp.time.timezone);
+    int64_t unix_ns = 0;
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_to_unix_ns(&timestamp, &unix_ns));
+
+    fill_timestamp(&timestamp, 2000,1,1,0,0,0,0);
+    fill_timezone_named(&timestamp.time.timezone, "E/Berlin");
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_to_unix_ns(&timestamp, &unix_ns));
+
+    fill_timestamp(&timestamp, 2000,13,1,0,0,0,0);
+    fill_timezone_utc(&timestamp.time.timezone);
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_to_unix_ns(&timestamp, &unix_ns));
+}
+
+TEST(UnixTime, month_length)
+{
+    const int valid[][3] = {{2000,2,29}, {2004,2,29}, {2001,2,28}, {2001,1,31}, {2001,4,30}, {2001,12,31}};
+    const int invalid[][3] = {{2000,2,30}, {1900,2,29}, {2100,2,29}, {2001,2,29}, {2001,4,31}, {2001,6,31},
+                              {2001,9,31}, {2001,11,31}, {2001,1,32}};
+    ct_timestamp timestamp;
+    int64_t unix_ns = 0;
+    for(const auto& date: valid)
+    {
+        fill_timestamp(&timestamp, date[0],date[1],date[2],0,0,0,0);
+        fill_timezone_utc(&timestamp.time.timezone);
+        ASSERT_EQ(0, ct_timestamp_to_unix_ns(&timestamp, &unix_ns)) << date[0] << "-" << date[1] << "-" << date[2];
+    }
+    for(const auto& date: invalid)
+    {
+        fill_timestamp(&timestamp, date[0],date[1],date[2],0,0,0,0);
+        fill_timezone_utc(&timestamp.time.timezone);
+        ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_to_unix_ns(&timestamp, &unix_ns)) << date[0] << "-" << date[1] << "-" << date[2];
+    }
+}
+
+TEST(UnixTime, leap_second)
+{
+    ct_timestamp timestamp;
+    fill_timestamp(&timestamp, 2016,12,31,23,59,60,0);
+    fill_timezone_utc(&timestamp.time.timezone);
+    int64_t unix_ns = 0;
+    ASSERT_EQ(0, ct_timestamp_to_unix_ns(&timestamp, &unix_ns));
+    ASSERT_EQ(1483228800LL * 1000000000, unix_ns);
+}
+
+TEST(UnixTime, encode_decode)
+{
+    // June 24, 2019, 17:53:04.180
+    std::vector<uint8_t> expected = {0x11, 0x75, 0xc4, 0x46, 0x0b, 0x4d};
+    const int64_t expected_ns = 1561398784180000000LL;
+    std::vector<uint8_t> actual(expected.size());
+    ASSERT_EQ(expected.size(), ct_timestamp_encode_unix_ns(expected_ns, actual.data(), actual.size()));
+    ASSERT_EQ(expected, actual);
+    ASSERT_GT(0, ct_timestamp_encode_unix_ns(expected_ns, actual.data(), actual.size() - 1));
+
+    int64_t unix_ns = 0;
+    ASSERT_EQ(expected.size(), ct_timestamp_decode_unix_ns(expected.data(), expected.size(), &unix_ns));
+    ASSERT_EQ(expected_ns, unix_ns);
+
+    // January 7, 1998, 08:19:20, Europe/Rome
+    std::vector<uint8_t> named = {0x50, 0x13, 0x3a, 0x01, 0x06, 0x0c, 'E', '/', 'R', 'o', 'm', 'e'};
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_decode_unix_ns(named.data(), named.size(), &unix_ns));
+}
+
+// -----------
+// UTC Seconds
+// -----------
+
+static void assert_utc_seconds_matches_general(const ct_timestamp* timestamp)
+{
+    uint8_t expected[100];
+    uint8_t actual[100];
+    const int expected_length = ct_timestamp_encode(timestamp, expected, sizeof(expected));
+    ASSERT_GT(expected_length, 0);
+    ASSERT_EQ(expected_length, ct_timestamp_encode_utc_seconds(timestamp, actual, sizeof(actual)));
+    ASSERT_EQ(0, memcmp(expected, actual, expected_length));
+
+    ct_timestamp expected_decoded;
+    ct_timestamp actual_decoded;
+    memset(&expected_decoded, 0, sizeof(expected_decoded));
+    memset(&actual_decoded, 0, sizeof(actual_decoded));
+    ASSERT_EQ(expected_length, ct_timestamp_decode(actual, expected_length, &expected_decoded));
+    ASSERT_EQ(expected_length, ct_timestamp_decode_utc_seconds(actual, expected_length, &actual_decoded));
+    ASSERT_DATE_EQ(actual_decoded.date, expected_decoded.date);
+    ASSERT_TIME_EQ(actual_decoded.time, expected_decoded.time);
+}
+
+TEST(UtcSeconds, matches_general_path)
+{
+    for(int year = 1400; year <= 2600; year += 7)
+    {
+        for(int i = 0; i < 60; i += 13)
+        {
+            ct_timestamp timestamp;
+            fill_timestamp(&timestamp, year, 1 + i % 12, 1 + i % 31, i % 24, i, 59 - i, 0);
+            fill_timezone_utc(&timestamp.time.timezone);
+            assert_utc_seconds_matches_general(&timestamp);
+        }
+    }
+}
+
+TEST(UtcSeconds, fast_path_bounds)
+{
+    ct_timestamp timestamp;
+    uint8_t buffer[100];
+    fill_timezone_utc(&timestamp.time.timezone);
+
+    fill_timestamp(&timestamp, 1488,1,1,0,0,0,0);
+    ASSERT_EQ(5, ct_timestamp_encode_utc_seconds(&timestamp, buffer, sizeof(buffer)));
+    fill_timestamp(&timestamp, 2511,12,31,23,59,59,0);
+    ASSERT_EQ(5, ct_timestamp_encode_utc_seconds(&timestamp, buffer, sizeof(buffer)));
+    fill_timestamp(&timestamp, 1487,1,1,0,0,0,0);
+    ASSERT_EQ(6, ct_timestamp_encode_utc_seconds(&timestamp, buffer, sizeof(buffer)));
+    fill_timestamp(&timestamp, 2512,1,1,0,0,0,0);
+    ASSERT_EQ(6, ct_timestamp_encode_utc_seconds(&timestamp, buffer, sizeof(buffer)));
+}
+
+TEST(UtcSeconds, falls_back)
+{
+    ct_timestamp timestamp;
+
+    fill_timestamp(&timestamp, 2020,8,30,15,33,14,19577323);
+    fill_timezone_utc(&timestamp.time.timezone);
+    assert_utc_seconds_matches_general(&timestamp);
+
+    fill_timestamp(&timestamp, 1998,1,7,8,19,20,0);
+    fill_timezone_named(&timestamp.time.timezone, "E/Rome");
+    assert_utc_seconds_matches_general(&timestamp);
+
+    fill_timestamp(&timestamp, 1985,10,26,1,22,16,0);
+    fill_timezone_loc(&timestamp.time.timezone, 3399, -11793);
+    assert_utc_seconds_matches_general(&timestamp);
+
+    fill_timestamp(&timestamp, 50000,1,1,0,0,0,0);
+    fill_timezone_utc(&timestamp.time.timezone);
+    assert_utc_seconds_matches_general(&timestamp);
+}
+
+TEST(UtcSeconds, short_buffer)
+{
+    ct_timestamp timestamp;
+    fill_timestamp(&timestamp, 2000,1,1,0,0,0,0);
+    fill_timezone_utc(&timestamp.time.timezone);
+    uint8_t buffer[5];
+    for(int length = 0; length < 5; length++)
+    {
+        ASSERT_LT(ct_timestamp_encode_utc_seconds(&timestamp, buffer, length), 0);
+    }
+    ASSERT_EQ(5, ct_timestamp_encode_utc_seconds(&timestamp, buffer, 5));
+    for(int length = 0; length < 5; length++)
+    {
+        ASSERT_LT(ct_timestamp_decode_utc_seconds(buffer, length, &timestamp), 0);
+    }
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <compact_time/mapped_file.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "test_helpers.h"
+
+static std::vector<uint8_t> make_stream(int record_count)
+{
+    std::vector<ct_timestamp> timestamps(record_count);
+    for(int i = 0; i < record_count; i++)
+    {
+        ct_timestamp& timestamp = timestamps[i];
+        timestamp = make_timestamp(1900 + i % 300, 1 + i % 12, 1 + i % 28, i % 24, i % 60, (i * 7) % 60, (i % 4) * 123456789);
+        if(i % 2)
+        {
+            timestamp = make_named(timestamp, "E/Berlin");
+        }
+    }
+    return encode_all(timestamps);
+}
+
+static std::string write_temp_file(const std::vector<uint8_t>& contents)
+{
+    char path[] = "/tmp/compact_time_mapped_XXXXXX";
+    int fd = mkstemp(path);
+    EXPECT_GE(fd, 0);
+    if(!contents.empty())
+    {
+        EXPECT_EQ((ssize_t)contents.size(), write(fd, contents.data(), contents.size()));
+    }
+    close(fd);
+    return path;
+}
+
+TEST(MappedFile, walk_records)
+{
+    const int record_count = 500;
+    std::vector<uint8_t> stream = make_stream(record_count);
+    std::string path = write_temp_file(stream);
+
+    ct_mapped_file file;
+    ASSERT_TRUE(ct_mapped_file_open(&file, path.c_str()));
+    ASSERT_EQ((int64_t)stream.size(), file.length);
+
+    std::vector<ct_timestamp> expected(record_count);
+    ASSERT_EQ((int)stream.size(), ct_timestamp_decode_batch(stream.data(), stream.size(), expected.data(), record_count, NULL, NULL));
+
+    ct_record_cursor cursor;
+    ct_record_cursor_init_mapped(&cursor, &file);
+    ct_record_cursor span_cursor;
+    ct_record_cursor_init_mapped(&span_cursor, &file);
+    ct_record_cursor view_cursor;
+    ct_record_cursor_init_mapped(&view_cursor, &file);
+    for(int i = 0; i < record_count; i++)
+    {
+        const int64_t offset = ct_record_cursor_offset(&cursor);
+        ct_timestamp actual;
+        int byte_count = ct_record_cursor_next(&cursor, &actual);
+        ASSERT_GT(byte_count, 0);
+        ASSERT_EQ(expected[i].date.year, actual.date.year);
+        ASSERT_EQ(expected[i].time.nanosecond, actual.time.nanosecond);
+        ASSERT_EQ(expected[i].time.timezone.type, actual.time.timezone.type);
+
+        ct_record_span span;
+        ASSERT_EQ(byte_count, ct_record_cursor_next_span(&span_cursor, &span));
+        ASSERT_EQ(file.data + offset, span.data);
+        ASSERT_EQ(byte_count, span.length);
+
+        ct_timestamp_view view;
+        ASSERT_EQ(byte_count, ct_record_cursor_next_view(&view_cursor, &view));
+        ASSERT_EQ(expected[i].date.year, view.date.year);
+        ASSERT_EQ(expected[i].time.nanosecond, view.nanosecond);
+        ASSERT_EQ(expected[i].time.timezone.type, view.timezone.type);
+        if(view.timezone.type == CT_TZ_STRING)
+        {
+            ASSERT_EQ(std::string(expected[i].time.timezone.as_string),
+                      std::string(view.timezone.name, view.timezone.name_length));
+            ASSERT_GE((const uint8_t*)view.timezone.name, file.data + offset);
+            ASSERT_LT((const uint8_t*)view.timezone.name, file.data + offset + byte_count);
+        }
+    }
+    ct_timestamp actual;
+    ASSERT_EQ(0, ct_record_cursor_next(&cursor, &actual));
+    ASSERT_EQ((int64_t)stream.size(), ct_record_cursor_offset(&cursor));
+
+    ct_mapped_file_close(&file);
+    unlink(path.c_str());
+}
+
+TEST(MappedFile, truncated)
+{
+    std::vector<uint8_t> stream = make_stream(10);
+    stream.pop_back();
+
+    ct_record_cursor cursor;
+    ct_record_cursor_init(&cursor, stream.data(), stream.size());
+    ct_record_span span;
+    int result = 0;
+    while((result = ct_record_cursor_next_span(&cursor, &span)) > 0)
+    {
+    }
+    ASSERT_LT(result, 0);
+    const int64_t offset = ct_record_cursor_offset(&cursor);
+    ASSERT_LT(offset, (int64_t)stream.size());
+    ASSERT_LT(ct_record_cursor_next_span(&cursor, &span), 0);
+    ASSERT_EQ(offset, ct_record_cursor_offset(&cursor));
+}
+
+TEST(MappedFile, empty_and_missing)
+{
+    std::string path = write_temp_file(std::vector<uint8_t>());
+    ct_mapped_file file;
+    ASSERT_TRUE(ct_mapped_file_open(&file, path.c_str()));
+    ASSERT_EQ(0, file.length);
+    ct_record_cursor cursor;
+    ct_record_cursor_init_mapped(&cursor, &file);
+    ct_timestamp timestamp;
+    ASSERT_EQ(0, ct_record_cursor_next(&cursor, &timestamp));
+    ct_mapped_file_close(&file);
+    unlink(path.c_str());
+
+    ASSERT_FALSE(ct_mapped_file_open(&file, "/nonexistent/compact_time_file"));
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <compact_time/parallel_decode.h>
+#include <vector>
+#include "test_helpers.h"
+
+static const int RECORD_COUNT = 20000;
+
+static std::vector<ct_timestamp> make_timestamps(int record_count)
+{
+    std::vector<ct_timestamp> timestamps(record_count);
+    for(int i = 0; i < record_count; i++)
+    {
+        ct_timestamp& timestamp = timestamps[i];
+        timestamp = make_timestamp(1900 + i % 300, 1 + i % 12, 1 + i % 28, i % 24, i % 60, (i * 7) % 60, (i % 4) * 123456789);
+        if(i % 3 == 1)
+        {
+            timestamp = make_named(timestamp, "E/Berlin");
+        }
+        else if(i % 3 == 2)
+        {
+            timestamp = make_location(timestamp, -3876, 2730);
+        }
+    }
+    return timestamps;
+}
+
+TEST(ParallelDecode, matches_sequential)
+{
+    std::vector<ct_timestamp> timestamps = make_timestamps(RECORD_COUNT);
+    std::vector<uint8_t> encoded = encode_all(timestamps, NULL);
+
+    for(int thread_count: {1, 2, 4, 8, 64})
+    {
+        std::vector<ct_timestamp> actual(RECORD_COUNT);
+        int64_t records_processed = 0;
+        ASSERT_EQ((int64_t)encoded.size(), ct_timestamp_decode_parallel(encoded.data(), encoded.size(), actual.data(), RECORD_COUNT, thread_count, &records_processed));
+        ASSERT_EQ(RECORD_COUNT, records_processed);
+        for(int i = 0; i < RECORD_COUNT; i++)
+        {
+            assert_timestamps_equal(timestamps[i], actual[i]);
+        }
+    }
+}
+
+TEST(ParallelDecode, max_count)
+{
+    std::vector<ct_timestamp> timestamps = make_timestamps(RECORD_COUNT);
+    std::vector<int> record_offsets;
+    std::vector<uint8_t> encoded = encode_all(timestamps, &record_offsets);
+
+    const int max_count = 5000;
+    std::vector<ct_timestamp> actual(max_count);
+    int64_t records_processed = 0;
+    ASSERT_EQ(record_offsets[max_count], ct_timestamp_decode_parallel(encoded.data(), encoded.size(), actual.data(), max_count, 4, &records_processed));
+    ASSERT_EQ(max_count, records_processed);
+    assert_timestamps_equal(timestamps[max_count - 1], actual[max_count - 1]);
+}
+
+TEST(ParallelDecode, truncated)
+{
+    std::vector<ct_timestamp> timestamps = make_timestamps(RECORD_COUNT);
+    std::vector<uint8_t> encoded = encode_all(timestamps, NULL);
+    encoded.pop_back();
+
+    std::vector<ct_timestamp> actual(RECORD_COUNT);
+    int64_t records_processed = 0;
+    ASSERT_LT(ct_timestamp_decode_parallel(encoded.data(), encoded.size(), actual.data(), RECORD_COUNT, 4, &records_processed), 0);
+    ASSERT_EQ(RECORD_COUNT - 1, records_processed);
+}
+
+TEST(ParallelDecode, invalid_record)
+{
+    std::vector<ct_timestamp> timestamps = make_timestamps(RECORD_COUNT);
+    std::vector<int> record_offsets;
+    std::vector<uint8_t> encoded = encode_all(timestamps, &record_offsets);
+
+    // Overwrite a lat/long timezone with an out of range latitude.
+    const int bad_record = 12002;
+    ASSERT_EQ(CT_TZ_LATLONG, timestamps[bad_record].time.timezone.type);
+    const uint32_t latlong = 1 | (16000 << 1);
+    memcpy(encoded.data() + record_offsets[bad_record + 1] - 4, &latlong, 4);
+
+    std::vector<ct_timestamp> actual(RECORD_COUNT);
+    int64_t records_processed = 0;
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_decode_parallel(encoded.data(), encoded.size(), actual.data(), RECORD_COUNT, 8, &records_processed));
+    ASSERT_EQ(bad_record, records_processed);
+}
+
+TEST(ParallelDecode, indexed_range)
+{
+    std::vector<ct_timestamp> timestamps = make_timestamps(RECORD_COUNT);
+    std::vector<int> record_offsets;
+    std::vector<uint8_t> encoded = encode_all(timestamps, &record_offsets);
+
+    ct_stream_index_builder builder;
+    ASSERT_TRUE(ct_stream_index_builder_init(&builder, 100));
+    ASSERT_EQ((int)encoded.size(), ct_stream_index_builder_scan(&builder, encoded.data(), encoded.size()));
+    std::vector<uint8_t> index_data(ct_stream_index_serialized_size(&builder));
+    ASSERT_EQ((int64_t)index_data.size(), ct_stream_index_serialize(&builder, index_data.data(), index_data.size()));
+    ct_stream_index_builder_free(&builder);
+    ct_stream_index index;
+    ASSERT_EQ(0, ct_stream_index_open(&index, index_data.data(), index_data.size(), encoded.data(), encoded.size()));
+
+    const int first_record = 5055;
+    const int record_count = 9000;
+    std::vector<ct_timestamp> actual(record_count);
+    int64_t records_processed = 0;
+    ASSERT_EQ(record_count, ct_stream_decode_parallel(&index, first_record, record_count, actual.data(), 4, &records_processed));
+    ASSERT_EQ(record_count, records_processed);
+    for(int i = 0; i < record_count; i++)
+    {
+        assert_timestamps_equal(timestamps[first_record + i], actual[i]);
+    }
+
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_stream_decode_parallel(&index, RECORD_COUNT - 10, 11, actual.data(), 4, NULL));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_stream_decode_parallel(&index, -1, 1, actual.data(), 4, NULL));
+}
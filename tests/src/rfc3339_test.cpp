@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+#include <compact_time/rfc3339.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "test_helpers.h"
+
+static int parse(const std::string& text, ct_timestamp* timestamp)
+{
+    memset(timestamp, 0, sizeof(*timestamp));
+    return ct_timestamp_parse_rfc3339(text.data(), text.size(), timestamp);
+}
+
+static std::string format(const ct_timestamp& timestamp)
+{
+    char text[CT_RFC3339_TIMESTAMP_MAX_LENGTH + 1];
+    const int length = ct_timestamp_format_rfc3339(&timestamp, text, sizeof(text));
+    EXPECT_GT(length, 0);
+    EXPECT_EQ(length, (int)strlen(text));
+    return length > 0 ? std::string(text, length) : "";
+}
+
+#define ASSERT_PARSE(TEXT, EXPECTED) \
+{ \
+    const std::string text = TEXT; \
+    ct_timestamp actual; \
+    ASSERT_EQ((int)text.size(), parse(text, &actual)) << text; \
+    ASSERT_TIMESTAMP_EQ(actual, EXPECTED); \
+}
+
+TEST(RFC3339, parse)
+{
+    ASSERT_PARSE("2020-08-30T15:33:14Z", make_timestamp(2020, 8, 30, 15, 33, 14, 0));
+    ASSERT_PARSE("2020-08-30t15:33:14z", make_timestamp(2020, 8, 30, 15, 33, 14, 0));
+    ASSERT_PARSE("2020-08-30 15:33:14Z", make_timestamp(2020, 8, 30, 15, 33, 14, 0));
+    ASSERT_PARSE("2020-08-30T15:33:14.1Z", make_timestamp(2020, 8, 30, 15, 33, 14, 100000000));
+    ASSERT_PARSE("2020-08-30T15:33:14.19577323Z", make_timestamp(2020, 8, 30, 15, 33, 14, 195773230));
+    ASSERT_PARSE("2020-08-30T15:33:14.123456789Z", make_timestamp(2020, 8, 30, 15, 33, 14, 123456789));
+    ASSERT_PARSE("2020-08-30T15:33:14.000000001Z", make_timestamp(2020, 8, 30, 15, 33, 14, 1));
+    ASSERT_PARSE("2016-12-31T23:59:60Z", make_timestamp(2016, 12, 31, 23, 59, 60, 0));
+    ASSERT_PARSE("2000-02-29T00:00:00Z", make_timestamp(2000, 2, 29, 0, 0, 0, 0));
+    ASSERT_PARSE("0001-01-01T00:00:00Z", make_timestamp(1, 1, 1, 0, 0, 0, 0));
+    // 1 BC
+    ASSERT_PARSE("0000-12-31T00:00:00Z", make_timestamp(-1, 12, 31, 0, 0, 0, 0));
+    ASSERT_PARSE("9999-12-31T23:59:59.999999999Z", make_timestamp(9999, 12, 31, 23, 59, 59, 999999999));
+
+    // Only the timestamp is read.
+    ct_timestamp timestamp;
+    ASSERT_EQ(20, parse("2020-08-30T15:33:14Z\", \"next\"", &timestamp));
+}
+
+TEST(RFC3339, parse_offsets)
+{
+    ASSERT_PARSE("2020-08-30T15:33:14+02:00", make_timestamp(2020, 8, 30, 13, 33, 14, 0));
+    ASSERT_PARSE("2020-08-30T15:33:14.5-05:30", make_timestamp(2020, 8, 30, 21, 3, 14, 500000000));
+    ASSERT_PARSE("2020-08-30T15:33:14-00:00", make_timestamp(2020, 8, 30, 15, 33, 14, 0));
+    ASSERT_PARSE("2020-03-01T01:00:00+02:00", make_timestamp(2020, 2, 29, 23, 0, 0, 0));
+    ASSERT_PARSE("2021-03-01T01:00:00+02:00", make_timestamp(2021, 2, 28, 23, 0, 0, 0));
+    ASSERT_PARSE("2020-01-01T00:30:00+01:00", make_timestamp(2019, 12, 31, 23, 30, 0, 0));
+    ASSERT_PARSE("2019-12-31T23:30:00-01:00", make_timestamp(2020, 1, 1, 0, 30, 0, 0));
+    ASSERT_PARSE("2020-04-30T23:00:00-23:59", make_timestamp(2020, 5, 1, 22, 59, 0, 0));
+    ASSERT_PARSE("2016-12-31T18:59:60-05:00", make_timestamp(2016, 12, 31, 23, 59, 60, 0));
+    ASSERT_PARSE("0001-01-01T00:00:00+01:00", make_timestamp(-1, 12, 31, 23, 0, 0, 0));
+    ASSERT_PARSE("9999-12-31T23:00:00-01:00", make_timestamp(10000, 1, 1, 0, 0, 0, 0));
+}
+
+TEST(RFC3339, parse_failures)
+{
+    ct_timestamp timestamp;
+    const std::string valid = "2020-08-30T15:33:14.123456789+02:00";
+    for(size_t length = 0; length < valid.size(); length++)
+    {
+        const int result = parse(valid.substr(0, length), &timestamp);
+        ASSERT_LT(result, 0) << length;
+        ASSERT_NE(ERROR_OUT_OF_RANGE, result) << length;
+        ASSERT_LT((int)length, -result) << length;
+    }
+    ASSERT_EQ(-20, parse("2020-08-30T15:33:14", &timestamp));
+
+    for(size_t i = 0; i < valid.size(); i++)
+    {
+        std::string text = valid;
+        text[i] = 'x';
+        ASSERT_EQ(ERROR_OUT_OF_RANGE, parse(text, &timestamp)) << text;
+    }
+
+    for(const char* text: {
+        "2020-13-30T15:33:14Z",
+        "2020-00-30T15:33:14Z",
+        "2020-08-00T15:33:14Z",
+        "2020-08-32T15:33:14Z",
+        "2021-02-29T15:33:14Z",
+        "1900-02-29T15:33:14Z",
+        "2020-08-30T24:33:14Z",
+        "2020-08-30T15:60:14Z",
+        "2020-08-30T15:33:61Z",
+        "2020-08-30T15:33:14.Z",
+        "2020-08-30T15:33:14.1234567890Z",
+        "2020-08-30T15:33:14+24:00",
+        "2020-08-30T15:33:14+02:60",
+        "2020-08-30T15:33:14+02-00",
+        "2020-08-30_15:33:14Z",
+        "2020/08/30T15:33:14Z",
+        "+2020-08-30T15:33:14Z",
+    })
+    {
+        ASSERT_EQ(ERROR_OUT_OF_RANGE, parse(text, &timestamp)) << text;
+    }
+}
+
+TEST(RFC3339, format)
+{
+    ASSERT_EQ("2020-08-30T15:33:14Z", format(make_timestamp(2020, 8, 30, 15, 33, 14, 0)));
+    ASSERT_EQ("2020-08-30T15:33:14.100Z", format(make_timestamp(2020, 8, 30, 15, 33, 14, 100000000)));
+    ASSERT_EQ("2020-08-30T15:33:14.195773Z", format(make_timestamp(2020, 8, 30, 15, 33, 14, 195773000)));
+    ASSERT_EQ("2020-08-30T15:33:14.000000001Z", format(make_timestamp(2020, 8, 30, 15, 33, 14, 1)));
+    ASSERT_EQ("0000-01-01T00:00:00Z", format(make_timestamp(-1, 1, 1, 0, 0, 0, 0)));
+    ASSERT_EQ("0005-06-07T08:09:60Z", format(make_timestamp(5, 6, 7, 8, 9, 60, 0)));
+
+    ct_timestamp timestamp = make_timestamp(9999, 12, 31, 23, 59, 59, 123456789);
+    char text[CT_RFC3339_TIMESTAMP_MAX_LENGTH + 1];
+    ASSERT_EQ(CT_RFC3339_TIMESTAMP_MAX_LENGTH, ct_timestamp_format_rfc3339(&timestamp, text, sizeof(text)));
+    ASSERT_EQ(-(CT_RFC3339_TIMESTAMP_MAX_LENGTH + 1), ct_timestamp_format_rfc3339(&timestamp, text, sizeof(text) - 1));
+
+    for(const ct_timestamp& invalid: {
+        make_timestamp(10000, 1, 1, 0, 0, 0, 0),
+        make_timestamp(-2, 1, 1, 0, 0, 0, 0),
+        make_timestamp(0, 1, 1, 0, 0, 0, 0),
+        make_timestamp(2021, 2, 29, 0, 0, 0, 0),
+        make_timestamp(2020, 13, 1, 0, 0, 0, 0),
+        make_timestamp(2020, 1, 1, 24, 0, 0, 0),
+        make_timestamp(2020, 1, 1, 0, 0, 0, 1000000000),
+    })
+    {
+        ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_format_rfc3339(&invalid, text, sizeof(text)));
+    }
+    timestamp.time.timezone.type = CT_TZ_STRING;
+    strcpy(timestamp.time.timezone.as_string, "E/Berlin");
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_format_rfc3339(&timestamp, text, sizeof(text)));
+}
+
+TEST(RFC3339, round_trip)
+{
+    std::mt19937 random(1);
+    for(int i = 0; i < 10000; i++)
+    {
+        static const int nanosecond_units[] = {1000000000, 1000000, 1000, 1};
+        const int unit = nanosecond_units[i % 4];
+        ct_timestamp timestamp = make_timestamp(1 + random() % 9999,
+                                                1 + random() % 12,
+                                                1 + random() % 28,
+                                                random() % 24,
+                                                random() % 60,
+                                                random() % 61,
+                                                unit == 1000000000 ? 0 : (random() % (1000000000 / unit)) * unit);
+        const std::string text = format(timestamp);
+        ct_timestamp parsed;
+        ASSERT_EQ((int)text.size(), parse(text, &parsed)) << text;
+        ASSERT_TIMESTAMP_EQ(parsed, timestamp);
+    }
+}
+
+TEST(RFC3339, date_and_time)
+{
+    ct_date date;
+    ASSERT_EQ(10, ct_date_parse_rfc3339("2020-02-29", 10, &date));
+    ASSERT_EQ(2020, date.year);
+    ASSERT_EQ(2, date.month);
+    ASSERT_EQ(29, date.day);
+    ASSERT_EQ(-10, ct_date_parse_rfc3339("2020-02-2", 9, &date));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_date_parse_rfc3339("2020-02-30", 10, &date));
+
+    char text[CT_RFC3339_TIMESTAMP_MAX_LENGTH + 1];
+    ASSERT_EQ(10, ct_date_format_rfc3339(&date, text, sizeof(text)));
+    ASSERT_STREQ("2020-02-29", text);
+    ASSERT_EQ(-11, ct_date_format_rfc3339(&date, text, 10));
+
+    ct_time time;
+    const std::string time_text = "23:30:15.25-01:00";
+    ASSERT_EQ((int)time_text.size(), ct_time_parse_rfc3339(time_text.data(), time_text.size(), &time));
+    // Wraps around midnight
+    ASSERT_EQ(0, time.hour);
+    ASSERT_EQ(30, time.minute);
+    ASSERT_EQ(15, time.second);
+    ASSERT_EQ(250000000u, time.nanosecond);
+    ASSERT_EQ(CT_TZ_ZERO, time.timezone.type);
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_time_parse_rfc3339("24:00:00Z", 9, &time));
+    ASSERT_EQ(-9, ct_time_parse_rfc3339("23:00:00", 8, &time));
+
+    ASSERT_EQ(13, ct_time_format_rfc3339(&time, text, sizeof(text)));
+    ASSERT_STREQ("00:30:15.250Z", text);
+    ASSERT_EQ(-14, ct_time_format_rfc3339(&time, text, 13));
+    time.timezone.type = CT_TZ_LATLONG;
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_time_format_rfc3339(&time, text, sizeof(text)));
+}
+
+TEST(RFC3339, encode_decode)
+{
+    const std::string text = "2020-08-30T17:33:14.195773+02:00";
+    uint8_t encoded[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    int chars_read = -1;
+    const int encoded_length = ct_timestamp_encode_rfc3339(text.data(), text.size(), encoded, sizeof(encoded), &chars_read);
+    ASSERT_EQ((int)text.size(), chars_read);
+
+    const ct_timestamp expected = make_timestamp(2020, 8, 30, 15, 33, 14, 195773000);
+    uint8_t expected_encoded[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    ASSERT_EQ(ct_timestamp_encode(&expected, expected_encoded, sizeof(expected_encoded)), encoded_length);
+    ASSERT_EQ(0, memcmp(expected_encoded, encoded, encoded_length));
+    ASSERT_GT(0, ct_timestamp_encode_rfc3339(text.data(), text.size(), encoded, encoded_length - 1, &chars_read));
+    ASSERT_EQ((int)text.size(), chars_read);
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_encode_rfc3339("2020-08-30x", 11, encoded, sizeof(encoded), &chars_read));
+    ASSERT_EQ(0, chars_read);
+
+    char formatted[CT_RFC3339_TIMESTAMP_MAX_LENGTH + 1];
+    int bytes_read = -1;
+    ASSERT_EQ(27, ct_timestamp_decode_rfc3339(encoded, encoded_length, formatted, sizeof(formatted), &bytes_read));
+    ASSERT_EQ(encoded_length, bytes_read);
+    ASSERT_STREQ("2020-08-30T15:33:14.195773Z", formatted);
+    ASSERT_EQ(-28, ct_timestamp_decode_rfc3339(encoded, encoded_length, formatted, 27, &bytes_read));
+    ASSERT_GT(0, ct_timestamp_decode_rfc3339(encoded, encoded_length - 1, formatted, sizeof(formatted), &bytes_read));
+    ASSERT_EQ(0, bytes_read);
+
+    // Records that aren't UTC can be stepped over, but not formatted.
+    ct_timestamp named = expected;
+    named.time.timezone.type = CT_TZ_STRING;
+    strcpy(named.time.timezone.as_string, "E/Berlin");
+    const int named_length = ct_timestamp_encode(&named, encoded, sizeof(encoded));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_decode_rfc3339(encoded, named_length, formatted, sizeof(formatted), &bytes_read));
+    ASSERT_EQ(named_length, bytes_read);
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include <compact_time/sequence.h>
+#include <vector>
+#include "test_helpers.h"
+
+static ct_timestamp make_unix_timestamp(int64_t unix_ns)
+{
+    ct_timestamp timestamp;
+    memset(&timestamp, 0, sizeof(timestamp));
+    ct_timestamp_from_unix_ns(unix_ns, &timestamp);
+    return timestamp;
+}
+
+// Monotonic event log with millisecond-ish spacing, changing timezone partway through.
+static std::vector<ct_timestamp> make_event_log()
+{
+    std::vector<ct_timestamp> timestamps;
+    int64_t unix_ns = 1561398784180000000LL;
+    for(int i = 0; i < 200; i++)
+    {
+        unix_ns += (i % 5 + 1) * 1000000LL + (i % 17 == 0 ? 123 : 0);
+        ct_timestamp timestamp = make_unix_timestamp(unix_ns);
+        if(i >= 150)
+        {
+            timestamp = make_named(timestamp, "E/Berlin");
+        }
+        timestamps.push_back(timestamp);
+    }
+    return timestamps;
+}
+
+static std::vector<uint8_t> encode_sequence(const std::vector<ct_timestamp>& timestamps, int keyframe_interval)
+{
+    ct_sequence_encoder encoder;
+    ct_sequence_encoder_init(&encoder, keyframe_interval);
+    std::vector<uint8_t> encoded(timestamps.size() * 60);
+    int offset = 0;
+    for(const ct_timestamp& timestamp: timestamps)
+    {
+        int byte_count = ct_sequence_encoder_encode(&encoder, &timestamp, encoded.data() + offset, encoded.size() - offset);
+        EXPECT_GT(byte_count, 0);
+        offset += byte_count;
+    }
+    encoded.resize(offset);
+    return encoded;
+}
+
+static void assert_sequence_decodes(const std::vector<uint8_t>& encoded, const std::vector<ct_timestamp>& expected)
+{
+    ct_sequence_decoder decoder;
+    ct_sequence_decoder_init(&decoder);
+    int offset = 0;
+    for(const ct_timestamp& timestamp: expected)
+    {
+        ct_timestamp actual;
+        int byte_count = ct_sequence_decoder_decode(&decoder, encoded.data() + offset, encoded.size() - offset, &actual);
+        ASSERT_GT(byte_count, 0);
+        offset += byte_count;
+        assert_timestamps_equal(timestamp, actual);
+    }
+    ASSERT_EQ((int)encoded.size(), offset);
+}
+
+TEST(Sequence, round_trip)
+{
+    std::vector<ct_timestamp> timestamps = make_event_log();
+    for(int keyframe_interval: {0, 1, 7, 64})
+    {
+        assert_sequence_decodes(encode_sequence(timestamps, keyframe_interval), timestamps);
+    }
+}
+
+TEST(Sequence, smaller_than_individual_records)
+{
+    std::vector<ct_timestamp> timestamps = make_event_log();
+    std::vector<uint8_t> encoded = encode_sequence(timestamps, 0);
+    int individual_size = 0;
+    for(const ct_timestamp& timestamp: timestamps)
+    {
+        individual_size += ct_timestamp_encoded_size(&timestamp);
+    }
+    ASSERT_LT(encoded.size() * 3, (size_t)individual_size);
+}
+
+TEST(Sequence, delta_units)
+{
+    ct_sequence_encoder encoder;
+    ct_sequence_encoder_init(&encoder, 0);
+    uint8_t buffer[20];
+    ct_timestamp timestamp = make_unix_timestamp(1000000000000000000LL);
+    ASSERT_EQ(6, ct_sequence_encoder_encode(&encoder, &timestamp, buffer, sizeof(buffer)));
+
+    // +2 seconds: zigzag(2) = 4, unit 0
+    timestamp = make_unix_timestamp(1000000002000000000LL);
+    ASSERT_EQ(1, ct_sequence_encoder_encode(&encoder, &timestamp, buffer, sizeof(buffer)));
+    ASSERT_EQ(4 << 3, buffer[0]);
+
+    // -3 milliseconds: zigzag(-3) = 5, unit 1
+    timestamp = make_unix_timestamp(1000000001997000000LL);
+    ASSERT_EQ(1, ct_sequence_encoder_encode(&encoder, &timestamp, buffer, sizeof(buffer)));
+    ASSERT_EQ((5 << 3) | (1 << 1), buffer[0]);
+
+    // +1 nanosecond: zigzag(1) = 2, unit 3
+    timestamp = make_unix_timestamp(1000000001997000001LL);
+    ASSERT_EQ(1, ct_sequence_encoder_encode(&encoder, &timestamp, buffer, sizeof(buffer)));
+    ASSERT_EQ((2 << 3) | (3 << 1), buffer[0]);
+}
+
+TEST(Sequence, keyframe_on_unconvertible_record)
+{
+    std::vector<ct_timestamp> timestamps;
+    timestamps.push_back(make_unix_timestamp(0));
+    ct_timestamp timestamp = make_unix_timestamp(0);
+    timestamp.time.second = 60;
+    timestamps.push_back(timestamp);
+    timestamps.push_back(make_unix_timestamp(1000000000));
+    timestamp = make_unix_timestamp(0);
+    timestamp.date.year = 50000;
+    timestamps.push_back(timestamp);
+    timestamps.push_back(make_unix_timestamp(2000000000));
+
+    std::vector<uint8_t> encoded = encode_sequence(timestamps, 0);
+    assert_sequence_decodes(encoded, timestamps);
+}
+
+TEST(Sequence, seek_keyframe)
+{
+    std::vector<ct_timestamp> timestamps = make_event_log();
+    const int keyframe_interval = 16;
+    std::vector<uint8_t> encoded = encode_sequence(timestamps, keyframe_interval);
+
+    for(int record_index = 0; record_index < (int)timestamps.size(); record_index++)
+    {
+        int keyframe_record_index = -1;
+        int offset = ct_sequence_seek_keyframe(encoded.data(), encoded.size(), record_index, &keyframe_record_index);
+        ASSERT_GE(offset, 0) << record_index;
+        ASSERT_LE(keyframe_record_index, record_index);
+        ASSERT_LT(record_index - keyframe_record_index, keyframe_interval);
+
+        ct_sequence_decoder decoder;
+        ct_sequence_decoder_init(&decoder);
+        ct_timestamp actual;
+        for(int i = keyframe_record_index; i <= record_index; i++)
+        {
+            int byte_count = ct_sequence_decoder_decode(&decoder, encoded.data() + offset, encoded.size() - offset, &actual);
+            ASSERT_GT(byte_count, 0);
+            offset += byte_count;
+        }
+        assert_timestamps_equal(timestamps[record_index], actual);
+    }
+
+    int keyframe_record_index = -1;
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_sequence_seek_keyframe(encoded.data(), encoded.size(), timestamps.size(), &keyframe_record_index));
+    // Truncated inside the first keyframe
+    ASSERT_GT(0, ct_sequence_seek_keyframe(encoded.data(), 3, 0, &keyframe_record_index));
+}
+
+TEST(Sequence, errors)
+{
+    std::vector<ct_timestamp> timestamps = make_event_log();
+    std::vector<uint8_t> encoded = encode_sequence(timestamps, 0);
+    ct_sequence_decoder decoder;
+    ct_timestamp actual;
+
+    // Starting at a delta
+    ct_sequence_decoder_init(&decoder);
+    int keyframe_size = ct_sequence_decoder_decode(&decoder, encoded.data(), encoded.size(), &actual);
+    ASSERT_GT(keyframe_size, 0);
+    ct_sequence_decoder_init(&decoder);
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_sequence_decoder_decode(&decoder, encoded.data() + keyframe_size, encoded.size() - keyframe_size, &actual));
+
+    // Truncated keyframe
+    ct_sequence_decoder_init(&decoder);
+    for(int length = 0; length < keyframe_size; length++)
+    {
+        ASSERT_LT(ct_sequence_decoder_decode(&decoder, encoded.data(), length, &actual), 0);
+    }
+
+    // Encoding into a short buffer
+    ct_sequence_encoder encoder;
+    ct_sequence_encoder_init(&encoder, 0);
+    uint8_t buffer[20];
+    for(int length = 0; length < keyframe_size; length++)
+    {
+        ASSERT_LT(ct_sequence_encoder_encode(&encoder, &timestamps[0], buffer, length), 0);
+    }
+    ASSERT_EQ(keyframe_size, ct_sequence_encoder_encode(&encoder, &timestamps[0], buffer, sizeof(buffer)));
+}
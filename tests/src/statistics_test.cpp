@@ -0,0 +1,151 @@
+// Statistics are compiled out of the library by default, so these tests use
+// the header-only build with them compiled in.
+#define COMPACT_TIME_STATISTICS 1
+#include <gtest/gtest.h>
+#include <compact_time/compact_time_inline.h>
+#include <thread>
+#include <vector>
+#include "test_helpers.h"
+
+static ct_statistics get_statistics_delta(const ct_statistics& before)
+{
+    ct_statistics after;
+    ct_statistics_get(&after);
+    uint64_t* counters = (uint64_t*)&after;
+    const uint64_t* previous = (const uint64_t*)&before;
+    for(size_t i = 0; i < sizeof(after) / sizeof(*counters); i++)
+    {
+        counters[i] -= previous[i];
+    }
+    return after;
+}
+
+TEST(Statistics, enabled)
+{
+    ASSERT_TRUE(ct_statistics_enabled());
+}
+
+TEST(Statistics, encode_decode)
+{
+    ct_statistics before;
+    ct_statistics_get(&before);
+
+    // {0x00, 0x00, 0x08, 0x01, 0x01}
+    ct_timestamp utc = make_timestamp(2000, 1, 1, 0, 0, 0, 0);
+    // {0x01, 0x00, 0x08, 0x71, 0x3e, 0x01}
+    ct_timestamp milliseconds = make_timestamp(2000, 1, 1, 0, 0, 0, 999000000);
+    // {0x00, 0x00, 0x08, 0x01, 0x9f, 0x45}, plus 1 + 8 bytes of timezone
+    ct_timestamp named = make_named(make_timestamp(3009, 1, 1, 0, 0, 0, 0), "E/Berlin");
+
+    uint8_t buffer[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    ct_timestamp decoded;
+    for(const ct_timestamp* timestamp: {&utc, &milliseconds, &named})
+    {
+        const int byte_count = ct_timestamp_encode(timestamp, buffer, sizeof(buffer));
+        ASSERT_GT(byte_count, 0);
+        ASSERT_EQ(byte_count, ct_timestamp_decode(buffer, byte_count, &decoded));
+    }
+
+    ct_statistics delta = get_statistics_delta(before);
+    for(const ct_codec_statistics& codec: {delta.encode, delta.decode})
+    {
+        ASSERT_EQ(3u, codec.records);
+        ASSERT_EQ(5u + 6u + 15u, codec.bytes);
+        ASSERT_EQ(2u, codec.magnitudes[0]);
+        ASSERT_EQ(1u, codec.magnitudes[1]);
+        ASSERT_EQ(0u, codec.magnitudes[3]);
+        ASSERT_EQ(2u, codec.timezone_types[CT_TZ_ZERO]);
+        ASSERT_EQ(1u, codec.timezone_types[CT_TZ_STRING]);
+        ASSERT_EQ(2u, codec.year_group_counts[1]);
+        ASSERT_EQ(1u, codec.year_group_counts[2]);
+        ASSERT_EQ(0u, codec.failures_at_pos);
+        ASSERT_EQ(0u, codec.out_of_range);
+    }
+}
+
+TEST(Statistics, failures)
+{
+    ct_statistics before;
+    ct_statistics_get(&before);
+
+    ct_timestamp timestamp = make_timestamp(2000, 1, 1, 0, 0, 0, 0);
+    uint8_t buffer[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    const int byte_count = ct_timestamp_encode(&timestamp, buffer, sizeof(buffer));
+    ASSERT_GT(0, ct_timestamp_encode(&timestamp, buffer, byte_count - 1));
+    ASSERT_GT(0, ct_timestamp_decode(buffer, byte_count - 1, &timestamp));
+
+    timestamp.time.timezone.type = CT_TZ_LATLONG;
+    timestamp.time.timezone.latitude = 9001;
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_encode(&timestamp, buffer, sizeof(buffer)));
+
+    // An unknown timezone type is counted as out of range, not by its type.
+    const int unknown_type = 100000;
+    static_assert(sizeof(timestamp.time.timezone.type) == sizeof(unknown_type), "ct_tz_type must be int sized");
+    memcpy(&timestamp.time.timezone.type, &unknown_type, sizeof(unknown_type));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_encode(&timestamp, buffer, sizeof(buffer)));
+
+    ct_statistics delta = get_statistics_delta(before);
+    ASSERT_EQ(1u, delta.encode.records);
+    ASSERT_EQ(1u, delta.encode.failures_at_pos);
+    ASSERT_EQ(2u, delta.encode.out_of_range);
+    ASSERT_EQ(1u, delta.encode.timezone_types[CT_TZ_ZERO]);
+    ASSERT_EQ(0u, delta.encode.timezone_types[CT_TZ_STRING] + delta.encode.timezone_types[CT_TZ_LATLONG]);
+    ASSERT_EQ(0u, delta.decode.records);
+    ASSERT_EQ(1u, delta.decode.failures_at_pos);
+}
+
+TEST(Statistics, batch)
+{
+    ct_statistics before;
+    ct_statistics_get(&before);
+
+    std::vector<ct_timestamp> timestamps(10, make_timestamp(2000, 1, 1, 0, 0, 0, 1000));
+    std::vector<uint8_t> buffer(timestamps.size() * CT_TIMESTAMP_MAX_ENCODED_SIZE);
+    const int byte_count = ct_timestamp_encode_batch(timestamps.data(), timestamps.size(),
+                                                     buffer.data(), buffer.size(), NULL, NULL);
+    ASSERT_GT(byte_count, 0);
+    ASSERT_EQ(byte_count, ct_timestamp_decode_batch(buffer.data(), byte_count,
+                                                    timestamps.data(), timestamps.size(), NULL, NULL));
+
+    ct_statistics delta = get_statistics_delta(before);
+    ASSERT_EQ(10u, delta.encode.records);
+    ASSERT_EQ(10u, delta.encode.magnitudes[2]);
+    ASSERT_EQ((uint64_t)byte_count, delta.encode.bytes);
+    ASSERT_EQ(10u, delta.decode.records);
+    ASSERT_EQ(10u, delta.decode.magnitudes[2]);
+    ASSERT_EQ((uint64_t)byte_count, delta.decode.bytes);
+}
+
+TEST(Statistics, threads)
+{
+    const int thread_count = 4;
+    const int records_per_thread = 1000;
+    ct_statistics before;
+    ct_statistics_get(&before);
+
+    // Run twice, so that the second round reuses the first round's counters.
+    for(int round = 0; round < 2; round++)
+    {
+        std::vector<std::thread> threads;
+        for(int i = 0; i < thread_count; i++)
+        {
+            threads.emplace_back([]()
+            {
+                ct_timestamp timestamp = make_timestamp(2000, 1, 1, 0, 0, 0, 0);
+                uint8_t buffer[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+                for(int record = 0; record < records_per_thread; record++)
+                {
+                    ct_timestamp_encode(&timestamp, buffer, sizeof(buffer));
+                }
+            });
+        }
+        for(std::thread& thread: threads)
+        {
+            thread.join();
+        }
+    }
+
+    ct_statistics delta = get_statistics_delta(before);
+    ASSERT_EQ(2u * thread_count * records_per_thread, delta.encode.records);
+    ASSERT_EQ(2u * thread_count * records_per_thread, delta.encode.magnitudes[0]);
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include <compact_time/stream_index.h>
+#include <vector>
+#include "test_helpers.h"
+
+static const int RECORD_COUNT = 1000;
+
+// Ascending timestamps with mixed magnitudes, year sizes and timezones.
+static std::vector<ct_timestamp> make_sorted_timestamps()
+{
+    static const char* names[] = {"E/Berlin", "S/Tokyo", "America/Argentina/ComodRivadavia"};
+    std::vector<ct_timestamp> timestamps;
+    for(int i = 0; i < RECORD_COUNT; i++)
+    {
+        ct_timestamp timestamp = make_timestamp(1500 + i, 1 + i % 12, 1 + i % 28, i % 24, i % 60, (i * 7) % 60, (i % 4) * 123456789);
+        if(i % 3 == 1)
+        {
+            timestamp = make_named(timestamp, names[(i / 3) % 3]);
+        }
+        else if(i % 3 == 2)
+        {
+            timestamp = make_location(timestamp, -3876 + i, 2730 - i);
+        }
+        timestamps.push_back(timestamp);
+    }
+    return timestamps;
+}
+
+class StreamIndex: public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        timestamps = make_sorted_timestamps();
+        stream = encode_all(timestamps, &record_offsets);
+        ASSERT_FALSE(stream.empty());
+    }
+
+    std::vector<uint8_t> build_index(int interval)
+    {
+        ct_stream_index_builder builder;
+        EXPECT_TRUE(ct_stream_index_builder_init(&builder, interval));
+        for(size_t i = 0; i < timestamps.size(); i++)
+        {
+            int end = i + 1 < timestamps.size() ? record_offsets[i + 1] : stream.size();
+            EXPECT_TRUE(ct_stream_index_builder_add(&builder, end - record_offsets[i]));
+        }
+        std::vector<uint8_t> index_data(ct_stream_index_serialized_size(&builder));
+        EXPECT_EQ((int64_t)index_data.size(), ct_stream_index_serialize(&builder, index_data.data(), index_data.size()));
+        ct_stream_index_builder_free(&builder);
+        return index_data;
+    }
+
+    std::vector<ct_timestamp> timestamps;
+    std::vector<uint8_t> stream;
+    std::vector<int> record_offsets;
+};
+
+TEST_F(StreamIndex, scan_matches_add)
+{
+    std::vector<uint8_t> expected = build_index(16);
+
+    ct_stream_index_builder builder;
+    ASSERT_TRUE(ct_stream_index_builder_init(&builder, 16));
+    const int chunk_size = 100;
+    size_t offset = 0;
+    std::vector<uint8_t> chunk;
+    while(offset < stream.size())
+    {
+        size_t end = std::min(offset + chunk_size, stream.size());
+        chunk.insert(chunk.end(), stream.begin() + offset, stream.begin() + end);
+        offset = end;
+        int consumed = ct_stream_index_builder_scan(&builder, chunk.data(), chunk.size());
+        ASSERT_GE(consumed, 0);
+        chunk.erase(chunk.begin(), chunk.begin() + consumed);
+    }
+    ASSERT_TRUE(chunk.empty());
+
+    std::vector<uint8_t> actual(ct_stream_index_serialized_size(&builder));
+    ASSERT_EQ((int64_t)actual.size(), ct_stream_index_serialize(&builder, actual.data(), actual.size()));
+    ct_stream_index_builder_free(&builder);
+    ASSERT_EQ(expected, actual);
+}
+
+TEST_F(StreamIndex, seek)
+{
+    for(int interval: {1, 7, 64, RECORD_COUNT * 2})
+    {
+        std::vector<uint8_t> index_data = build_index(interval);
+        ct_stream_index index;
+        ASSERT_EQ(0, ct_stream_index_open(&index, index_data.data(), index_data.size(), stream.data(), stream.size()));
+        ASSERT_EQ(RECORD_COUNT, ct_stream_index_record_count(&index));
+
+        for(int i = 0; i < RECORD_COUNT; i++)
+        {
+            ct_timestamp actual;
+            ASSERT_EQ(record_offsets[i], ct_stream_seek(&index, i, &actual)) << interval << ", " << i;
+            ASSERT_EQ(timestamps[i].date.year, actual.date.year);
+            ASSERT_EQ(timestamps[i].time.nanosecond, actual.time.nanosecond);
+            ASSERT_EQ(timestamps[i].time.timezone.type, actual.time.timezone.type);
+        }
+        ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_stream_seek(&index, -1, NULL));
+        ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_stream_seek(&index, RECORD_COUNT, NULL));
+    }
+}
+
+TEST_F(StreamIndex, find)
+{
+    std::vector<uint8_t> index_data = build_index(32);
+    ct_stream_index index;
+    ASSERT_EQ(0, ct_stream_index_open(&index, index_data.data(), index_data.size(), stream.data(), stream.size()));
+
+    for(int i = 0; i < RECORD_COUNT; i++)
+    {
+        ct_timestamp target = timestamps[i];
+        ASSERT_EQ(i, ct_stream_find(&index, &target));
+
+        // Just after this record
+        target.time.nanosecond++;
+        ASSERT_EQ(i + 1, ct_stream_find(&index, &target));
+    }
+
+    ct_timestamp target = timestamps[0];
+    target.date.year = 1;
+    ASSERT_EQ(0, ct_stream_find(&index, &target));
+    target.date.year = 100000;
+    ASSERT_EQ(RECORD_COUNT, ct_stream_find(&index, &target));
+}
+
+TEST_F(StreamIndex, open_rejects_mismatch)
+{
+    std::vector<uint8_t> index_data = build_index(16);
+    ct_stream_index index;
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_stream_index_open(&index, index_data.data(), index_data.size(), stream.data(), stream.size() - 1));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_stream_index_open(&index, index_data.data(), index_data.size() - 1, stream.data(), stream.size()));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_stream_index_open(&index, index_data.data(), CT_STREAM_INDEX_HEADER_SIZE - 1, stream.data(), stream.size()));
+}
+
+static void write_le(uint64_t value, int byte_count, uint8_t* dst)
+{
+    for(int i = 0; i < byte_count; i++)
+    {
+        dst[i] = (uint8_t)(value >> (i * 8));
+    }
+}
+
+TEST(StreamIndexCorrupt, offsets_past_int64_max)
+{
+    // 8-byte offsets need a stream longer than 4 GiB. The stream is never
+    // read, because every offset in the index is rejected first.
+    const int64_t stream_length = (int64_t)UINT32_MAX + 1;
+    const uint64_t offsets[] = {0x8000000000000000ull, 0xffffffffffffffffull};
+    std::vector<uint8_t> index_data(CT_STREAM_INDEX_HEADER_SIZE + sizeof(offsets));
+    write_le(1, 4, index_data.data());
+    index_data[4] = 8;
+    write_le(2, 8, index_data.data() + 8);
+    write_le(stream_length, 8, index_data.data() + 16);
+    for(size_t i = 0; i < 2; i++)
+    {
+        write_le(offsets[i], 8, index_data.data() + CT_STREAM_INDEX_HEADER_SIZE + i * 8);
+    }
+    const uint8_t stream[1] = {0};
+
+    ct_stream_index index;
+    ASSERT_EQ(0, ct_stream_index_open(&index, index_data.data(), index_data.size(), stream, stream_length));
+    ct_timestamp timestamp;
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_stream_seek(&index, 0, &timestamp));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_stream_seek(&index, 1, NULL));
+    ct_timestamp target = make_timestamp(2000, 1, 1, 0, 0, 0, 0);
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_stream_find(&index, &target));
+}
+
+TEST(StreamIndexEmpty, empty_stream)
+{
+    ct_stream_index_builder builder;
+    ASSERT_FALSE(ct_stream_index_builder_init(&builder, 0));
+    ASSERT_TRUE(ct_stream_index_builder_init(&builder, 8));
+    std::vector<uint8_t> index_data(ct_stream_index_serialized_size(&builder));
+    ASSERT_EQ(CT_STREAM_INDEX_HEADER_SIZE, ct_stream_index_serialize(&builder, index_data.data(), index_data.size()));
+    ct_stream_index_builder_free(&builder);
+
+    ct_stream_index index;
+    ASSERT_EQ(0, ct_stream_index_open(&index, index_data.data(), index_data.size(), NULL, 0));
+    ct_timestamp target;
+    memset(&target, 0, sizeof(target));
+    ASSERT_EQ(0, ct_stream_find(&index, &target));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_stream_seek(&index, 0, NULL));
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <compact_time/stream.h>
+#include <algorithm>
+#include <vector>
+#include "test_helpers.h"
+
+static std::vector<ct_timestamp> make_stream_timestamps()
+{
+    static const char* names[] = {"E/Berlin", "S/Tokyo", "America/Argentina/ComodRivadavia"};
+    std::vector<ct_timestamp> timestamps;
+    for(int i = 0; i < 40; i++)
+    {
+        ct_timestamp timestamp = make_timestamp(1990 + i * 7, 1 + i % 12, 1 + i % 28, i % 24, i, 59 - i, (i % 4) * 123456789);
+        if(i % 3 == 1)
+        {
+            timestamp = make_named(timestamp, names[(i / 3) % 3]);
+        }
+        else if(i % 3 == 2)
+        {
+            timestamp = make_location(timestamp, -3876 + i, 2730 - i);
+        }
+        timestamps.push_back(timestamp);
+    }
+    return timestamps;
+}
+
+TEST(Stream, decode_in_chunks)
+{
+    std::vector<ct_timestamp> timestamps = make_stream_timestamps();
+    std::vector<uint8_t> encoded = encode_all(timestamps);
+
+    for(int chunk_size = 1; chunk_size < 40; chunk_size++)
+    {
+        ct_stream_decoder decoder;
+        ct_stream_decoder_init(&decoder);
+        std::vector<ct_timestamp> decoded(timestamps.size());
+        size_t decoded_count = 0;
+        for(size_t offset = 0; offset < encoded.size();)
+        {
+            const int length = std::min((int)(encoded.size() - offset), chunk_size);
+            int records_processed = 0;
+            // Room for at most 2 records per call, so chunks are sometimes fed twice.
+            const int max_count = std::min(2, (int)(decoded.size() - decoded_count));
+            int consumed = ct_stream_decoder_feed(&decoder, encoded.data() + offset, length, decoded.data() + decoded_count, max_count, &records_processed);
+            ASSERT_GE(consumed, 0);
+            offset += consumed;
+            decoded_count += records_processed;
+        }
+        ASSERT_FALSE(ct_stream_decoder_is_mid_record(&decoder));
+        ASSERT_EQ(timestamps.size(), decoded_count) << "chunk size " << chunk_size;
+        for(size_t i = 0; i < timestamps.size(); i++)
+        {
+            assert_timestamps_equal(timestamps[i], decoded[i]);
+        }
+    }
+}
+
+TEST(Stream, decode_truncated)
+{
+    std::vector<ct_timestamp> timestamps = make_stream_timestamps();
+    std::vector<uint8_t> encoded = encode_all(timestamps);
+
+    ct_stream_decoder decoder;
+    ct_stream_decoder_init(&decoder);
+    std::vector<ct_timestamp> decoded(timestamps.size());
+    int records_processed = 0;
+    ASSERT_EQ(encoded.size() - 1, ct_stream_decoder_feed(&decoder, encoded.data(), encoded.size() - 1, decoded.data(), decoded.size(), &records_processed));
+    ASSERT_EQ(timestamps.size() - 1, records_processed);
+    ASSERT_TRUE(ct_stream_decoder_is_mid_record(&decoder));
+    ASSERT_EQ(1, ct_stream_decoder_feed(&decoder, encoded.data() + encoded.size() - 1, 1, decoded.data(), 1, &records_processed));
+    ASSERT_EQ(1, records_processed);
+    ASSERT_FALSE(ct_stream_decoder_is_mid_record(&decoder));
+    assert_timestamps_equal(timestamps.back(), decoded[0]);
+}
+
+TEST(Stream, decode_invalid_record_across_chunks)
+{
+    std::vector<uint8_t> encoded = encode_all({make_named(make_timestamp(2020, 1, 1, 0, 0, 0, 0), "E/Rome")});
+    // Unprintable, so only a full decode rejects it
+    encoded.back() = 0x01;
+
+    ct_stream_decoder decoder;
+    ct_stream_decoder_init(&decoder);
+    ct_timestamp decoded;
+    int records_processed = 0;
+    ASSERT_EQ(3, ct_stream_decoder_feed(&decoder, encoded.data(), 3, &decoded, 1, &records_processed));
+    ASSERT_EQ(0, records_processed);
+    ASSERT_TRUE(ct_stream_decoder_is_mid_record(&decoder));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_stream_decoder_feed(&decoder, encoded.data() + 3, encoded.size() - 3, &decoded, 1, &records_processed));
+    ASSERT_EQ(0, records_processed);
+}
+
+TEST(Stream, encode_in_chunks)
+{
+    std::vector<ct_timestamp> timestamps = make_stream_timestamps();
+    std::vector<uint8_t> expected = encode_all(timestamps);
+
+    for(int chunk_size = 1; chunk_size < 40; chunk_size++)
+    {
+        ct_stream_encoder encoder;
+        ct_stream_encoder_init(&encoder);
+        std::vector<uint8_t> actual;
+        size_t encoded_count = 0;
+        std::vector<uint8_t> chunk(chunk_size);
+        while(encoded_count < timestamps.size())
+        {
+            int records_processed = 0;
+            int byte_count = ct_stream_encoder_encode(&encoder, timestamps.data() + encoded_count, timestamps.size() - encoded_count, chunk.data(), chunk.size(), &records_processed);
+            ASSERT_GE(byte_count, 0);
+            actual.insert(actual.end(), chunk.begin(), chunk.begin() + byte_count);
+            encoded_count += records_processed;
+        }
+        for(;;)
+        {
+            int byte_count = ct_stream_encoder_flush(&encoder, chunk.data(), chunk.size());
+            if(byte_count == 0)
+            {
+                break;
+            }
+            actual.insert(actual.end(), chunk.begin(), chunk.begin() + byte_count);
+        }
+        ASSERT_EQ(expected, actual) << "chunk size " << chunk_size;
+    }
+}
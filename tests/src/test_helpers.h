@@ -0,0 +1,84 @@
+// Helpers shared by the unit tests.
+//
+// Include after the compact time header under test, so that the header-only
+// build's linkage applies when a test uses it.
+
+#ifndef KS_compact_time_test_helpers_H
+#define KS_compact_time_test_helpers_H
+
+#include <gtest/gtest.h>
+#include <compact_time/compact_time.h>
+#include <string.h>
+#include <vector>
+
+static inline ct_timestamp make_timestamp(int year, int month, int day, int hour, int minute, int second, int nanosecond)
+{
+    ct_timestamp timestamp;
+    memset(&timestamp, 0, sizeof(timestamp));
+    timestamp.date.year = year;
+    timestamp.date.month = month;
+    timestamp.date.day = day;
+    timestamp.time.hour = hour;
+    timestamp.time.minute = minute;
+    timestamp.time.second = second;
+    timestamp.time.nanosecond = nanosecond;
+    timestamp.time.timezone.type = CT_TZ_ZERO;
+    return timestamp;
+}
+
+static inline ct_timestamp make_named(ct_timestamp timestamp, const char* name)
+{
+    timestamp.time.timezone.type = CT_TZ_STRING;
+    strcpy(timestamp.time.timezone.as_string, name);
+    return timestamp;
+}
+
+static inline ct_timestamp make_location(ct_timestamp timestamp, int latitude, int longitude)
+{
+    timestamp.time.timezone.type = CT_TZ_LATLONG;
+    timestamp.time.timezone.latitude = latitude;
+    timestamp.time.timezone.longitude = longitude;
+    return timestamp;
+}
+
+// Encode timestamps back-to-back, optionally recording where each one starts.
+static inline std::vector<uint8_t> encode_all(const std::vector<ct_timestamp>& timestamps, std::vector<int>* record_offsets = NULL)
+{
+    std::vector<uint8_t> encoded(timestamps.size() * CT_TIMESTAMP_MAX_ENCODED_SIZE);
+    if(record_offsets != NULL)
+    {
+        record_offsets->resize(timestamps.size());
+    }
+    int byte_count = ct_timestamp_encode_batch(timestamps.data(), timestamps.size(), encoded.data(), encoded.size(),
+                                               record_offsets != NULL ? record_offsets->data() : NULL, NULL);
+    EXPECT_GT(byte_count, 0);
+    encoded.resize(byte_count > 0 ? byte_count : 0);
+    return encoded;
+}
+
+static inline void assert_timestamps_equal(const ct_timestamp& expected, const ct_timestamp& actual)
+{
+    ASSERT_EQ(expected.date.year, actual.date.year);
+    ASSERT_EQ(expected.date.month, actual.date.month);
+    ASSERT_EQ(expected.date.day, actual.date.day);
+    ASSERT_EQ(expected.time.hour, actual.time.hour);
+    ASSERT_EQ(expected.time.minute, actual.time.minute);
+    ASSERT_EQ(expected.time.second, actual.time.second);
+    ASSERT_EQ(expected.time.nanosecond, actual.time.nanosecond);
+    ASSERT_EQ(expected.time.timezone.type, actual.time.timezone.type);
+    if(expected.time.timezone.type == CT_TZ_STRING)
+    {
+        ASSERT_STREQ(expected.time.timezone.as_string, actual.time.timezone.as_string);
+    }
+    else if(expected.time.timezone.type == CT_TZ_LATLONG)
+    {
+        ASSERT_EQ(expected.time.timezone.latitude, actual.time.timezone.latitude);
+        ASSERT_EQ(expected.time.timezone.longitude, actual.time.timezone.longitude);
+    }
+}
+
+// Like assert_timestamps_equal(), but returns from the calling test on failure.
+#define ASSERT_TIMESTAMP_EQ(ACTUAL, EXPECTED) \
+    ASSERT_NO_FATAL_FAILURE(assert_timestamps_equal(EXPECTED, ACTUAL))
+
+#endif // KS_compact_time_test_helpers_H
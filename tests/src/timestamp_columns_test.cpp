@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <compact_time/timestamp_columns.h>
+#include <vector>
+#include "test_helpers.h"
+
+static std::vector<ct_timestamp> make_mixed_timestamps()
+{
+    std::vector<ct_timestamp> timestamps;
+    for(int i = 0; i < 30; i++)
+    {
+        ct_timestamp timestamp = make_timestamp(2000 + i, 1 + i % 12, 1 + i, i % 24, i, i, i * 1000);
+        if(i % 7 == 3)
+        {
+            timestamp = make_named(timestamp, i % 2 ? "E/Berlin" : "S/Tokyo");
+        }
+        else if(i % 11 == 5)
+        {
+            timestamp = make_location(timestamp, 5994, 1071);
+        }
+        timestamps.push_back(timestamp);
+    }
+    return timestamps;
+}
+
+TEST(TimestampColumns, decode_encode)
+{
+    std::vector<ct_timestamp> timestamps = make_mixed_timestamps();
+    std::vector<uint8_t> encoded = encode_all(timestamps);
+    const int byte_count = encoded.size();
+    ASSERT_GT(byte_count, 0);
+
+    ct_timestamp_columns columns;
+    ASSERT_TRUE(ct_timestamp_columns_init(&columns, timestamps.size()));
+
+    int records_processed = 0;
+    ASSERT_EQ(byte_count, ct_timestamp_decode_columns(encoded.data(), encoded.size(), &columns, &records_processed));
+    ASSERT_EQ(timestamps.size(), records_processed);
+    ASSERT_EQ(timestamps.size(), columns.row_count);
+    // UTC, two names, one location
+    ASSERT_EQ(4, columns.timezone_count);
+
+    for(size_t i = 0; i < timestamps.size(); i++)
+    {
+        ASSERT_EQ(timestamps[i].date.year, columns.fields.year[i]);
+        ct_timestamp actual;
+        ct_timestamp_columns_get(&columns, i, &actual);
+        assert_timestamps_equal(timestamps[i], actual);
+    }
+
+    std::vector<uint8_t> reencoded(encoded.size());
+    ASSERT_EQ(byte_count, ct_timestamp_encode_columns(&columns, 0, columns.row_count, reencoded.data(), reencoded.size(), &records_processed));
+    ASSERT_EQ(timestamps.size(), records_processed);
+    ASSERT_EQ(encoded, reencoded);
+
+    ct_timestamp_columns_free(&columns);
+}
+
+TEST(TimestampColumns, decode_stops_when_full)
+{
+    std::vector<ct_timestamp> timestamps = make_mixed_timestamps();
+    std::vector<int> offsets;
+    std::vector<uint8_t> encoded = encode_all(timestamps, &offsets);
+    const int byte_count = encoded.size();
+    ASSERT_GT(byte_count, 0);
+
+    ct_timestamp_columns columns;
+    ASSERT_TRUE(ct_timestamp_columns_init(&columns, 10));
+    int records_processed = 0;
+    ASSERT_EQ(offsets[10], ct_timestamp_decode_columns(encoded.data(), byte_count, &columns, &records_processed));
+    ASSERT_EQ(10, records_processed);
+
+    ct_timestamp_columns_clear(&columns);
+    ASSERT_EQ(0, columns.row_count);
+    ASSERT_EQ(1, columns.timezone_count);
+    ct_timestamp_columns_free(&columns);
+}
+
+TEST(TimestampColumns, append)
+{
+    ct_timestamp_columns columns;
+    ASSERT_TRUE(ct_timestamp_columns_init(&columns, 1));
+    ct_timestamp timestamp = make_timestamp(2020, 1, 2, 3, 4, 5, 6);
+    ASSERT_EQ(0, ct_timestamp_columns_append(&columns, &timestamp));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_columns_append(&columns, &timestamp));
+    ct_timestamp_columns_free(&columns);
+}
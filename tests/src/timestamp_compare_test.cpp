@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <compact_time/timestamp_compare.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include "test_helpers.h"
+
+static std::vector<uint8_t> encode(const ct_timestamp& timestamp)
+{
+    std::vector<uint8_t> encoded(ct_timestamp_encoded_size(&timestamp));
+    EXPECT_EQ((int)encoded.size(), ct_timestamp_encode(&timestamp, encoded.data(), encoded.size()));
+    return encoded;
+}
+
+static int compare(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b)
+{
+    return ct_timestamp_compare_encoded(a.data(), a.size(), b.data(), b.size());
+}
+
+// Distinct timestamps in ascending order, across magnitudes and year group counts
+static std::vector<ct_timestamp> make_ordered_timestamps()
+{
+    const ct_timestamp base = make_timestamp(2020, 8, 30, 15, 33, 14, 19577323);
+    return {
+        make_timestamp(-50000, 1, 1, 0, 0, 0, 0),
+        make_timestamp(-1, 12, 31, 23, 59, 59, 999999999),
+        make_timestamp(1999, 12, 31, 23, 59, 60, 0),
+        make_timestamp(2000, 1, 1, 0, 0, 0, 0),
+        make_timestamp(2000, 1, 1, 0, 0, 0, 999),
+        make_timestamp(2000, 1, 1, 0, 0, 0, 1000),
+        make_timestamp(2000, 1, 1, 0, 0, 0, 1000000),
+        make_timestamp(2000, 1, 1, 0, 0, 0, 999999999),
+        make_timestamp(2000, 1, 1, 0, 0, 1, 0),
+        make_timestamp(2000, 1, 1, 0, 1, 0, 0),
+        make_timestamp(2000, 1, 1, 1, 0, 0, 0),
+        make_timestamp(2000, 1, 2, 0, 0, 0, 0),
+        make_timestamp(2000, 2, 1, 0, 0, 0, 0),
+        base,
+        // Encoded timezones start with their length
+        make_named(base, "E/Rome"),
+        make_named(base, "E/Berlin"),
+        make_timestamp(3009, 1, 1, 0, 0, 0, 0),
+        make_timestamp(50000, 1, 1, 0, 0, 0, 0),
+    };
+}
+
+TEST(TimestampCompare, ordering)
+{
+    std::vector<std::vector<uint8_t>> encoded;
+    for(const ct_timestamp& timestamp: make_ordered_timestamps())
+    {
+        encoded.push_back(encode(timestamp));
+    }
+    for(size_t i = 0; i < encoded.size(); i++)
+    {
+        for(size_t j = 0; j < encoded.size(); j++)
+        {
+            const int result = compare(encoded[i], encoded[j]);
+            ASSERT_EQ(i < j, result < 0) << i << " vs " << j;
+            ASSERT_EQ(i > j, result > 0) << i << " vs " << j;
+        }
+    }
+}
+
+TEST(TimestampCompare, invalid_sorts_last)
+{
+    const std::vector<uint8_t> valid = encode(make_timestamp(50000, 1, 1, 0, 0, 0, 0));
+    const std::vector<uint8_t> truncated(valid.begin(), valid.end() - 1);
+    ASSERT_LT(compare(valid, truncated), 0);
+    ASSERT_GT(compare(truncated, valid), 0);
+    ASSERT_EQ(0, compare(truncated, truncated));
+}
+
+TEST(TimestampCompare, sort)
+{
+    std::vector<ct_timestamp> expected = make_ordered_timestamps();
+    std::vector<ct_timestamp> shuffled = expected;
+    // Duplicates must stay in their original relative order.
+    shuffled.insert(shuffled.end(), expected.begin(), expected.end());
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(1));
+
+    std::vector<int> offsets;
+    std::vector<uint8_t> buffer = encode_all(shuffled, &offsets);
+    const int byte_count = buffer.size();
+    ASSERT_GT(byte_count, 0);
+
+    ASSERT_EQ(0, ct_timestamp_sort_encoded(buffer.data(), byte_count, offsets.data(), offsets.size()));
+    for(size_t i = 0; i < offsets.size(); i++)
+    {
+        ct_timestamp decoded;
+        memset(&decoded, 0, sizeof(decoded));
+        ASSERT_GT(ct_timestamp_decode(buffer.data() + offsets[i], byte_count - offsets[i], &decoded), 0);
+        const ct_timestamp& timestamp = expected[i / 2];
+        ASSERT_EQ(timestamp.date.year, decoded.date.year) << "at " << i;
+        ASSERT_EQ(timestamp.time.nanosecond, decoded.time.nanosecond) << "at " << i;
+        ASSERT_STREQ(timestamp.time.timezone.as_string, decoded.time.timezone.as_string) << "at " << i;
+        if(i % 2 == 1)
+        {
+            ASSERT_LT(offsets[i - 1], offsets[i]) << "unstable at " << i;
+            ASSERT_EQ(0, ct_timestamp_compare_encoded(buffer.data() + offsets[i - 1], byte_count - offsets[i - 1],
+                                                      buffer.data() + offsets[i], byte_count - offsets[i]));
+        }
+    }
+}
+
+TEST(TimestampCompare, sort_failures)
+{
+    const std::vector<uint8_t> encoded = encode(make_named(make_timestamp(2000, 1, 1, 0, 0, 0, 0), "E/Rome"));
+    std::vector<uint8_t> buffer = encoded;
+    buffer.insert(buffer.end(), encoded.begin(), encoded.end() - 1);
+
+    std::vector<int> offsets = {(int)encoded.size(), 0};
+    ASSERT_EQ(-(int)(buffer.size() + 1), ct_timestamp_sort_encoded(buffer.data(), buffer.size(), offsets.data(), offsets.size()));
+    ASSERT_EQ((int)encoded.size(), offsets[0]);
+
+    offsets = {0, (int)buffer.size()};
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_sort_encoded(buffer.data(), buffer.size(), offsets.data(), offsets.size()));
+}
+
+TEST(TimestampCompare, sort_long_equal_field_run)
+{
+    // The same instant in many timezones, each appearing several times
+    const ct_timestamp base = make_timestamp(2020, 8, 30, 15, 33, 14, 19577323);
+    std::vector<ct_timestamp> timestamps;
+    for(int i = 0; i < 2000; i++)
+    {
+        const std::string name = "Etc/Zone" + std::to_string(i % 97);
+        timestamps.push_back(i % 5 == 0 ? base : make_named(base, name.c_str()));
+    }
+    std::shuffle(timestamps.begin(), timestamps.end(), std::mt19937(2));
+
+    std::vector<int> offsets;
+    std::vector<uint8_t> buffer = encode_all(timestamps, &offsets);
+    const int byte_count = buffer.size();
+    ASSERT_EQ(0, ct_timestamp_sort_encoded(buffer.data(), byte_count, offsets.data(), offsets.size()));
+    for(size_t i = 1; i < offsets.size(); i++)
+    {
+        const int result = ct_timestamp_compare_encoded(buffer.data() + offsets[i - 1], byte_count - offsets[i - 1],
+                                                        buffer.data() + offsets[i], byte_count - offsets[i]);
+        ASSERT_LE(result, 0) << "at " << i;
+        if(result == 0)
+        {
+            ASSERT_LT(offsets[i - 1], offsets[i]) << "unstable at " << i;
+        }
+    }
+}
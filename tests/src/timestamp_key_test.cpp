@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <compact_time/timestamp_key.h>
+#include <algorithm>
+#include <vector>
+#include "test_helpers.h"
+
+static std::vector<uint8_t> encode_key(const ct_timestamp& timestamp)
+{
+    std::vector<uint8_t> key(ct_timestamp_key_size(&timestamp));
+    EXPECT_EQ((int)key.size(), ct_timestamp_key_encode(&timestamp, key.data(), key.size()));
+    return key;
+}
+
+// Timestamps in ascending key order
+static std::vector<ct_timestamp> make_ordered_timestamps()
+{
+    const ct_timestamp base = make_timestamp(2020, 8, 30, 15, 33, 14, 19577323);
+    return {
+        make_timestamp(-1000000, 12, 31, 23, 59, 60, 999999999),
+        make_timestamp(-1, 1, 1, 0, 0, 0, 0),
+        make_timestamp(1, 1, 1, 0, 0, 0, 0),
+        make_timestamp(1999, 12, 31, 23, 59, 59, 999999999),
+        make_timestamp(2000, 1, 1, 0, 0, 0, 0),
+        make_timestamp(2000, 1, 1, 0, 0, 0, 1),
+        make_timestamp(2000, 1, 1, 0, 0, 1, 0),
+        make_timestamp(2000, 1, 1, 0, 1, 0, 0),
+        make_timestamp(2000, 1, 1, 1, 0, 0, 0),
+        make_timestamp(2000, 1, 2, 0, 0, 0, 0),
+        make_timestamp(2000, 2, 1, 0, 0, 0, 0),
+        base,
+        make_named(base, "E/Berlin"),
+        make_named(base, "E/Berlin2"),
+        make_named(base, "E/Rome"),
+        make_location(base, -9000, 100),
+        make_location(base, 100, -18000),
+        make_location(base, 100, 18000),
+        make_timestamp(2021, 1, 1, 0, 0, 0, 0),
+        make_timestamp(1000000, 1, 1, 0, 0, 0, 0),
+    };
+}
+
+TEST(TimestampKey, round_trip)
+{
+    for(const ct_timestamp& timestamp: make_ordered_timestamps())
+    {
+        std::vector<uint8_t> key = encode_key(timestamp);
+        ct_timestamp decoded;
+        memset(&decoded, 0, sizeof(decoded));
+        ASSERT_EQ((int)key.size(), ct_timestamp_key_decode(key.data(), key.size(), &decoded));
+        ASSERT_TIMESTAMP_EQ(decoded, timestamp);
+    }
+}
+
+TEST(TimestampKey, layout)
+{
+    // 2000-01-01 00:00:01.000000001 UTC
+    std::vector<uint8_t> expected = {0x80, 0x00, 0x07, 0xd0, 0x10, 0x80, 0x00, 0x40, 0x00, 0x00, 0x01, 0x00};
+    ASSERT_EQ(expected, encode_key(make_timestamp(2000, 1, 1, 0, 0, 1, 1)));
+
+    expected = {0x80, 0x00, 0x07, 0xd0, 0x10, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 'E', '/', 'R', 'o', 'm', 'e', 0x00};
+    ASSERT_EQ(expected, encode_key(make_named(make_timestamp(2000, 1, 1, 0, 0, 0, 0), "E/Rome")));
+
+    expected = {0x80, 0x00, 0x07, 0xd0, 0x10, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x7f, 0x9c, 0x80, 0xc8};
+    ASSERT_EQ(expected, encode_key(make_location(make_timestamp(2000, 1, 1, 0, 0, 0, 0), -100, 200)));
+}
+
+TEST(TimestampKey, memcmp_order)
+{
+    std::vector<ct_timestamp> timestamps = make_ordered_timestamps();
+    std::vector<std::vector<uint8_t>> keys;
+    for(const ct_timestamp& timestamp: timestamps)
+    {
+        keys.push_back(encode_key(timestamp));
+    }
+    for(size_t i = 1; i < keys.size(); i++)
+    {
+        ASSERT_LT(keys[i - 1], keys[i]) << "at index " << i;
+    }
+
+    std::vector<std::vector<uint8_t>> shuffled = keys;
+    std::reverse(shuffled.begin(), shuffled.end());
+    std::rotate(shuffled.begin(), shuffled.begin() + 7, shuffled.end());
+    std::sort(shuffled.begin(), shuffled.end());
+    ASSERT_EQ(keys, shuffled);
+}
+
+TEST(TimestampKey, convert_encoded)
+{
+    for(const ct_timestamp& timestamp: make_ordered_timestamps())
+    {
+        uint8_t encoded[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+        const int encoded_length = ct_timestamp_encode(&timestamp, encoded, sizeof(encoded));
+        ASSERT_GT(encoded_length, 0);
+
+        uint8_t key[CT_TIMESTAMP_KEY_MAX_SIZE];
+        int bytes_read = 0;
+        const int key_length = ct_timestamp_key_from_encoded(encoded, encoded_length, key, sizeof(key), &bytes_read);
+        ASSERT_EQ(encoded_length, bytes_read);
+        ASSERT_EQ(encode_key(timestamp), std::vector<uint8_t>(key, key + key_length));
+
+        uint8_t round_tripped[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+        ASSERT_EQ(encoded_length, ct_timestamp_key_to_encoded(key, key_length, round_tripped, sizeof(round_tripped), &bytes_read));
+        ASSERT_EQ(key_length, bytes_read);
+        ASSERT_EQ(0, memcmp(encoded, round_tripped, encoded_length));
+    }
+}
+
+TEST(TimestampKey, failures)
+{
+    const ct_timestamp named = make_named(make_timestamp(2000, 1, 1, 0, 0, 0, 0), "E/Rome");
+    std::vector<uint8_t> key = encode_key(named);
+    ct_timestamp decoded;
+    for(int length = 0; length < (int)key.size(); length++)
+    {
+        ASSERT_GT(0, ct_timestamp_key_decode(key.data(), length, &decoded));
+        ASSERT_EQ(-(int)key.size(), ct_timestamp_key_encode(&named, key.data(), length));
+    }
+
+    int bytes_read = -1;
+    uint8_t buffer[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    ASSERT_GT(0, ct_timestamp_key_to_encoded(key.data(), 3, buffer, sizeof(buffer), &bytes_read));
+    ASSERT_EQ(0, bytes_read);
+    ASSERT_GT(0, ct_timestamp_key_to_encoded(key.data(), key.size(), buffer, 3, &bytes_read));
+    ASSERT_EQ((int)key.size(), bytes_read);
+
+    ct_timestamp timestamp = make_timestamp(2000, 1, 1, 0, 0, 0, 1000000000);
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_key_encode(&timestamp, key.data(), key.size()));
+    timestamp = make_location(make_timestamp(2000, 1, 1, 0, 0, 0, 0), 9001, 0);
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_key_encode(&timestamp, key.data(), key.size()));
+
+    // Names must fit in ct_timezone, even though the format allows up to 63 bytes.
+    for(int name_length: {(int)sizeof(timestamp.time.timezone.as_string), 63})
+    {
+        key = encode_key(make_named(make_timestamp(2000, 1, 1, 0, 0, 0, 0), "E/Rome"));
+        key.insert(key.end() - 1, name_length - 6, 'x');
+        ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_key_decode(key.data(), key.size(), &decoded)) << name_length;
+    }
+
+    // Names must be printable.
+    key = encode_key(make_named(make_timestamp(2000, 1, 1, 0, 0, 0, 0), "E/Rome"));
+    key[14] = 0x7f;
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_key_decode(key.data(), key.size(), &decoded));
+    timestamp = make_named(make_timestamp(2000, 1, 1, 0, 0, 0, 0), "E/R\xf6me");
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_key_encode(&timestamp, key.data(), key.size()));
+
+    key = encode_key(make_timestamp(2000, 1, 1, 0, 0, 0, 0));
+    key[11] = 3;
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timestamp_key_decode(key.data(), key.size(), &decoded));
+}
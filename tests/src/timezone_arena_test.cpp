@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+#include <compact_time/timezone_arena.h>
+#include <string>
+#include <vector>
+#include "test_helpers.h"
+
+static ct_timestamp make_named_timestamp(int year, int second, const char* name)
+{
+    return make_named(make_timestamp(year, 6, 24, 17, 53, second, 180000000), name);
+}
+
+static std::vector<uint8_t> encode(const ct_timestamp& timestamp)
+{
+    std::vector<uint8_t> encoded(CT_TIMESTAMP_MAX_ENCODED_SIZE);
+    encoded.resize(ct_timestamp_encode(&timestamp, encoded.data(), encoded.size()));
+    return encoded;
+}
+
+// Encode a timestamp with a name too long for ct_timezone to hold.
+static std::vector<uint8_t> encode_long_name(const std::string& name)
+{
+    std::vector<uint8_t> encoded = encode(make_named_timestamp(2020, 0, "E/Rome"));
+    encoded.resize(encoded.size() - 7);
+    encoded.push_back(name.size() << 1);
+    encoded.insert(encoded.end(), name.begin(), name.end());
+    return encoded;
+}
+
+TEST(TimezoneArena, record_size)
+{
+    ASSERT_LT(sizeof(ct_arena_timestamp) * 2, sizeof(ct_timestamp));
+}
+
+TEST(TimezoneArena, decode_encode)
+{
+    static const char* names[] = {"E/Berlin", "S/Tokyo", "E/Berlin", "E/Berlin", "M/Vancouver", "S/Tokyo"};
+    uint8_t memory[100];
+    ct_timezone_arena arena;
+    ct_timezone_arena_init(&arena, memory, sizeof(memory));
+
+    for(int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++)
+    {
+        std::vector<uint8_t> expected = encode(make_named_timestamp(2019 + i, i, names[i]));
+        ASSERT_GT(expected.size(), 0u);
+
+        ct_arena_timestamp timestamp;
+        ASSERT_EQ((int)expected.size(), ct_arena_timestamp_decode(&arena, expected.data(), expected.size(), &timestamp));
+        ASSERT_EQ(CT_TZ_STRING, timestamp.timezone_type);
+        ASSERT_STREQ(names[i], ct_timezone_arena_get_name(&arena, timestamp.name_offset));
+        ASSERT_EQ((int)strlen(names[i]), ct_timezone_arena_get_name_length(&arena, timestamp.name_offset));
+        ASSERT_EQ(2019 + i, timestamp.date.year);
+        ASSERT_EQ(i, timestamp.second);
+        ASSERT_EQ(180000000u, timestamp.nanosecond);
+
+        std::vector<uint8_t> actual(expected.size());
+        ASSERT_EQ((int)expected.size(), ct_arena_timestamp_encode(&arena, &timestamp, actual.data(), actual.size()));
+        ASSERT_EQ(expected, actual);
+        ASSERT_EQ(-(int)expected.size(), ct_arena_timestamp_encode(&arena, &timestamp, actual.data(), actual.size() - 1));
+    }
+
+    // Repeated names are stored once: length byte, name and terminator each.
+    ASSERT_EQ(10 + 9 + 13, arena.used);
+}
+
+TEST(TimezoneArena, decode_encode_utc_and_latlong)
+{
+    uint8_t memory[1];
+    ct_timezone_arena arena;
+    ct_timezone_arena_init(&arena, memory, 0);
+
+    // August 31, 3190, 00:54:47.394129, location 59.94, 10.71
+    std::vector<uint8_t> expected = {0xbe, 0x36, 0xf8, 0x18, 0x39, 0x60, 0xa5, 0x18, 0xd5, 0x2e, 0x2f, 0x04};
+    ct_arena_timestamp timestamp;
+    ASSERT_EQ((int)expected.size(), ct_arena_timestamp_decode(&arena, expected.data(), expected.size(), &timestamp));
+    ASSERT_EQ(CT_TZ_LATLONG, timestamp.timezone_type);
+    ASSERT_EQ(5994, timestamp.latitude);
+    ASSERT_EQ(1071, timestamp.longitude);
+    std::vector<uint8_t> actual(expected.size());
+    ASSERT_EQ((int)expected.size(), ct_arena_timestamp_encode(&arena, &timestamp, actual.data(), actual.size()));
+    ASSERT_EQ(expected, actual);
+
+    ct_timestamp utc = make_named_timestamp(2000, 0, "");
+    utc.time.timezone.type = CT_TZ_ZERO;
+    expected = encode(utc);
+    ASSERT_EQ((int)expected.size(), ct_arena_timestamp_decode(&arena, expected.data(), expected.size(), &timestamp));
+    ASSERT_EQ(CT_TZ_ZERO, timestamp.timezone_type);
+    actual.resize(expected.size());
+    ASSERT_EQ((int)expected.size(), ct_arena_timestamp_encode(&arena, &timestamp, actual.data(), actual.size()));
+    ASSERT_EQ(expected, actual);
+    ASSERT_EQ(0, arena.used);
+}
+
+TEST(TimezoneArena, longest_name)
+{
+    // Longer than ct_timezone.as_string can hold
+    const std::string name = "A/" + std::string(61, 'x');
+    const std::vector<uint8_t> expected = encode_long_name(name);
+    uint8_t memory[100];
+    ct_timezone_arena arena;
+    ct_timezone_arena_init(&arena, memory, sizeof(memory));
+
+    ct_arena_timestamp timestamp;
+    ASSERT_EQ((int)expected.size(), ct_arena_timestamp_decode(&arena, expected.data(), expected.size(), &timestamp));
+    ASSERT_EQ(name, ct_timezone_arena_get_name(&arena, timestamp.name_offset));
+    std::vector<uint8_t> actual(expected.size());
+    ASSERT_EQ((int)expected.size(), ct_arena_timestamp_encode(&arena, &timestamp, actual.data(), actual.size()));
+    ASSERT_EQ(expected, actual);
+}
+
+TEST(TimezoneArena, max_name_size)
+{
+    // The longest name the encoder writes fills the largest possible entry.
+    const std::vector<uint8_t> encoded = encode_long_name("A/" + std::string(61, 'x'));
+    uint8_t memory[CT_TIMEZONE_ARENA_MAX_NAME_SIZE];
+    ct_timezone_arena arena;
+    ct_timezone_arena_init(&arena, memory, sizeof(memory));
+
+    ct_arena_timestamp timestamp;
+    ASSERT_EQ((int)encoded.size(), ct_arena_timestamp_decode(&arena, encoded.data(), encoded.size(), &timestamp));
+    ASSERT_EQ(63, ct_timezone_arena_get_name_length(&arena, timestamp.name_offset));
+    ASSERT_EQ(0, ct_timezone_arena_remaining(&arena));
+
+    // Every stored record re-encodes within the documented maximum.
+    uint8_t buffer[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    ASSERT_EQ((int)encoded.size(), ct_arena_timestamp_encode(&arena, &timestamp, buffer, sizeof(buffer)));
+
+    // The length byte allows longer names, but they are rejected.
+    ct_timezone_arena_reset(&arena);
+    for(int length: {64, 127})
+    {
+        const std::vector<uint8_t> too_long = encode_long_name(std::string(length, 'x'));
+        ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_arena_timestamp_decode(&arena, too_long.data(), too_long.size(), &timestamp));
+        ASSERT_EQ(0, arena.used);
+    }
+}
+
+TEST(TimezoneArena, full_and_reset)
+{
+    const std::vector<uint8_t> berlin = encode(make_named_timestamp(2020, 0, "E/Berlin"));
+    const std::vector<uint8_t> rome = encode(make_named_timestamp(2020, 0, "E/Rome"));
+    uint8_t memory[17];
+    ct_timezone_arena arena;
+    ct_timezone_arena_init(&arena, memory, sizeof(memory));
+
+    ct_arena_timestamp timestamp;
+    ASSERT_EQ((int)berlin.size(), ct_arena_timestamp_decode(&arena, berlin.data(), berlin.size(), &timestamp));
+    ASSERT_EQ(10, arena.used);
+    ASSERT_EQ(7, ct_timezone_arena_remaining(&arena));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_arena_timestamp_decode(&arena, rome.data(), rome.size(), &timestamp));
+    ASSERT_EQ(10, arena.used);
+    // Too little room left to rule out the arena as the cause
+    ASSERT_LT(ct_timezone_arena_remaining(&arena), CT_TIMEZONE_ARENA_MAX_NAME_SIZE);
+    // Already stored names still decode.
+    ASSERT_EQ((int)berlin.size(), ct_arena_timestamp_decode(&arena, berlin.data(), berlin.size(), &timestamp));
+
+    ct_timezone_arena_reset(&arena);
+    ASSERT_EQ(0, arena.used);
+    ASSERT_EQ((int)sizeof(memory), ct_timezone_arena_remaining(&arena));
+    ASSERT_EQ((int)rome.size(), ct_arena_timestamp_decode(&arena, rome.data(), rome.size(), &timestamp));
+    ASSERT_STREQ("E/Rome", ct_timezone_arena_get_name(&arena, timestamp.name_offset));
+    ASSERT_EQ(8, arena.used);
+}
+
+TEST(TimezoneArena, batch)
+{
+    static const char* names[] = {"E/Berlin", "S/Tokyo", "E/Berlin", "M/Vancouver", "S/Tokyo", "E/Berlin"};
+    std::vector<uint8_t> buffer;
+    std::vector<int> expected_offsets;
+    for(int i = 0; i < 6; i++)
+    {
+        expected_offsets.push_back(buffer.size());
+        std::vector<uint8_t> encoded = encode(make_named_timestamp(2000 + i, i, names[i]));
+        buffer.insert(buffer.end(), encoded.begin(), encoded.end());
+    }
+
+    uint8_t memory[100];
+    ct_timezone_arena arena;
+    ct_timezone_arena_init(&arena, memory, sizeof(memory));
+    std::vector<ct_arena_timestamp> timestamps(6);
+    std::vector<int> offsets(6);
+    int records_processed = 0;
+    ASSERT_EQ((int)buffer.size(), ct_arena_timestamp_decode_batch(&arena, buffer.data(), buffer.size(),
+                                                                  timestamps.data(), timestamps.size(),
+                                                                  offsets.data(), &records_processed));
+    ASSERT_EQ(6, records_processed);
+    ASSERT_EQ(expected_offsets, offsets);
+    for(int i = 0; i < 6; i++)
+    {
+        ASSERT_EQ(2000 + i, timestamps[i].date.year);
+        ASSERT_STREQ(names[i], ct_timezone_arena_get_name(&arena, timestamps[i].name_offset));
+    }
+    ASSERT_EQ(timestamps[0].name_offset, timestamps[5].name_offset);
+
+    // Stops at the record that doesn't fit in the arena
+    ct_timezone_arena_init(&arena, memory, 20);
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_arena_timestamp_decode_batch(&arena, buffer.data(), buffer.size(),
+                                                                  timestamps.data(), timestamps.size(),
+                                                                  NULL, &records_processed));
+    ASSERT_EQ(3, records_processed);
+
+    // Failure offsets are relative to src
+    ct_timezone_arena_reset(&arena);
+    const int truncated_length = expected_offsets[1] + 1;
+    ct_arena_timestamp truncated;
+    const int failure = ct_arena_timestamp_decode(&arena, buffer.data() + expected_offsets[1], 1, &truncated);
+    ASSERT_GT(0, failure);
+    ASSERT_EQ(-expected_offsets[1] + failure, ct_arena_timestamp_decode_batch(&arena, buffer.data(), truncated_length,
+                                                                              timestamps.data(), timestamps.size(),
+                                                                              NULL, &records_processed));
+    ASSERT_EQ(1, records_processed);
+}
+
+TEST(TimezoneArena, failures)
+{
+    uint8_t memory[100];
+    ct_timezone_arena arena;
+    ct_timezone_arena_init(&arena, memory, sizeof(memory));
+    ct_arena_timestamp timestamp;
+
+    std::vector<uint8_t> encoded = encode(make_named_timestamp(2020, 0, "E/Rome"));
+    for(int length = 0; length < (int)encoded.size(); length++)
+    {
+        ASSERT_GT(0, ct_arena_timestamp_decode(&arena, encoded.data(), length, &timestamp));
+    }
+    ASSERT_EQ(0, arena.used);
+
+    encoded.back() = '\t';
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_arena_timestamp_decode(&arena, encoded.data(), encoded.size(), &timestamp));
+    ASSERT_EQ(0, arena.used);
+
+    // Offsets must refer to a stored name.
+    uint8_t buffer[CT_TIMESTAMP_MAX_ENCODED_SIZE];
+    timestamp.timezone_type = CT_TZ_STRING;
+    timestamp.name_offset = 0;
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_arena_timestamp_encode(&arena, &timestamp, buffer, sizeof(buffer)));
+    timestamp.name_offset = 1;
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_arena_timestamp_encode(&arena, &timestamp, buffer, sizeof(buffer)));
+}
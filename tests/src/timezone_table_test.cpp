@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <compact_time/timezone_table.h>
+#include <vector>
+#include "test_helpers.h"
+
+static ct_timestamp make_named_timestamp(int year, int second, const char* name)
+{
+    return make_named(make_timestamp(year, 6, 24, 17, 53, second, 180000000), name);
+}
+
+TEST(TimezoneTable, intern)
+{
+    ct_timezone_table table;
+    ASSERT_TRUE(ct_timezone_table_init(&table, 2));
+    ASSERT_EQ(0, ct_timezone_table_intern(&table, "E/Berlin", 8));
+    ASSERT_EQ(1, ct_timezone_table_intern(&table, "S/Tokyo", 7));
+    ASSERT_EQ(0, ct_timezone_table_intern(&table, "E/Berlin", 8));
+    ASSERT_EQ(1, ct_timezone_table_intern(&table, "S/Tokyo-extra", 7));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timezone_table_intern(&table, "E/Rome", 6));
+    ASSERT_EQ(ERROR_OUT_OF_RANGE, ct_timezone_table_intern(&table, "E/\tRome", 7));
+    ASSERT_STREQ("S/Tokyo", ct_timezone_table_get_name(&table, 1));
+    ct_timezone_table_free(&table);
+}
+
+TEST(TimezoneTable, decode_encode)
+{
+    static const char* names[] = {"E/Berlin", "S/Tokyo", "E/Berlin", "E/Berlin", "M/Vancouver", "S/Tokyo"};
+    ct_timezone_table table;
+    ASSERT_TRUE(ct_timezone_table_init(&table, 10));
+
+    for(int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++)
+    {
+        ct_timestamp timestamp = make_named_timestamp(2019 + i, i, names[i]);
+        uint8_t expected[100];
+        int expected_length = ct_timestamp_encode(&timestamp, expected, sizeof(expected));
+        ASSERT_GT(expected_length, 0);
+
+        ct_interned_timestamp interned;
+        ASSERT_EQ(expected_length, ct_interned_timestamp_decode(&table, expected, expected_length, &interned));
+        ASSERT_EQ(CT_TZ_STRING, interned.timezone.type);
+        ASSERT_STREQ(names[i], interned.timezone.name);
+        ASSERT_EQ(interned.timezone.name, ct_timezone_table_get_name(&table, interned.timezone.id));
+        ASSERT_EQ(2019 + i, interned.date.year);
+        ASSERT_EQ(i, interned.second);
+        ASSERT_EQ(180000000u, interned.nanosecond);
+
+        uint8_t actual[100];
+        ASSERT_EQ(expected_length, ct_interned_timestamp_encode(&table, &interned, actual, sizeof(actual)));
+        ASSERT_EQ(0, memcmp(expected, actual, expected_length));
+        ASSERT_GT(0, ct_interned_timestamp_encode(&table, &interned, actual, expected_length - 1));
+    }
+    ASSERT_EQ(3, table.entry_count);
+
+    ct_timezone_table_free(&table);
+}
+
+TEST(TimezoneTable, decode_encode_utc_and_latlong)
+{
+    ct_timezone_table table;
+    ASSERT_TRUE(ct_timezone_table_init(&table, 1));
+
+    // August 31, 3190, 00:54:47.394129, location 59.94, 10.71
+    std::vector<uint8_t> expected = {0xbe, 0x36, 0xf8, 0x18, 0x39, 0x60, 0xa5, 0x18, 0xd5, 0x2e, 0x2f, 0x04};
+    ct_interned_timestamp interned;
+    ASSERT_EQ(expected.size(), ct_interned_timestamp_decode(&table, expected.data(), expected.size(), &interned));
+    ASSERT_EQ(CT_TZ_LATLONG, interned.timezone.type);
+    ASSERT_EQ(5994, interned.timezone.latitude);
+    ASSERT_EQ(1071, interned.timezone.longitude);
+    std::vector<uint8_t> actual(expected.size());
+    ASSERT_EQ(expected.size(), ct_interned_timestamp_encode(&table, &interned, actual.data(), actual.size()));
+    ASSERT_EQ(expected, actual);
+
+    // June 24, 2019, 17:53:04.180
+    expected = {0x11, 0x75, 0xc4, 0x46, 0x0b, 0x4d};
+    ASSERT_EQ(expected.size(), ct_interned_timestamp_decode(&table, expected.data(), expected.size(), &interned));
+    ASSERT_EQ(CT_TZ_ZERO, interned.timezone.type);
+    actual.resize(expected.size());
+    ASSERT_EQ(expected.size(), ct_interned_timestamp_encode(&table, &interned, actual.data(), actual.size()));
+    ASSERT_EQ(expected, actual);
+
+    ASSERT_EQ(0, table.entry_count);
+    ct_timezone_table_free(&table);
+}
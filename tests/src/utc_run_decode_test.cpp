@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <compact_time/compact_time.h>
+#include <vector>
+#include "test_helpers.h"
+
+struct TimestampColumns
+{
+    std::vector<int32_t> year;
+    std::vector<uint8_t> month;
+    std::vector<uint8_t> day;
+    std::vector<uint8_t> hour;
+    std::vector<uint8_t> minute;
+    std::vector<uint8_t> second;
+    std::vector<uint32_t> nanosecond;
+    ct_timestamp_fields fields;
+
+    explicit TimestampColumns(size_t count)
+    : year(count), month(count), day(count), hour(count), minute(count), second(count), nanosecond(count)
+    {
+        fields.year = year.data();
+        fields.month = month.data();
+        fields.day = day.data();
+        fields.hour = hour.data();
+        fields.minute = minute.data();
+        fields.second = second.data();
+        fields.nanosecond = nanosecond.data();
+    }
+};
+
+static std::vector<ct_timestamp> make_utc_timestamps()
+{
+    static const int nanoseconds[] = {0, 123000000, 123456000, 123456789};
+    static const int years[] = {2000, 2019, 1985, 2050, 1, -50000, 3009};
+    std::vector<ct_timestamp> timestamps;
+    for(int nanosecond: nanoseconds)
+    {
+        for(int year: years)
+        {
+            // Long same-shape runs to exercise the block paths
+            for(int i = 0; i < 11; i++)
+            {
+                timestamps.push_back(make_timestamp(year, 1 + i, 31 - i, 23 - i, 59 - i, 60 - i, nanosecond));
+            }
+        }
+    }
+    return timestamps;
+}
+
+static void assert_columns_match(const TimestampColumns& columns, const std::vector<ct_timestamp>& timestamps, size_t count)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        ASSERT_EQ(timestamps[i].date.year, columns.year[i]) << "record " << i;
+        ASSERT_EQ(timestamps[i].date.month, columns.month[i]) << "record " << i;
+        ASSERT_EQ(timestamps[i].date.day, columns.day[i]) << "record " << i;
+        ASSERT_EQ(timestamps[i].time.hour, columns.hour[i]) << "record " << i;
+        ASSERT_EQ(timestamps[i].time.minute, columns.minute[i]) << "record " << i;
+        ASSERT_EQ(timestamps[i].time.second, columns.second[i]) << "record " << i;
+        ASSERT_EQ(timestamps[i].time.nanosecond, columns.nanosecond[i]) << "record " << i;
+    }
+}
+
+TEST(UTCRunDecode, matches_encoded_timestamps)
+{
+    std::vector<ct_timestamp> timestamps = make_utc_timestamps();
+    std::vector<uint8_t> encoded = encode_all(timestamps);
+
+    TimestampColumns columns(timestamps.size());
+    int records_processed = 0;
+    int bytes_decoded = ct_timestamp_decode_utc_run(encoded.data(), encoded.size(), &columns.fields, timestamps.size(), &records_processed);
+    ASSERT_EQ(encoded.size(), bytes_decoded);
+    ASSERT_EQ(timestamps.size(), records_processed);
+    assert_columns_match(columns, timestamps, timestamps.size());
+}
+
+TEST(UTCRunDecode, respects_max_count)
+{
+    std::vector<ct_timestamp> timestamps = make_utc_timestamps();
+    std::vector<uint8_t> encoded = encode_all(timestamps);
+
+    TimestampColumns columns(7);
+    int records_processed = 0;
+    int bytes_decoded = ct_timestamp_decode_utc_run(encoded.data(), encoded.size(), &columns.fields, 7, &records_processed);
+    ASSERT_GT(bytes_decoded, 0);
+    ASSERT_EQ(7, records_processed);
+    assert_columns_match(columns, timestamps, 7);
+}
+
+TEST(UTCRunDecode, stops_at_non_utc)
+{
+    std::vector<ct_timestamp> timestamps = make_utc_timestamps();
+    timestamps[9].time.timezone.type = CT_TZ_LATLONG;
+    timestamps[9].time.timezone.latitude = 100;
+    timestamps[9].time.timezone.longitude = 200;
+    std::vector<int> offsets;
+    std::vector<uint8_t> encoded = encode_all(timestamps, &offsets);
+
+    TimestampColumns columns(timestamps.size());
+    int records_processed = 0;
+    int bytes_decoded = ct_timestamp_decode_utc_run(encoded.data(), encoded.size(), &columns.fields, timestamps.size(), &records_processed);
+    ASSERT_EQ(offsets[9], bytes_decoded);
+    ASSERT_EQ(9, records_processed);
+    assert_columns_match(columns, timestamps, 9);
+}
+
+TEST(UTCRunDecode, truncated)
+{
+    std::vector<ct_timestamp> timestamps = make_utc_timestamps();
+    std::vector<uint8_t> encoded = encode_all(timestamps);
+
+    TimestampColumns columns(timestamps.size());
+    int records_processed = 0;
+    int result = ct_timestamp_decode_utc_run(encoded.data(), encoded.size() - 1, &columns.fields, timestamps.size(), &records_processed);
+    ASSERT_LT(result, 0);
+    ASSERT_EQ(timestamps.size() - 1, records_processed);
+}